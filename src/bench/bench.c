@@ -0,0 +1,637 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "cJSON.h"
+#include "evaluator.h"
+#include "pokerai.h"
+#include "random.h"
+
+//Fixed seed so every run benchmarks the same hands and deals
+#define BENCH_SEED          20150204
+#define BENCH_HANDS         (1 << 16)
+#define BENCH_EVALS         20000000
+#define BENCH_DRAWS         50000000
+#define BENCH_BOARDS        (1 << 12)
+#define BENCH_BEST_HANDS    5000000
+#define BENCH_GAMES         500000
+#define BENCH_REPEATS       20
+#define BENCH_PARSES        200000
+#define BENCH_TIMEOUT       1000
+#define MAX_SPOT_OPPONENTS  9
+#define NUM_CARDS           52
+
+//A full table as the server would send it, parsed by BenchGameState
+#define BENCH_GAME_STATE \
+    "{\"name\": \"BENCH_AI\", \"your_turn\": true, \"initial_stack\": 2500, \"stack\": 2150," \
+    " \"current_bet\": 350, \"call_amount\": 100, \"hand\": [\"AS\", \"KS\"]," \
+    " \"community_cards\": [\"QS\", \"7D\", \"2C\", \"9H\"], \"betting_phase\": \"turn\"," \
+    " \"players_at_table\": [" \
+    BENCH_PLAYER("Alice", "false") ", " BENCH_PLAYER("Brannigan", "false") ", " \
+    BENCH_PLAYER("Chloe", "true") ", " BENCH_PLAYER("Dave", "false") ", " \
+    BENCH_PLAYER("Evan", "true") ", " BENCH_PLAYER("Freddy", "false") ", " \
+    BENCH_PLAYER("Gary", "false") ", " BENCH_PLAYER("Harry", "true") ", " \
+    BENCH_PLAYER("Isabel", "false") "]," \
+    " \"total_players_remaining\": 6, \"table_id\": 766, \"round_id\": 823, \"lost_at\": null}"
+#define BENCH_PLAYER(name, folded) \
+    "{\"player_name\": \"" name "\", \"initial_stack\": 2500, \"current_bet\": 450," \
+    " \"stack\": 2050, \"folded\": " folded "}"
+
+typedef struct benchcontext
+{
+    //Collected results, printed as JSON when asked for
+    cJSON *results;
+    bool json;
+
+    //Pin the Monte Carlo workers to their own CPUs
+    bool pin;
+} BenchContext;
+
+/*
+ * Get a monotonic time stamp
+ * return: the current time in nanoseconds
+ */
+static
+double NowNanoseconds(void);
+
+/*
+ * Record one benchmark result and print it unless printing JSON
+ * ctx: the benchmark context
+ * name: the name of the benchmark
+ * ns: the time taken for one operation in nanoseconds
+ */
+static
+void Report(BenchContext *ctx, char *name, double ns);
+
+/*
+ * Time GetHandValue on random hands of 5, 6 and 7 cards
+ * and GetMaskHandValue on the same 7 card hands
+ * ctx: the benchmark context
+ */
+static
+void BenchEvaluator(BenchContext *ctx);
+
+/*
+ * Time BestHandOnBoard on dealt river boards against every number
+ * of opponents, leaving out the cost of dealing the cards
+ * ctx: the benchmark context
+ */
+static
+void BenchBestHand(BenchContext *ctx);
+
+/*
+ * Time DrawCard and DealMaskCard on a full deck,
+ * and DealRangeHand on the range of a player who is all in
+ * ctx: the benchmark context
+ */
+static
+void BenchDraw(BenchContext *ctx);
+
+/*
+ * Time single-threaded simulated games on the flop, turn
+ * and river against every number of opponents with both backends
+ * ctx: the benchmark context
+ */
+static
+void BenchSimulation(BenchContext *ctx);
+
+/*
+ * Time GetWinProbability from a preflop lookup to a full Monte Carlo
+ * decision, the cost of a plain game's worth of precision with each estimator
+ * and how the simulation scales with the number of threads
+ * ctx: the benchmark context
+ */
+static
+void BenchWinProbability(BenchContext *ctx);
+
+/*
+ * Time reading a full table's game state through a cJSON tree
+ * and SetGameState against ParseGameState
+ * ctx: the benchmark context
+ */
+static
+void BenchGameState(BenchContext *ctx);
+
+/*
+ * Fill in a spot of the benchmark hand
+ * query: the spot to fill in
+ * communitysize: the number of known community cards
+ * num_playing: the number of opponents
+ */
+static
+void SetBenchSpot(EquityQuery *query, int communitysize, int num_playing);
+
+int main(int argc, char **argv)
+{
+    char *handranksfile = DEFAULT_HANDRANKS_FILE;
+    BenchContext ctx;
+    char *json;
+    int flags = 0;
+
+    ctx.json = false;
+    ctx.pin = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--json"))
+        {
+            ctx.json = true;
+        }
+        else if (!strcmp(argv[i], "--pin"))
+        {
+            ctx.pin = true;
+        }
+        else if (!strcmp(argv[i], "--replicate"))
+        {
+            flags |= LOAD_REPLICATE;
+        }
+        else if (!strcmp(argv[i], "--interleave"))
+        {
+            flags |= LOAD_INTERLEAVE;
+        }
+        else
+        {
+            handranksfile = argv[i];
+        }
+    }
+
+    //Fault the whole table in so the first benchmark is not penalized
+    InitEvaluatorWithFlags(handranksfile, LOAD_MMAP | LOAD_POPULATE | flags);
+
+    ctx.results = cJSON_CreateObject();
+    cJSON_AddNumberToObject(ctx.results, "threads", sysconf(_SC_NPROCESSORS_ONLN));
+    cJSON_AddItemToObject(ctx.results, "benchmarks", cJSON_CreateArray());
+
+    BenchEvaluator(&ctx);
+    BenchBestHand(&ctx);
+    BenchDraw(&ctx);
+    BenchSimulation(&ctx);
+    BenchWinProbability(&ctx);
+    BenchGameState(&ctx);
+
+    if (ctx.json)
+    {
+        json = cJSON_Print(ctx.results);
+        printf("%s\n", json);
+        free(json);
+    }
+
+    cJSON_Delete(ctx.results);
+    return 0;
+}
+
+/*
+ * Get a monotonic time stamp
+ * return: the current time in nanoseconds
+ */
+static
+double NowNanoseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/*
+ * Record one benchmark result and print it unless printing JSON
+ * ctx: the benchmark context
+ * name: the name of the benchmark
+ * ns: the time taken for one operation in nanoseconds
+ */
+static
+void Report(BenchContext *ctx, char *name, double ns)
+{
+    cJSON *result = cJSON_CreateObject();
+
+    cJSON_AddStringToObject(result, "name", name);
+    cJSON_AddNumberToObject(result, "ns_per_op", ns);
+    cJSON_AddNumberToObject(result, "ops_per_sec", 1e9 / ns);
+    cJSON_AddItemToArray(cJSON_GetObjectItem(ctx->results, "benchmarks"), result);
+
+    if (!ctx->json)
+    {
+        printf("%-32s %12.2f ns/op %14.0f ops/s\n", name, ns, 1e9 / ns);
+    }
+}
+
+/*
+ * Time GetHandValue on random hands of 5, 6 and 7 cards
+ * and GetMaskHandValue on the same 7 card hands
+ * ctx: the benchmark context
+ */
+static
+void BenchEvaluator(BenchContext *ctx)
+{
+    int (*hands)[7] = malloc(sizeof(*hands) * BENCH_HANDS);
+    CardMask *masks = malloc(sizeof(*masks) * BENCH_HANDS);
+    int deck[NUM_CARDS];
+    int decksize;
+    RandomState rng;
+    char name[64];
+    double start;
+    volatile int sink = 0;
+
+    SeedRandom(&rng, BENCH_SEED);
+    for (int i = 0; i < BENCH_HANDS; i++)
+    {
+        for (int c = 0; c < NUM_CARDS; c++)
+        {
+            deck[c] = c + 1;
+        }
+        decksize = NUM_CARDS;
+
+        for (int c = 0; c < 7; c++)
+        {
+            hands[i][c] = DrawCard(&rng, deck, &decksize);
+        }
+        masks[i] = CardsToMask(hands[i], 7);
+    }
+
+    for (int numcards = 5; numcards <= 7; numcards++)
+    {
+        start = NowNanoseconds();
+        for (int i = 0; i < BENCH_EVALS; i++)
+        {
+            sink += GetHandValue(hands[i & (BENCH_HANDS - 1)], numcards);
+        }
+
+        sprintf(name, "GetHandValue/%d", numcards);
+        Report(ctx, name, (NowNanoseconds() - start) / BENCH_EVALS);
+    }
+
+    start = NowNanoseconds();
+    for (int i = 0; i < BENCH_EVALS; i++)
+    {
+        sink += GetMaskHandValue(masks[i & (BENCH_HANDS - 1)]);
+    }
+    Report(ctx, "GetMaskHandValue/7", (NowNanoseconds() - start) / BENCH_EVALS);
+
+    (void)sink;
+    free(masks);
+    free(hands);
+}
+
+/*
+ * Time BestHandOnBoard on dealt river boards against every number
+ * of opponents, leaving out the cost of dealing the cards
+ * ctx: the benchmark context
+ */
+static
+void BenchBestHand(BenchContext *ctx)
+{
+    BoardState *boards = malloc(sizeof(*boards) * BENCH_BOARDS);
+    int (*hands)[MAX_SPOT_OPPONENTS][2] = malloc(sizeof(*hands) * BENCH_BOARDS);
+    int community[NUM_COMMUNITY];
+    int deck[NUM_CARDS];
+    int decksize;
+    RandomState rng;
+    char name[64];
+    double start;
+    volatile int sink = 0;
+
+    SeedRandom(&rng, BENCH_SEED);
+    for (int i = 0; i < BENCH_BOARDS; i++)
+    {
+        for (int c = 0; c < NUM_CARDS; c++)
+        {
+            deck[c] = c + 1;
+        }
+        decksize = NUM_CARDS;
+
+        for (int c = 0; c < NUM_COMMUNITY; c++)
+        {
+            community[c] = DrawCard(&rng, deck, &decksize);
+        }
+        StartBoard(&boards[i]);
+        AddBoardCards(&boards[i], community, NUM_COMMUNITY);
+
+        for (int opp = 0; opp < MAX_SPOT_OPPONENTS; opp++)
+        {
+            hands[i][opp][0] = DrawCard(&rng, deck, &decksize);
+            hands[i][opp][1] = DrawCard(&rng, deck, &decksize);
+        }
+    }
+
+    for (int opp = 1; opp <= MAX_SPOT_OPPONENTS; opp++)
+    {
+        start = NowNanoseconds();
+        for (int i = 0; i < BENCH_BEST_HANDS; i++)
+        {
+            sink += BestHandOnBoard(&boards[i & (BENCH_BOARDS - 1)], hands[i & (BENCH_BOARDS - 1)], opp);
+        }
+
+        sprintf(name, "BestHandOnBoard/%d", opp);
+        Report(ctx, name, (NowNanoseconds() - start) / BENCH_BEST_HANDS);
+    }
+
+    (void)sink;
+    free(boards);
+    free(hands);
+}
+
+/*
+ * Time DrawCard and DealMaskCard on a full deck,
+ * and DealRangeHand on the range of a player who is all in
+ * ctx: the benchmark context
+ */
+static
+void BenchDraw(BenchContext *ctx)
+{
+    int fresh[NUM_CARDS];
+    int deck[NUM_CARDS];
+    int decksize = 0;
+    CardMask maskdeck = 0;
+    CardMask dealt = 0;
+    HandRange *range = malloc(sizeof(HandRange));
+    Player allin = {"ALLIN", 1000, 1000, 0, false};
+    int combo;
+    int hands = 0;
+    RandomState rng;
+    double start;
+    volatile int sink = 0;
+
+    for (int c = 0; c < NUM_CARDS; c++)
+    {
+        fresh[c] = c + 1;
+    }
+    SeedRandom(&rng, BENCH_SEED);
+
+    //Refill the deck like a simulated game does, before it runs low
+    start = NowNanoseconds();
+    for (int i = 0; i < BENCH_DRAWS; i++)
+    {
+        if (decksize < NUM_CARDS - 2 * MAX_SPOT_OPPONENTS - NUM_COMMUNITY)
+        {
+            memcpy(deck, fresh, sizeof(deck));
+            decksize = NUM_CARDS;
+        }
+        sink += DrawCard(&rng, deck, &decksize);
+    }
+    Report(ctx, "DrawCard", (NowNanoseconds() - start) / BENCH_DRAWS);
+
+    decksize = 0;
+    start = NowNanoseconds();
+    for (int i = 0; i < BENCH_DRAWS; i++)
+    {
+        if (decksize < NUM_CARDS - 2 * MAX_SPOT_OPPONENTS - NUM_COMMUNITY)
+        {
+            maskdeck = FULL_DECK_MASK;
+            decksize = NUM_CARDS;
+        }
+        sink += __builtin_ctzll(DealMaskCard(&rng, &maskdeck, &decksize));
+    }
+    Report(ctx, "DealMaskCard", (NowNanoseconds() - start) / BENCH_DRAWS);
+
+    //Whole hands, each avoiding the ones dealt before it at a full table
+    SetPlayerRange(range, &allin, 0);
+    start = NowNanoseconds();
+    for (int i = 0; i < BENCH_DRAWS / NUM_HAND; i++)
+    {
+        if (hands == MAX_SPOT_OPPONENTS)
+        {
+            dealt = 0;
+            hands = 0;
+        }
+        combo = DealRangeHand(range, &rng, dealt);
+        dealt |= COMBO_MASKS[combo];
+        hands++;
+        sink += combo;
+    }
+    Report(ctx, "DealRangeHand", (NowNanoseconds() - start) / (BENCH_DRAWS / NUM_HAND));
+
+    free(range);
+    (void)sink;
+}
+
+/*
+ * Time single-threaded simulated games on the flop, turn
+ * and river against every number of opponents with both backends
+ * ctx: the benchmark context
+ */
+static
+void BenchSimulation(BenchContext *ctx)
+{
+    //A batch of one query runs on a single worker
+    PokerAI *ai = CreatePokerAIWithThreads(BENCH_TIMEOUT, 1);
+    char *streets[] = {"flop", "turn", "river"};
+    char *backends[] = {"table", "mask"};
+    SimBackend backend;
+    EquityQuery query;
+    char name[64];
+    double start;
+
+    SetEnumerateLimit(ai, 0);
+    for (int b = 0; b < 2; b++)
+    {
+        backend = b ? SIM_BACKEND_MASK : SIM_BACKEND_TABLE;
+        SetSimBackend(ai, backend);
+
+        for (int street = 0; street < 3; street++)
+        {
+            for (int opp = 1; opp <= MAX_SPOT_OPPONENTS; opp++)
+            {
+                SetBenchSpot(&query, 3 + street, opp);
+
+                start = NowNanoseconds();
+                GetWinProbabilities(ai, &query, 1, BENCH_GAMES);
+
+                sprintf(name, "SimulateSingleGame/%s/%s/%d", backends[b], streets[street], opp);
+                Report(ctx, name, (NowNanoseconds() - start) / BENCH_GAMES);
+            }
+        }
+    }
+
+    DestroyPokerAI(ai);
+}
+
+/*
+ * Time GetWinProbability from a preflop lookup to a full Monte Carlo
+ * decision, the cost of a plain game's worth of precision with each estimator
+ * and how the simulation scales with the number of threads
+ * ctx: the benchmark context
+ */
+static
+void BenchWinProbability(BenchContext *ctx)
+{
+    int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_nodes = GetNumNodes();
+    cJSON *scaling = cJSON_CreateArray();
+    cJSON *entry;
+    cJSON *bynode;
+    int estimators[] = {ESTIMATE_PLAIN, ESTIMATE_SPLIT_TIES, ESTIMATE_SPLIT_TIES | ESTIMATE_HAND_CLASSES};
+    char *estimator_names[] = {"plain", "split", "classes"};
+    EquityQuery query;
+    PokerAI *ai;
+    char name[64];
+    double start;
+    double seconds;
+    double rate;
+    double single_rate = 0;
+
+    //Lookups and exact spots are timed over a few repeats
+    ai = CreatePokerAI(BENCH_TIMEOUT);
+    for (int communitysize = 0; communitysize <= NUM_COMMUNITY; communitysize += 5)
+    {
+        SetBenchSpot(&query, communitysize, 1);
+        memcpy(ai->game.hand, query.hand, sizeof(query.hand));
+        memcpy(ai->game.community, query.community, sizeof(query.community));
+        ai->game.handsize = NUM_HAND;
+        ai->game.communitysize = communitysize;
+        ai->game.num_playing = 1;
+        UpdateGameDeck(&ai->game);
+
+        start = NowNanoseconds();
+        for (int i = 0; i < BENCH_REPEATS; i++)
+        {
+            GetWinProbability(ai);
+        }
+        Report(ctx, communitysize ? "GetWinProbability/river/1" : "GetWinProbability/preflop/1",
+                (NowNanoseconds() - start) / BENCH_REPEATS);
+    }
+    DestroyPokerAI(ai);
+
+    //A variance reduced game is worth more than one, so time the plain games it matches
+    for (int e = 0; e < 3; e++)
+    {
+        ai = CreatePokerAIWithThreads(BENCH_TIMEOUT, 1);
+        SetEnumerateLimit(ai, 0);
+        SetEstimator(ai, estimators[e]);
+        SetBenchSpot(&query, 3, 1);
+        memcpy(ai->game.hand, query.hand, sizeof(query.hand));
+        memcpy(ai->game.community, query.community, sizeof(query.community));
+        ai->game.handsize = NUM_HAND;
+        ai->game.communitysize = 3;
+        ai->game.num_playing = 1;
+        UpdateGameDeck(&ai->game);
+
+        start = NowNanoseconds();
+        GetWinProbability(ai);
+
+        sprintf(name, "GetWinProbability/effective/%s", estimator_names[e]);
+        Report(ctx, name, (NowNanoseconds() - start) / ai->effective_games);
+        DestroyPokerAI(ai);
+    }
+
+    //Monte Carlo runs for the whole timeout, so measure games per second instead
+    if (!ctx->json)
+    {
+        printf("\n%-8s %16s %16s %10s %12s\n", "threads", "games/s", "games/s/core", "scaling", "overshoot");
+    }
+
+    for (int threads = 1; threads <= max_threads; threads++)
+    {
+        ai = CreatePokerAIWithThreads(BENCH_TIMEOUT, threads);
+        SetWorkerPinning(ai, ctx->pin);
+        SetEnumerateLimit(ai, 0);
+        SetBenchSpot(&query, 3, 3);
+        memcpy(ai->game.hand, query.hand, sizeof(query.hand));
+        memcpy(ai->game.community, query.community, sizeof(query.community));
+        ai->game.handsize = NUM_HAND;
+        ai->game.communitysize = 3;
+        ai->game.num_playing = 3;
+        UpdateGameDeck(&ai->game);
+
+        start = NowNanoseconds();
+        GetWinProbability(ai);
+        seconds = (NowNanoseconds() - start) / 1e9;
+        rate = ai->games_simulated / seconds;
+        if (threads == 1)
+        {
+            single_rate = rate;
+        }
+
+        entry = cJSON_CreateObject();
+        cJSON_AddNumberToObject(entry, "threads", threads);
+        cJSON_AddNumberToObject(entry, "games_per_sec", rate);
+        cJSON_AddNumberToObject(entry, "games_per_sec_per_core", rate / threads);
+        cJSON_AddNumberToObject(entry, "efficiency", rate / threads / single_rate);
+        cJSON_AddNumberToObject(entry, "overshoot_us", ai->stop_overshoot / 1e3);
+        bynode = cJSON_CreateArray();
+        for (int node = 0; node < num_nodes; node++)
+        {
+            cJSON_AddItemToArray(bynode, cJSON_CreateNumber(ai->node_games[node] / seconds));
+        }
+        cJSON_AddItemToObject(entry, "games_per_sec_by_node", bynode);
+        cJSON_AddItemToArray(scaling, entry);
+
+        if (!ctx->json)
+        {
+            printf("%-8d %16.0f %16.0f %9.1f%% %10.1fus\n", threads, rate, rate / threads,
+                    100 * rate / threads / single_rate, ai->stop_overshoot / 1e3);
+
+            //Workers on a node far from the table fall behind the others
+            for (int node = 0; node < num_nodes && num_nodes > 1; node++)
+            {
+                printf("  node %-3d %16.0f\n", node, ai->node_games[node] / seconds);
+            }
+        }
+
+        DestroyPokerAI(ai);
+    }
+
+    cJSON_AddItemToObject(ctx->results, "scaling", scaling);
+}
+
+/*
+ * Time reading a full table's game state through a cJSON tree
+ * and SetGameState against ParseGameState
+ * ctx: the benchmark context
+ */
+static
+void BenchGameState(BenchContext *ctx)
+{
+    GameState game;
+    cJSON *json;
+    double start;
+    volatile int sink = 0;
+
+    if (!ctx->json)
+    {
+        printf("\n");
+    }
+
+    start = NowNanoseconds();
+    for (int i = 0; i < BENCH_PARSES; i++)
+    {
+        json = cJSON_Parse(BENCH_GAME_STATE);
+        SetGameState(&game, json);
+        cJSON_Delete(json);
+        sink += game.current_pot;
+    }
+    Report(ctx, "SetGameState/cJSON", (NowNanoseconds() - start) / BENCH_PARSES);
+
+    start = NowNanoseconds();
+    for (int i = 0; i < BENCH_PARSES; i++)
+    {
+        ParseGameState(&game, BENCH_GAME_STATE);
+        sink += game.current_pot;
+    }
+    Report(ctx, "ParseGameState", (NowNanoseconds() - start) / BENCH_PARSES);
+
+    (void)sink;
+}
+
+/*
+ * Fill in a spot of the benchmark hand
+ * query: the spot to fill in
+ * communitysize: the number of known community cards
+ * num_playing: the number of opponents
+ */
+static
+void SetBenchSpot(EquityQuery *query, int communitysize, int num_playing)
+{
+    char *hand[] = {"AH", "KD"};
+    char *board[] = {"2C", "7S", "9H", "4D", "QC"};
+
+    for (int i = 0; i < NUM_HAND; i++)
+    {
+        query->hand[i] = StringToCard(hand[i]);
+    }
+
+    for (int i = 0; i < NUM_COMMUNITY; i++)
+    {
+        query->community[i] = StringToCard(board[i]);
+    }
+
+    query->communitysize = communitysize;
+    query->num_playing = num_playing;
+}
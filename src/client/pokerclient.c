@@ -6,19 +6,40 @@
 #include "urlconnection.h"
 
 #define TIMEOUT     1000
+#define TARGET_ERROR 0.005
 #define GET_URL     "http://example.com/"
 #define POST_URL    "http://example.com/post/"
+#define STREAM_URL  "http://example.com/events/"
 #define MAX_TRIES   5
 #define BUF_SIZE    1024
 
 #define PRINTERR(...) fprintf(stderr, __VA_ARGS__)
 
+//How the client finds out that the game state changed
+typedef enum updatemode
+{
+    UPDATE_POLL,        //GET the state, waiting longer the longer it stays the same
+    UPDATE_LONG_POLL,   //GET the state with since= at once, the server holds it until it changes
+    UPDATE_STREAM       //listen to server-sent events carrying every new state
+} UpdateMode;
+
+//One kept-alive connection to the server for every poll and POST
+static HttpSession *Session = NULL;
+
+//A second connection for the event stream, so actions can be posted meanwhile
+static HttpSession *StreamSession = NULL;
+
+//Spots the AI has simulated this session, so repeated ones start ahead
+static EquityCache *Cache = NULL;
+
 /*
  * Set up everything necessary for the client
  * handranksfile: the file containing the hand ranks look up table
+ * flags: extra LoadFlags for the table, such as LOAD_REPLICATE
+ * mode: how the client will receive game states
  */
 static
-void PokerClientSetup(char *handranksfile);
+void PokerClientSetup(char *handranksfile, int flags, UpdateMode mode);
 
 /*
  * Shut down all resources for the client
@@ -26,68 +47,95 @@ void PokerClientSetup(char *handranksfile);
 static
 void PokerClientShutdown(void);
 
+/*
+ * Poll the server for game states until the client is stopped
+ * AI: the AI to play with
+ * mode: UPDATE_POLL or UPDATE_LONG_POLL
+ */
+static
+void PollGameState(PokerAI *AI, UpdateMode mode);
+
+/*
+ * Load a game state and act on it if it is the AI's turn
+ * state: the JSON text of the game state
+ * _AI: the PokerAI to play with
+ * return: true, so an event stream keeps listening
+ */
+static
+bool HandleGameState(const char *state, void *_AI);
+
+/*
+ * Decide on an action and post it to the server
+ * AI: the AI whose turn it is
+ */
+static
+void TakeTurn(PokerAI *AI);
+
 int main(int argc, char **argv)
 {
     PokerAI *AI = NULL;
-    cJSON *response = NULL;
-    char *action = NULL;
     char *handranksfile = DEFAULT_HANDRANKS_FILE;
-    char postURL[BUF_SIZE] = {0};
+    UpdateMode mode = UPDATE_POLL;
+    int flags = 0;
+    bool pin = false;
 
     //Set up the poker client
-    if (argc == 2)
+    for (int i = 1; i < argc; i++)
     {
-        handranksfile = argv[1];
+        if (!strcmp(argv[i], "--pin"))
+        {
+            pin = true;
+        }
+        else if (!strcmp(argv[i], "--replicate"))
+        {
+            flags |= LOAD_REPLICATE;
+        }
+        else if (!strcmp(argv[i], "--interleave"))
+        {
+            flags |= LOAD_INTERLEAVE;
+        }
+        else if (!strcmp(argv[i], "--long-poll"))
+        {
+            mode = UPDATE_LONG_POLL;
+        }
+        else if (!strcmp(argv[i], "--stream"))
+        {
+            mode = UPDATE_STREAM;
+        }
+        else
+        {
+            handranksfile = argv[i];
+        }
     }
 
-    PokerClientSetup(handranksfile);
+    PokerClientSetup(handranksfile, flags, mode);
     AI = CreatePokerAI(TIMEOUT);
-
-    while (1)
+    SetTargetError(AI, TARGET_ERROR);
+    SetSpeculation(AI, true);
+    SetRangeModeling(AI, true);
+    SetStratifiedRunouts(AI, true);
+    SetEquityCache(AI, Cache);
+    if (pin && !SetWorkerPinning(AI, true))
     {
-        //Get the game state
-        response = httpGetJSON(GET_URL);
-        if (!response)
-        {
-            PRINTERR("Could not load game state!\n");
-            sleep(1);
-            continue;
-        }
-
-        UpdateGameState(AI, response);
-        cJSON_Delete(response);
+        PRINTERR("Could not pin every worker to a CPU\n");
+    }
 
-        //If it's the AI's turn, make a decision
-        if (MyTurn(AI))
+    if (mode == UPDATE_STREAM)
+    {
+        //Reconnect whenever the stream ends or goes quiet,
+        //backing off while it keeps ending without a game state
+        int delay = 0;
+        while (1)
         {
-            int attempts = 0;
-
-            //Run Monte Carlo simulations to determine the best action
-            action = GetBestAction(AI);
-            sprintf(postURL, "%s%s", POST_URL, action);
-            WriteAction(AI, stdout);
-
-            //Post the action to the server
-            while (attempts < MAX_TRIES && !response)
+            if (!ListenToStream(StreamSession, STREAM_URL, HandleGameState, AI, &delay))
             {
-                response = httpPostJSON(postURL, action);
-                attempts++;
-
-                if (!response)
-                {
-                    PRINTERR("Could not POST response (attempt %d)\n", attempts);
-                }
-                cJSON_Delete(response);
-            }
-
-            if (attempts == MAX_TRIES)
-            {
-                PRINTERR("Was not able to POST!\n");
+                PRINTERR("Lost the game state stream!\n");
             }
         }
-
-        //Wait one second before updating game state again
-        sleep(1);
+    }
+    else
+    {
+        PollGameState(AI, mode);
     }
 
     //Clean up resources
@@ -99,20 +147,36 @@ int main(int argc, char **argv)
 /*
  * Set up everything necessary for the client
  * handranksfile: the file containing the hand ranks look up table
+ * flags: extra LoadFlags for the table, such as LOAD_REPLICATE
+ * mode: how the client will receive game states
  */
 static
-void PokerClientSetup(char *handranksfile)
+void PokerClientSetup(char *handranksfile, int flags, UpdateMode mode)
 {
     printf("Initializing poker tables...\t");
     fflush(stdout);
-    InitEvaluator(handranksfile);
+    //The client is long-lived, so fault the whole table in up front
+    InitEvaluatorWithFlags(handranksfile, LOAD_MMAP | LOAD_POPULATE | flags);
     printf("Tables initialized\n");
 
     printf("Starting curl session...\t");
     fflush(stdout);
     BeginConnectionSession();
+    Session = CreateHttpSession();
+    if (mode == UPDATE_STREAM)
+    {
+        StreamSession = CreateHttpSession();
+    }
+
+    if (!Session || (mode == UPDATE_STREAM && !StreamSession))
+    {
+        PRINTERR("Could not create a curl handle\n");
+        exit(1);
+    }
     printf("Session started\n");
 
+    Cache = CreateEquityCache(DEFAULT_CACHE_ENTRIES);
+
     printf("\nPoker client running\n\n");
 }
 
@@ -123,6 +187,113 @@ static
 void PokerClientShutdown(void)
 {
     printf("Ending curl session...\t");
+    DestroyHttpSession(StreamSession);
+    DestroyHttpSession(Session);
     EndConnectionSession();
     printf("Session ended\n");
+
+    DestroyEquityCache(Cache);
+}
+
+/*
+ * Poll the server for game states until the client is stopped
+ * AI: the AI to play with
+ * mode: UPDATE_POLL or UPDATE_LONG_POLL
+ */
+static
+void PollGameState(PokerAI *AI, UpdateMode mode)
+{
+    const char *state = NULL;
+    StatePoller *poller = CreateStatePoller(Session, GET_URL, mode == UPDATE_LONG_POLL);
+
+    if (!poller)
+    {
+        PRINTERR("Could not create a poller\n");
+        exit(1);
+    }
+
+    while (1)
+    {
+        //Get the game state when due, parsed straight from the response text
+        state = PollState(poller, NULL);
+        if (!state || !UpdateGameStateFromText(AI, state))
+        {
+            PRINTERR("Could not load game state!\n");
+            sleep(1);
+            continue;
+        }
+
+        //If it's the AI's turn, make a decision and look for the next state soon
+        if (MyTurn(AI))
+        {
+            TakeTurn(AI);
+            HurryStatePoller(poller);
+        }
+    }
+
+    DestroyStatePoller(poller);
+}
+
+/*
+ * Load a game state and act on it if it is the AI's turn
+ * state: the JSON text of the game state
+ * _AI: the PokerAI to play with
+ * return: true, so an event stream keeps listening
+ */
+static
+bool HandleGameState(const char *state, void *_AI)
+{
+    PokerAI *AI = (PokerAI *)_AI;
+
+    if (!UpdateGameStateFromText(AI, state))
+    {
+        PRINTERR("Could not load game state!\n");
+        return true;
+    }
+
+    //The turn starts now, so the AI gets the whole timeout
+    if (MyTurn(AI))
+    {
+        TakeTurn(AI);
+    }
+
+    return true;
+}
+
+/*
+ * Decide on an action and post it to the server
+ * AI: the AI whose turn it is
+ */
+static
+void TakeTurn(PokerAI *AI)
+{
+    cJSON *response = NULL;
+    const char *reply = NULL;
+    char *action = NULL;
+    char postURL[BUF_SIZE] = {0};
+    int attempts = 0;
+
+    //Run Monte Carlo simulations to determine the best action
+    action = GetBestAction(AI);
+    sprintf(postURL, "%s%s", POST_URL, action);
+    WriteAction(AI, stdout);
+
+    //Post the action to the server
+    while (attempts < MAX_TRIES && !response)
+    {
+        reply = HttpSessionPost(Session, postURL, action);
+        response = reply ? cJSON_Parse(reply) : NULL;
+        attempts++;
+
+        if (!response)
+        {
+            PRINTERR("Could not POST response (attempt %d)\n", attempts);
+        }
+    }
+
+    if (!response)
+    {
+        PRINTERR("Was not able to POST!\n");
+    }
+    cJSON_Delete(response);
 }
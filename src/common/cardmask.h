@@ -0,0 +1,251 @@
+#ifndef __CARDMASK_H__
+#define __CARDMASK_H__
+
+#include <stdint.h>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#include "random.h"
+
+//A set of cards as a 64-bit mask with 16 bits per suit,
+//so bit (suit * 16 + rank) holds the card rank * 4 + suit + 1
+typedef uint64_t CardMask;
+
+#define SUIT_BITS               16
+#define RANK_MASK               0x1fff //the 13 ranks of one suit
+#define FULL_DECK_MASK          0x1fff1fff1fff1fffull
+
+//GetMaskHandValue keeps the hand category (1 == high card up to
+//9 == straight flush, as in the 2+2 table) above this shift
+#define MASK_CATEGORY_SHIFT     26
+#define MASK_PRIMARY_SHIFT      13
+
+/*
+ * Get the mask holding a single card
+ * card: a card numbered like StringToCard (1 to 52)
+ * return: the card's mask
+ */
+static inline
+CardMask CardToMask(int card)
+{
+    card--;
+    return 1ull << ((card & 3) * SUIT_BITS + (card >> 2));
+}
+
+/*
+ * Get the mask holding every card of an array
+ * cards: the cards to add
+ * num_cards: the number of cards
+ * return: the cards' mask
+ */
+static inline
+CardMask CardsToMask(int *cards, int num_cards)
+{
+    CardMask mask = 0;
+
+    for (int i = 0; i < num_cards; i++)
+    {
+        mask |= CardToMask(cards[i]);
+    }
+
+    return mask;
+}
+
+//Count the bytes of x with their high bit set
+#define SELECT_COUNT(x) \
+    (int)((((x) & 0x8080808080808080ull) >> 7) * 0x0101010101010101ull >> 56)
+
+/*
+ * Find the position of the k-th lowest set bit of a mask
+ * Uses pdep when built for BMI2, otherwise a broadword select
+ * mask: the mask to search (must have more than k bits set)
+ * k: which set bit to find, counting from 0
+ * return: the bit position
+ */
+static inline
+int SelectBit(CardMask mask, int k)
+{
+#ifdef __BMI2__
+    return __builtin_ctzll(_pdep_u64(1ull << k, mask));
+#else
+    const uint64_t ones = 0x0101010101010101ull;
+    const uint64_t highs = 0x8080808080808080ull;
+    uint64_t sums;
+    uint64_t bits;
+    int place;
+
+    //Count the bits of each byte, then the bits up to and including each byte
+    sums = mask - ((mask >> 1) & 0x5555555555555555ull);
+    sums = (sums & 0x3333333333333333ull) + ((sums >> 2) & 0x3333333333333333ull);
+    sums = ((sums + (sums >> 4)) & 0x0f0f0f0f0f0f0f0full) * ones;
+
+    //The bit is in the first byte whose running count passes k
+    place = SELECT_COUNT(((k * ones) | highs) - sums) * 8;
+    k -= ((sums << 8) >> place) & 0xff;
+
+    //Then do the same within that byte, with one byte per bit
+    bits = (((mask >> place) & 0xff) * ones) & 0x8040201008040201ull;
+    bits = (((bits + 0x7f7f7f7f7f7f7f7full) | bits) & highs) >> 7;
+
+    return place + SELECT_COUNT(((k * ones) | highs) - bits * ones);
+#endif
+}
+
+/*
+ * Randomly deal a card out of a deck mask
+ * rng: the generator to draw with
+ * deck: the deck to deal from, the card is removed from it
+ * psize: a pointer to the number of cards in the deck
+ * return: the mask of the dealt card
+ */
+static inline
+CardMask DealMaskCard(RandomState *rng, CardMask *deck, int *psize)
+{
+    CardMask card = 1ull << SelectBit(*deck, RandomBelow(rng, (*psize)--));
+    *deck ^= card;
+
+    return card;
+}
+
+/*
+ * Keep the highest bits of a rank mask
+ * ranks: the rank mask
+ * count: how many of its highest bits to keep
+ * return: the highest count bits of ranks
+ */
+static inline
+uint32_t HighestRanks(uint32_t ranks, int count)
+{
+    uint32_t bits = ranks - ((ranks >> 1) & 0x5555);
+
+    //Count the ranks, then clear the lowest ones until count are left
+    bits = (bits & 0x3333) + ((bits >> 2) & 0x3333);
+    bits = (bits + (bits >> 4)) & 0x0f0f;
+    bits = (bits + (bits >> 8)) & 0x1f;
+
+    for (int i = count; i < (int)bits; i++)
+    {
+        ranks &= ranks - 1;
+    }
+
+    return ranks;
+}
+
+/*
+ * Find the highest straight in a rank mask
+ * ranks: the rank mask
+ * return: 1 + the rank of the straight's top card, or 0 if there is none
+ */
+static inline
+int HighestStraight(uint32_t ranks)
+{
+    //Put the ace below the deuce as well, then find five ranks in a row
+    uint32_t runs = (ranks << 1) | (ranks >> 12);
+
+    runs &= runs << 1;
+    runs &= runs << 1;
+    runs &= runs << 2;
+
+    return runs ? 32 - __builtin_clz(runs) - 1 : 0;
+}
+
+/*
+ * Evaluate a hand of 5 to 7 cards without any lookup table
+ * Values order hands exactly like GetHandValue and the category
+ * is the same, but the values themselves differ from the 2+2 ranks
+ * hand: the hand's cards
+ * return: an int representing the relative rank of the hand
+ * Higher number == stronger hand
+ */
+static inline
+int GetMaskHandValue(CardMask hand)
+{
+    uint32_t s = hand & RANK_MASK;
+    uint32_t c = (hand >> SUIT_BITS) & RANK_MASK;
+    uint32_t d = (hand >> (2 * SUIT_BITS)) & RANK_MASK;
+    uint32_t h = (hand >> (3 * SUIT_BITS)) & RANK_MASK;
+    uint32_t ranks = s | c | d | h;
+    uint64_t suitcount;
+    uint32_t flush;
+    uint32_t ones, twos, fours, carry;
+    uint32_t trips, pairs, top;
+    int straight;
+
+    //Count each suit's cards in its own 16 bits, then look for 5 or more
+    suitcount = hand - ((hand >> 1) & 0x5555555555555555ull);
+    suitcount = (suitcount & 0x3333333333333333ull) + ((suitcount >> 2) & 0x3333333333333333ull);
+    suitcount = (suitcount + (suitcount >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    suitcount = (suitcount + (suitcount >> 8)) & 0x001f001f001f001full;
+    suitcount = (suitcount + 0x0003000300030003ull) & 0x0008000800080008ull;
+
+    //With 7 cards a flush rules out quads and a full house
+    if (suitcount)
+    {
+        flush = (hand >> (__builtin_ctzll(suitcount) & ~(SUIT_BITS - 1))) & RANK_MASK;
+        straight = HighestStraight(flush);
+        if (straight)
+        {
+            return 9 << MASK_CATEGORY_SHIFT | straight << MASK_PRIMARY_SHIFT;
+        }
+
+        return 6 << MASK_CATEGORY_SHIFT | HighestRanks(flush, 5) << MASK_PRIMARY_SHIFT;
+    }
+
+    //Add up the suits one rank bit at a time
+    ones = s ^ c;
+    twos = s & c;
+    carry = ones & d;
+    ones ^= d;
+    fours = twos & carry;
+    twos ^= carry;
+    carry = ones & h;
+    ones ^= h;
+    fours |= twos & carry;
+    twos ^= carry;
+
+    if (fours)
+    {
+        return 8 << MASK_CATEGORY_SHIFT | fours << MASK_PRIMARY_SHIFT | HighestRanks(ranks & ~fours, 1);
+    }
+
+    trips = ones & twos;
+    pairs = twos & ~ones;
+    if (trips)
+    {
+        //A second set of trips plays as the pair of a full house
+        top = HighestRanks(trips, 1);
+        pairs |= trips ^ top;
+        if (pairs)
+        {
+            return 7 << MASK_CATEGORY_SHIFT | top << MASK_PRIMARY_SHIFT | HighestRanks(pairs, 1);
+        }
+    }
+
+    straight = HighestStraight(ranks);
+    if (straight)
+    {
+        return 5 << MASK_CATEGORY_SHIFT | straight << MASK_PRIMARY_SHIFT;
+    }
+
+    if (trips)
+    {
+        return 4 << MASK_CATEGORY_SHIFT | trips << MASK_PRIMARY_SHIFT | HighestRanks(ranks & ~trips, 2);
+    }
+
+    if (pairs)
+    {
+        if (pairs & (pairs - 1))
+        {
+            top = HighestRanks(pairs, 2);
+            return 3 << MASK_CATEGORY_SHIFT | top << MASK_PRIMARY_SHIFT | HighestRanks(ranks & ~top, 1);
+        }
+
+        return 2 << MASK_CATEGORY_SHIFT | pairs << MASK_PRIMARY_SHIFT | HighestRanks(ranks & ~pairs, 3);
+    }
+
+    return 1 << MASK_CATEGORY_SHIFT | HighestRanks(ranks, 5) << MASK_PRIMARY_SHIFT;
+}
+
+#endif
@@ -0,0 +1,445 @@
+#include "enumerator.h"
+
+#define NUM_SUITS       4
+#define MAX_SUIT_PERMS  24  //4 factorial
+
+//Everything the recursive enumeration needs to share
+typedef struct enumstate
+{
+    int live[NUM_DECK];
+    int num_live;
+    bool used[NUM_DECK];
+    int num_opponents;
+    int *hand;
+
+    //Score of every pair of hole cards on the current board
+    int pairscore[NUM_DECK][NUM_DECK];
+    int myscore;
+
+    //Suit permutations that map the hand and known community cards onto
+    //themselves, so boards they map onto each other have the same outcome
+    int perms[MAX_SUIT_PERMS][NUM_SUITS];
+    int num_perms;
+
+    //The community cards dealt by the enumeration so far, and how many
+    //boards the current one stands for
+    CardMask dealt;
+    long long weight;
+
+    //Whether ties split the pot, and the AI's shares of the pots so far
+    bool split_ties;
+    double shares;
+
+    long long won;
+    long long total;
+} EnumState;
+
+/*
+ * Play out every possible deal of the rest of the game
+ * game: the game state to enumerate deals for
+ * split_ties: whether to work out the AI's share of split pots
+ * won: where to store the number of deals won (ties count as wins)
+ * shares: where to store the AI's total share of the pots (may be NULL)
+ * return: the number of deals enumerated
+ */
+static
+long long Enumerate(GameState *game, bool split_ties, long long *won, double *shares);
+
+/*
+ * Number of ways to choose k cards from n
+ * return: n choose k
+ */
+static
+double Choose(int n, int k);
+
+/*
+ * Number of ways to deal hole cards to the remaining opponents
+ * numcards: the number of cards still free
+ * numopponents: the number of opponents still without cards
+ * return: the number of ways to deal them
+ */
+static
+long long OpponentDeals(int numcards, int numopponents);
+
+/*
+ * Find every suit permutation that leaves the hand and the known community cards unchanged
+ * state: the enumeration state, whose perms are filled in
+ * hand: the AI's hole cards
+ * community: the known community cards
+ */
+static
+void FindSuitSymmetries(EnumState *state, CardMask hand, CardMask community);
+
+/*
+ * Rename the suits of a set of cards
+ * cards: the cards to rename
+ * perm: the new suit of each suit
+ * return: the renamed cards
+ */
+static
+CardMask PermuteSuits(CardMask cards, const int *perm);
+
+/*
+ * Count the boards the dealt community cards stand for
+ * Only the first board of each set of boards that the symmetries map onto
+ * each other is played out, standing for all of them
+ * state: the enumeration state
+ * return: the number of boards, or 0 if another board stands for this one
+ */
+static
+long long BoardWeight(EnumState *state);
+
+/*
+ * Deal every remaining community card combination
+ * state: the enumeration state
+ * start: the first index in state->live that may be dealt next
+ * numcommunity: the number of community cards dealt so far
+ * board: the board holding the dealt community cards
+ */
+static
+void EnumerateBoards(EnumState *state, int start, int numcommunity, const BoardState *board);
+
+/*
+ * Deal every combination of hole cards to the remaining opponents
+ * state: the enumeration state
+ * opp: the opponent being dealt to
+ * numfree: the number of cards not yet dealt
+ * best: the best opponent score dealt so far
+ * ties: how many opponents dealt so far have the best score
+ */
+static
+void EnumerateOpponents(EnumState *state, int opp, int numfree, int best, int ties);
+
+/*
+ * Count every way the rest of the game could be dealt:
+ * the missing community cards and each playing opponent's hole cards
+ * game: the game state to count deals for
+ * return: the number of deals (a double, since it can be astronomical)
+ */
+double CountDeals(GameState *game)
+{
+    int numcards = __builtin_popcountll(game->deck);
+    int missing = NUM_COMMUNITY - game->communitysize;
+    double deals;
+
+    deals = Choose(numcards, missing);
+    numcards -= missing;
+    for (int opp = 0; opp < game->num_playing; opp++)
+    {
+        deals *= Choose(numcards, NUM_HAND);
+        numcards -= NUM_HAND;
+    }
+
+    return deals;
+}
+
+/*
+ * Play out every possible deal of the rest of the game
+ * and count how many the AI wins (ties count as wins)
+ * game: the game state to enumerate deals for
+ * won: where to store the number of deals won
+ * return: the number of deals enumerated
+ */
+long long EnumerateDeals(GameState *game, long long *won)
+{
+    return Enumerate(game, false, won, NULL);
+}
+
+/*
+ * Play out every possible deal of the rest of the game
+ * and work out the AI's share of the pot, with ties split
+ * between every player who has the best hand
+ * game: the game state to enumerate deals for
+ * won: where to store the number of deals won (ties count as wins)
+ * equity: where to store the AI's average share of the pot
+ * return: the number of deals enumerated
+ */
+long long EnumerateEquity(GameState *game, long long *won, double *equity)
+{
+    double shares;
+    long long total = Enumerate(game, true, won, &shares);
+
+    *equity = total > 0 ? shares / total : 0;
+    return total;
+}
+
+/*
+ * Play out every possible deal of the rest of the game
+ * game: the game state to enumerate deals for
+ * split_ties: whether to work out the AI's share of split pots
+ * won: where to store the number of deals won (ties count as wins)
+ * shares: where to store the AI's total share of the pots (may be NULL)
+ * return: the number of deals enumerated
+ */
+static
+long long Enumerate(GameState *game, bool split_ties, long long *won, double *shares)
+{
+    //Too large for the stack of a worker thread
+    EnumState *state = malloc(sizeof(*state));
+    BoardState board;
+    long long total;
+
+    state->split_ties = split_ties;
+    state->shares = 0;
+    state->num_live = GetLiveCards(game, state->live);
+    state->num_opponents = game->num_playing;
+    state->hand = game->hand;
+    state->won = 0;
+    state->total = 0;
+    state->dealt = 0;
+    memset(state->used, 0, sizeof(state->used));
+    FindSuitSymmetries(state, CardsToMask(game->hand, NUM_HAND), CardsToMask(game->community, game->communitysize));
+
+    //Hole cards are dealt after the board, so there must be enough left for everyone
+    if (state->num_live - (NUM_COMMUNITY - game->communitysize) >= NUM_HAND * game->num_playing)
+    {
+        //The known community cards are added only once
+        StartBoard(&board);
+        AddBoardCards(&board, game->community, game->communitysize);
+        EnumerateBoards(state, 0, game->communitysize, &board);
+    }
+
+    *won = state->won;
+    if (shares) *shares = state->shares;
+    total = state->total;
+    free(state);
+    return total;
+}
+
+/*
+ * Number of ways to choose k cards from n
+ * return: n choose k
+ */
+static
+double Choose(int n, int k)
+{
+    double result = 1;
+
+    if (k < 0 || k > n) return 0;
+
+    for (int i = 0; i < k; i++)
+    {
+        result = result * (n - i) / (i + 1);
+    }
+
+    return result;
+}
+
+/*
+ * Number of ways to deal hole cards to the remaining opponents
+ * numcards: the number of cards still free
+ * numopponents: the number of opponents still without cards
+ * return: the number of ways to deal them
+ */
+static
+long long OpponentDeals(int numcards, int numopponents)
+{
+    long long deals = 1;
+
+    for (int opp = 0; opp < numopponents; opp++)
+    {
+        deals *= numcards * (numcards - 1) / 2;
+        numcards -= NUM_HAND;
+    }
+
+    return deals;
+}
+
+/*
+ * Find every suit permutation that leaves the hand and the known community cards unchanged
+ * state: the enumeration state, whose perms are filled in
+ * hand: the AI's hole cards
+ * community: the known community cards
+ */
+static
+void FindSuitSymmetries(EnumState *state, CardMask hand, CardMask community)
+{
+    int perm[NUM_SUITS];
+
+    state->num_perms = 0;
+
+    //Suits holding exactly the same ranks in the hand and on the board
+    //can be swapped, which always includes the suits nobody has seen yet
+    for (perm[0] = 0; perm[0] < NUM_SUITS; perm[0]++)
+    {
+        for (perm[1] = 0; perm[1] < NUM_SUITS; perm[1]++)
+        {
+            if (perm[1] == perm[0]) continue;
+
+            for (perm[2] = 0; perm[2] < NUM_SUITS; perm[2]++)
+            {
+                if (perm[2] == perm[0] || perm[2] == perm[1]) continue;
+
+                perm[3] = 6 - perm[0] - perm[1] - perm[2];
+                if (PermuteSuits(hand, perm) == hand && PermuteSuits(community, perm) == community)
+                {
+                    memcpy(state->perms[state->num_perms++], perm, sizeof(perm));
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Rename the suits of a set of cards
+ * cards: the cards to rename
+ * perm: the new suit of each suit
+ * return: the renamed cards
+ */
+static
+CardMask PermuteSuits(CardMask cards, const int *perm)
+{
+    CardMask renamed = 0;
+
+    for (int suit = 0; suit < NUM_SUITS; suit++)
+    {
+        renamed |= ((cards >> (suit * SUIT_BITS)) & RANK_MASK) << (perm[suit] * SUIT_BITS);
+    }
+
+    return renamed;
+}
+
+/*
+ * Count the boards the dealt community cards stand for
+ * Only the first board of each set of boards that the symmetries map onto
+ * each other is played out, standing for all of them
+ * state: the enumeration state
+ * return: the number of boards, or 0 if another board stands for this one
+ */
+static
+long long BoardWeight(EnumState *state)
+{
+    CardMask image;
+    int fixed = 0;
+
+    for (int i = 0; i < state->num_perms; i++)
+    {
+        image = PermuteSuits(state->dealt, state->perms[i]);
+        if (image < state->dealt) return 0;
+
+        fixed += (image == state->dealt);
+    }
+
+    //The board stands for every board the symmetries map it onto
+    return state->num_perms / fixed;
+}
+
+/*
+ * Deal every remaining community card combination
+ * state: the enumeration state
+ * start: the first index in state->live that may be dealt next
+ * numcommunity: the number of community cards dealt so far
+ * board: the board holding the dealt community cards
+ */
+static
+void EnumerateBoards(EnumState *state, int start, int numcommunity, const BoardState *board)
+{
+    BoardState next;
+    int card;
+    int numfree;
+    int hole[NUM_HAND];
+
+    if (numcommunity < NUM_COMMUNITY)
+    {
+        for (int i = start; i < state->num_live; i++)
+        {
+            card = state->live[i];
+            state->used[card] = true;
+            state->dealt ^= CardToMask(card);
+            next = *board;
+            AddBoardCards(&next, &card, 1);
+            EnumerateBoards(state, i + 1, numcommunity + 1, &next);
+            state->dealt ^= CardToMask(card);
+            state->used[card] = false;
+        }
+
+        return;
+    }
+
+    state->weight = BoardWeight(state);
+    if (state->weight == 0) return;
+
+    //The board is complete: score the hero and every possible pair of hole cards once
+    state->myscore = GetHandValueOnBoard(board, state->hand);
+    numfree = 0;
+    for (int i = 0; i < state->num_live; i++)
+    {
+        if (state->used[state->live[i]]) continue;
+        numfree++;
+
+        hole[0] = state->live[i];
+        for (int j = i + 1; j < state->num_live; j++)
+        {
+            if (state->used[state->live[j]]) continue;
+
+            hole[1] = state->live[j];
+            state->pairscore[hole[0]][hole[1]] = GetHandValueOnBoard(board, hole);
+        }
+    }
+
+    EnumerateOpponents(state, 0, numfree, 0, 0);
+}
+
+/*
+ * Deal every combination of hole cards to the remaining opponents
+ * state: the enumeration state
+ * opp: the opponent being dealt to
+ * numfree: the number of cards not yet dealt
+ * best: the best opponent score dealt so far
+ * ties: how many opponents dealt so far have the best score
+ */
+static
+void EnumerateOpponents(EnumState *state, int opp, int numfree, int best, int ties)
+{
+    int first;
+    int second;
+    int score;
+
+    //Once someone beats the hero, every way to finish the deal is a loss
+    if (best > state->myscore)
+    {
+        state->total += state->weight * OpponentDeals(numfree, state->num_opponents - opp);
+        return;
+    }
+
+    if (opp == state->num_opponents)
+    {
+        state->won += state->weight;
+        state->total += state->weight;
+
+        //The AI shares the pot with every opponent holding the same hand
+        if (state->split_ties)
+        {
+            state->shares += (double)state->weight / (best == state->myscore ? ties + 1 : 1);
+        }
+        return;
+    }
+
+    for (int i = 0; i < state->num_live; i++)
+    {
+        first = state->live[i];
+        if (state->used[first]) continue;
+        state->used[first] = true;
+
+        for (int j = i + 1; j < state->num_live; j++)
+        {
+            second = state->live[j];
+            if (state->used[second]) continue;
+            state->used[second] = true;
+
+            score = state->pairscore[first][second];
+            if (score > best)
+            {
+                EnumerateOpponents(state, opp + 1, numfree - NUM_HAND, score, 1);
+            }
+            else
+            {
+                EnumerateOpponents(state, opp + 1, numfree - NUM_HAND, best, ties + (score == best));
+            }
+
+            state->used[second] = false;
+        }
+
+        state->used[first] = false;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef __ENUMERATOR_H__
+#define __ENUMERATOR_H__
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "evaluator.h"
+#include "gamestate.h"
+
+/*
+ * Count every way the rest of the game could be dealt:
+ * the missing community cards and each playing opponent's hole cards
+ * game: the game state to count deals for
+ * return: the number of deals (a double, since it can be astronomical)
+ */
+double CountDeals(GameState *game);
+
+/*
+ * Play out every possible deal of the rest of the game
+ * and count how many the AI wins (ties count as wins)
+ * game: the game state to enumerate deals for
+ * won: where to store the number of deals won
+ * return: the number of deals enumerated
+ */
+long long EnumerateDeals(GameState *game, long long *won);
+
+/*
+ * Play out every possible deal of the rest of the game
+ * and work out the AI's share of the pot, with ties split
+ * between every player who has the best hand
+ * game: the game state to enumerate deals for
+ * won: where to store the number of deals won (ties count as wins)
+ * equity: where to store the AI's average share of the pot
+ * return: the number of deals enumerated
+ */
+long long EnumerateEquity(GameState *game, long long *won, double *equity);
+
+#endif
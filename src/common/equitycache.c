@@ -0,0 +1,393 @@
+#include "equitycache.h"
+
+//One spot as it is written to a cache file
+typedef struct cacherecord
+{
+    uint32_t suits[4];
+    uint32_t num_playing;
+    uint32_t reserved;
+    int64_t won;
+    int64_t simulated;
+} CacheRecord;
+
+/*
+ * Hash a key into a bucket
+ * cache: the cache whose buckets are used
+ * key: the key to hash
+ * return: the bucket index
+ */
+static
+int HashKey(EquityCache *cache, const EquityKey *key);
+
+/*
+ * Find a key's entry
+ * cache: the cache to search
+ * key: the key to find
+ * return: the index of the entry, or -1 if the key is not cached
+ */
+static
+int FindEntry(EquityCache *cache, const EquityKey *key);
+
+/*
+ * Take an entry out of the recency list
+ * cache: the cache holding the entry
+ * index: the entry to unlink
+ */
+static
+void UnlinkEntry(EquityCache *cache, int index);
+
+/*
+ * Put an entry at the newest end of the recency list
+ * cache: the cache holding the entry
+ * index: the entry to link
+ */
+static
+void LinkNewest(EquityCache *cache, int index);
+
+/*
+ * Take an entry out of its hash chain
+ * cache: the cache holding the entry
+ * index: the entry to remove
+ */
+static
+void RemoveFromChain(EquityCache *cache, int index);
+
+/*
+ * Get the key of a spot, the same for every relabeling of its suits
+ * hand: the AI's two hole cards
+ * community: the known community cards, in any order
+ * communitysize: the number of community cards
+ * num_playing: the number of opponents
+ * return: the spot's key
+ */
+EquityKey MakeEquityKey(const int *hand, const int *community, int communitysize, int num_playing)
+{
+    CardMask handmask = CardsToMask((int *)hand, NUM_HAND);
+    CardMask boardmask = CardsToMask((int *)community, communitysize);
+    EquityKey key;
+    uint32_t suit;
+    int j;
+
+    //Two spots are isomorphic exactly when they have the same suits up to
+    //order, so sorting the suits gives one key per class
+    for (int i = 0; i < 4; i++)
+    {
+        suit = (uint32_t)((handmask >> (i * SUIT_BITS)) & RANK_MASK) << 13;
+        suit |= (uint32_t)((boardmask >> (i * SUIT_BITS)) & RANK_MASK);
+
+        for (j = i; j > 0 && key.suits[j - 1] < suit; j--)
+        {
+            key.suits[j] = key.suits[j - 1];
+        }
+        key.suits[j] = suit;
+    }
+
+    key.num_playing = num_playing;
+    return key;
+}
+
+/*
+ * Create an empty cache
+ * capacity: the most spots it holds, at least one
+ * return: the new cache
+ */
+EquityCache *CreateEquityCache(int capacity)
+{
+    EquityCache *cache = malloc(sizeof(EquityCache));
+
+    //A full cache evicts an entry to store one, so it needs somewhere to start
+    capacity = capacity > 0 ? capacity : 1;
+
+    //Keep the chains short with at least two buckets per entry
+    cache->num_buckets = 1;
+    while (cache->num_buckets < 2 * capacity)
+    {
+        cache->num_buckets <<= 1;
+    }
+
+    cache->entries = malloc(sizeof(CacheEntry) * capacity);
+    cache->buckets = malloc(sizeof(int) * cache->num_buckets);
+    memset(cache->buckets, -1, sizeof(int) * cache->num_buckets);
+
+    cache->capacity = capacity;
+    cache->count = 0;
+    cache->newest = -1;
+    cache->oldest = -1;
+    cache->hits = 0;
+    cache->misses = 0;
+
+    return cache;
+}
+
+/*
+ * Free a cache and all of its entries
+ * cache: the cache to destroy
+ */
+void DestroyEquityCache(EquityCache *cache)
+{
+    if (!cache) return;
+
+    free(cache->entries);
+    free(cache->buckets);
+    free(cache);
+}
+
+/*
+ * Look up the games simulated for a spot, marking it as recently used
+ * cache: the cache to look in
+ * key: the spot's key
+ * won: where to store the games won
+ * simulated: where to store the games simulated
+ * return: true if the spot is in the cache
+ */
+bool LookupEquity(EquityCache *cache, const EquityKey *key, long long *won, long long *simulated)
+{
+    int index = FindEntry(cache, key);
+
+    if (index < 0)
+    {
+        cache->misses++;
+        return false;
+    }
+
+    cache->hits++;
+    UnlinkEntry(cache, index);
+    LinkNewest(cache, index);
+
+    *won = cache->entries[index].won;
+    *simulated = cache->entries[index].simulated;
+    return true;
+}
+
+/*
+ * Record the games simulated for a spot, replacing what was there
+ * The least recently used spot makes room if the cache is full
+ * cache: the cache to store in
+ * key: the spot's key
+ * won: the games won
+ * simulated: the games simulated
+ */
+void StoreEquity(EquityCache *cache, const EquityKey *key, long long won, long long simulated)
+{
+    int index = FindEntry(cache, key);
+    int bucket;
+
+    if (index >= 0)
+    {
+        UnlinkEntry(cache, index);
+    }
+    else
+    {
+        if (cache->count < cache->capacity)
+        {
+            index = cache->count++;
+        }
+        else
+        {
+            //Reuse the least recently used entry
+            index = cache->oldest;
+            UnlinkEntry(cache, index);
+            RemoveFromChain(cache, index);
+        }
+
+        bucket = HashKey(cache, key);
+        cache->entries[index].key = *key;
+        cache->entries[index].chain = cache->buckets[bucket];
+        cache->buckets[bucket] = index;
+    }
+
+    cache->entries[index].won = won;
+    cache->entries[index].simulated = simulated;
+    LinkNewest(cache, index);
+}
+
+/*
+ * Add the spots of a file written by SaveEquityCache to a cache
+ * A spot already in the cache keeps whichever result has more games
+ * cache: the cache to fill
+ * path: the file to read
+ * return: false if the file could not be read or is not a cache file
+ */
+bool LoadEquityCache(EquityCache *cache, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    char magic[EQUITY_CACHE_MAGIC_LEN];
+    CacheRecord record;
+    EquityKey key;
+    int index;
+
+    if (!file) return false;
+
+    if (fread(magic, 1, EQUITY_CACHE_MAGIC_LEN, file) != EQUITY_CACHE_MAGIC_LEN
+            || memcmp(magic, EQUITY_CACHE_MAGIC, EQUITY_CACHE_MAGIC_LEN))
+    {
+        fclose(file);
+        return false;
+    }
+
+    //Records are oldest first, so the newest spots end up most recent
+    while (fread(&record, sizeof(record), 1, file) == 1)
+    {
+        memcpy(key.suits, record.suits, sizeof(key.suits));
+        key.num_playing = record.num_playing;
+
+        //Not a lookup, so loading leaves the hit and miss counts alone
+        index = FindEntry(cache, &key);
+        if (index >= 0 && cache->entries[index].simulated >= record.simulated)
+        {
+            continue;
+        }
+
+        StoreEquity(cache, &key, record.won, record.simulated);
+    }
+
+    fclose(file);
+    return true;
+}
+
+/*
+ * Write every spot of a cache to a file, oldest first
+ * cache: the cache to write
+ * path: the file to write
+ * return: false if the file could not be written
+ */
+bool SaveEquityCache(EquityCache *cache, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    CacheEntry *entry;
+    CacheRecord record;
+    bool written;
+
+    if (!file) return false;
+
+    written = fwrite(EQUITY_CACHE_MAGIC, 1, EQUITY_CACHE_MAGIC_LEN, file) == EQUITY_CACHE_MAGIC_LEN;
+    for (int i = cache->oldest; i >= 0 && written; i = entry->newer)
+    {
+        entry = &cache->entries[i];
+
+        memcpy(record.suits, entry->key.suits, sizeof(record.suits));
+        record.num_playing = entry->key.num_playing;
+        record.reserved = 0;
+        record.won = entry->won;
+        record.simulated = entry->simulated;
+
+        written = fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+
+    return (fclose(file) == 0) && written;
+}
+
+/*
+ * Hash a key into a bucket
+ * cache: the cache whose buckets are used
+ * key: the key to hash
+ * return: the bucket index
+ */
+static
+int HashKey(EquityCache *cache, const EquityKey *key)
+{
+    uint64_t hash = key->num_playing;
+
+    for (int i = 0; i < 4; i++)
+    {
+        hash = (hash ^ key->suits[i]) * 0x9e3779b97f4a7c15ull;
+    }
+
+    return (int)((hash >> 32) & (cache->num_buckets - 1));
+}
+
+/*
+ * Find a key's entry
+ * cache: the cache to search
+ * key: the key to find
+ * return: the index of the entry, or -1 if the key is not cached
+ */
+static
+int FindEntry(EquityCache *cache, const EquityKey *key)
+{
+    CacheEntry *entry;
+
+    for (int i = cache->buckets[HashKey(cache, key)]; i >= 0; i = entry->chain)
+    {
+        entry = &cache->entries[i];
+        if (entry->key.num_playing == key->num_playing
+                && !memcmp(entry->key.suits, key->suits, sizeof(key->suits)))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Take an entry out of the recency list
+ * cache: the cache holding the entry
+ * index: the entry to unlink
+ */
+static
+void UnlinkEntry(EquityCache *cache, int index)
+{
+    CacheEntry *entry = &cache->entries[index];
+
+    if (entry->newer >= 0)
+    {
+        cache->entries[entry->newer].older = entry->older;
+    }
+    else
+    {
+        cache->newest = entry->older;
+    }
+
+    if (entry->older >= 0)
+    {
+        cache->entries[entry->older].newer = entry->newer;
+    }
+    else
+    {
+        cache->oldest = entry->newer;
+    }
+}
+
+/*
+ * Put an entry at the newest end of the recency list
+ * cache: the cache holding the entry
+ * index: the entry to link
+ */
+static
+void LinkNewest(EquityCache *cache, int index)
+{
+    CacheEntry *entry = &cache->entries[index];
+
+    entry->newer = -1;
+    entry->older = cache->newest;
+
+    if (cache->newest >= 0)
+    {
+        cache->entries[cache->newest].newer = index;
+    }
+    else
+    {
+        cache->oldest = index;
+    }
+
+    cache->newest = index;
+}
+
+/*
+ * Take an entry out of its hash chain
+ * cache: the cache holding the entry
+ * index: the entry to remove
+ */
+static
+void RemoveFromChain(EquityCache *cache, int index)
+{
+    int *link = &cache->buckets[HashKey(cache, &cache->entries[index].key)];
+
+    while (*link != index)
+    {
+        link = &cache->entries[*link].chain;
+    }
+
+    *link = cache->entries[index].chain;
+}
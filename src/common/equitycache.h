@@ -0,0 +1,121 @@
+#ifndef __EQUITY_CACHE_H__
+#define __EQUITY_CACHE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cardmask.h"
+#include "gamestate.h"
+
+#define DEFAULT_CACHE_ENTRIES   65536
+
+//The first bytes of a cache file
+#define EQUITY_CACHE_MAGIC      "EQCACHE1"
+#define EQUITY_CACHE_MAGIC_LEN  8
+
+//A spot with the suits renamed away: each suit's hand and board ranks,
+//strongest first, so spots that only differ by suits share a key
+typedef struct equitykey
+{
+    uint32_t suits[4];
+    int num_playing;
+} EquityKey;
+
+//The games simulated for one spot, linked into the cache's
+//hash chains and its recency list by index (-1 == none)
+typedef struct cacheentry
+{
+    EquityKey key;
+    long long won;
+    long long simulated;
+
+    int chain;
+    int newer;
+    int older;
+} CacheEntry;
+
+//A bounded map of spots to their games, evicting the least recently used
+//Only one thread may use a cache at a time
+typedef struct equitycache
+{
+    CacheEntry *entries;
+    int capacity;
+    int count;
+
+    //Hash buckets holding the index of the first entry of their chain
+    int *buckets;
+    int num_buckets;
+
+    //Ends of the recency list
+    int newest;
+    int oldest;
+
+    //Lookups that found their spot, and lookups that did not
+    long long hits;
+    long long misses;
+} EquityCache;
+
+/*
+ * Get the key of a spot, the same for every relabeling of its suits
+ * hand: the AI's two hole cards
+ * community: the known community cards, in any order
+ * communitysize: the number of community cards
+ * num_playing: the number of opponents
+ * return: the spot's key
+ */
+EquityKey MakeEquityKey(const int *hand, const int *community, int communitysize, int num_playing);
+
+/*
+ * Create an empty cache
+ * capacity: the most spots it holds, at least one
+ * return: the new cache
+ */
+EquityCache *CreateEquityCache(int capacity);
+
+/*
+ * Free a cache and all of its entries
+ * cache: the cache to destroy
+ */
+void DestroyEquityCache(EquityCache *cache);
+
+/*
+ * Look up the games simulated for a spot, marking it as recently used
+ * cache: the cache to look in
+ * key: the spot's key
+ * won: where to store the games won
+ * simulated: where to store the games simulated
+ * return: true if the spot is in the cache
+ */
+bool LookupEquity(EquityCache *cache, const EquityKey *key, long long *won, long long *simulated);
+
+/*
+ * Record the games simulated for a spot, replacing what was there
+ * The least recently used spot makes room if the cache is full
+ * cache: the cache to store in
+ * key: the spot's key
+ * won: the games won
+ * simulated: the games simulated
+ */
+void StoreEquity(EquityCache *cache, const EquityKey *key, long long won, long long simulated);
+
+/*
+ * Add the spots of a file written by SaveEquityCache to a cache
+ * A spot already in the cache keeps whichever result has more games
+ * cache: the cache to fill
+ * path: the file to read
+ * return: false if the file could not be read or is not a cache file
+ */
+bool LoadEquityCache(EquityCache *cache, const char *path);
+
+/*
+ * Write every spot of a cache to a file, oldest first
+ * cache: the cache to write
+ * path: the file to write
+ * return: false if the file could not be written
+ */
+bool SaveEquityCache(EquityCache *cache, const char *path);
+
+#endif
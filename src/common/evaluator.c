@@ -1,13 +1,117 @@
 #include "evaluator.h"
 
+#define HANDRANKS_BYTES (sizeof(*HR) * HANDRANKS_SIZE)
+#define MAX_RANK_COMBINATIONS 50388 //(19 choose 12) ways to spread 7 cards over 13 ranks
+
+int *HR = NULL;
+__thread int *LOCAL_HR = NULL;
 bool POKERLIB_INITIALIZED = false;
+HandRanksFormat HANDRANKS_FORMAT = FORMAT_TWO_PLUS_TWO;
+CompactRanks COMPACT_RANKS;
+
+//Found by a greedy search: each key is the smallest that keeps the sums
+//of every hand of 5, 6 or 7 cards (with at most 4 of a rank) unique
+const uint32_t RANK_KEYS[NUM_CARD_RANKS] =
+{
+    0, 1, 5, 22, 98, 453, 2031, 8698, 22854, 83661, 262349, 636345, 1479181
+};
+
+//Every copy of the 2+2 table, indexed by NUMA node when replicated
+static int *HR_REPLICAS[MAX_NUMA_NODES];
+static int NUM_HR_REPLICAS = 0;
+
+/*
+ * Map the lookup table file directly into memory
+ * The mapping is read-only, so every process using the same
+ * file shares a single copy through the page cache
+ * fd: an open descriptor for the hand ranks file
+ * flags: a combination of LoadFlags
+ * return: true if the table was mapped
+ */
+static
+bool MapHandRanks(int fd, int flags);
+
+/*
+ * Read the lookup table file into private anonymous memory
+ * fd: an open descriptor for the hand ranks file
+ * flags: a combination of LoadFlags
+ */
+static
+void ReadHandRanks(int fd, int flags);
+
+/*
+ * Allocate private anonymous memory for a copy of the table
+ * flags: a combination of LoadFlags
+ * node: the NUMA node to place the copy on, or -1 for no preference
+ * return: the memory, or NULL if it could not be allocated
+ */
+static
+int *AllocateHandRanks(int flags, int node);
+
+/*
+ * Copy the loaded table onto every other NUMA node
+ * If a copy cannot be allocated, the nodes left over share the copies made
+ * flags: a combination of LoadFlags
+ */
+static
+void ReplicateHandRanks(int flags);
+
+/*
+ * Build the perfect hash of one unsuited table
+ * Rows are placed fullest first, each at the lowest offset
+ * where none of its keys land on a slot already taken
+ * ranks: the compact tables to fill in
+ * numcards: the number of cards in every hand
+ * keys: the rank key of every hand
+ * values: the rank of every hand
+ * count: the number of hands
+ * return: true if the tables could be allocated
+ */
+static
+bool BuildCompactHash(CompactRanks *ranks, int numcards, uint32_t *keys, uint16_t *values, int count);
+
+/*
+ * Read a compact table written by WriteCompactRanks
+ * fd: an open descriptor for the compact file, past the magic
+ * return: true if the whole table was read
+ */
+static
+bool ReadCompactRanks(int fd);
+
+/*
+ * Read exactly the given number of bytes
+ * fd: the descriptor to read from
+ * buffer: where to store the bytes
+ * bytes: the number of bytes to read
+ * return: true if every byte was read
+ */
+static
+bool ReadFully(int fd, void *buffer, size_t bytes);
+
+/*
+ * Free every table of a compact format
+ * ranks: the tables to free
+ */
+static
+void FreeCompactRanks(CompactRanks *ranks);
 
 /*
- * Initialize the 2+2 evaluator by loading the lookup table
+ * Initialize the 2+2 evaluator by mapping the lookup table
  * into the HR array.
  * handranksfile: the hand ranks look up table data
  */
 void InitEvaluator(char *handranksfile)
+{
+    InitEvaluatorWithFlags(handranksfile, LOAD_MMAP);
+}
+
+/*
+ * Initialize the 2+2 evaluator with the given load flags
+ * If the file cannot be mapped, the table is read into memory instead
+ * handranksfile: the hand ranks look up table data
+ * flags: a combination of LoadFlags
+ */
+void InitEvaluatorWithFlags(char *handranksfile, int flags)
 {
     //Make sure not to load the array twice
     if (POKERLIB_INITIALIZED) return;
@@ -15,22 +119,210 @@ void InitEvaluator(char *handranksfile)
     //Seed the random number generator at this point, too
     srand(time(NULL));
 
-    memset(HR, 0, sizeof(HR));
-    FILE *in = fopen(handranksfile, "rb");
+    int fd = open(handranksfile, O_RDONLY);
+    char magic[sizeof(COMPACT_MAGIC) - 1];
 
     //Bad file name given... abort
-    if (!in)
+    if (fd < 0)
     {
         fprintf(stderr, "\n%sFATAL: Could not load hand ranks file.%s\n", COLOR_ERROR, COLOR_DEFAULT);
         exit(1);
     }
 
-    fread(HR, sizeof(HR), 1, in);
-    fclose(in);
+    //A 2+2 table starts with the zeroed slots below the root node
+    if (read(fd, magic, sizeof(magic)) == sizeof(magic)
+            && !memcmp(magic, COMPACT_MAGIC, sizeof(magic)))
+    {
+        if (!ReadCompactRanks(fd))
+        {
+            fprintf(stderr, "\n%sFATAL: Could not load compact hand ranks file.%s\n", COLOR_ERROR, COLOR_DEFAULT);
+            exit(1);
+        }
+
+        close(fd);
+        HANDRANKS_FORMAT = FORMAT_COMPACT;
+        POKERLIB_INITIALIZED = true;
+        return;
+    }
+    lseek(fd, 0, SEEK_SET);
+
+    //The page cache cannot be placed per node, so those need private copies
+    if (flags & (LOAD_INTERLEAVE | LOAD_REPLICATE))
+    {
+        flags &= ~LOAD_MMAP;
+    }
+
+    if (!(flags & LOAD_MMAP) || !MapHandRanks(fd, flags))
+    {
+        ReadHandRanks(fd, flags);
+    }
+    close(fd);
+
+    HR_REPLICAS[0] = HR;
+    NUM_HR_REPLICAS = 1;
+    if (flags & LOAD_REPLICATE)
+    {
+        ReplicateHandRanks(flags);
+    }
 
     POKERLIB_INITIALIZED = true;
 }
 
+/*
+ * Release the lookup table so that the evaluator can be initialized again
+ */
+void DestroyEvaluator(void)
+{
+    if (!POKERLIB_INITIALIZED) return;
+
+    if (HANDRANKS_FORMAT == FORMAT_COMPACT)
+    {
+        FreeCompactRanks(&COMPACT_RANKS);
+        HANDRANKS_FORMAT = FORMAT_TWO_PLUS_TWO;
+    }
+    else
+    {
+        for (int i = 0; i < NUM_HR_REPLICAS; i++)
+        {
+            munmap(HR_REPLICAS[i], HANDRANKS_BYTES);
+        }
+        NUM_HR_REPLICAS = 0;
+        HR = NULL;
+        LOCAL_HR = NULL;
+    }
+
+    POKERLIB_INITIALIZED = false;
+}
+
+/*
+ * Point the calling thread's LOCAL_HR at the copy of the table on its NUMA node
+ * Without LOAD_REPLICATE there is only one copy and the thread keeps using HR
+ * Threads that move between nodes keep the copy they were given
+ */
+void UseLocalHandRanks(void)
+{
+    if (NUM_HR_REPLICAS > 1)
+    {
+        LOCAL_HR = HR_REPLICAS[GetCurrentNode() % NUM_HR_REPLICAS];
+    }
+    else
+    {
+        LOCAL_HR = NULL;
+    }
+}
+
+/*
+ * Convert the loaded 2+2 table into the compact format
+ * Each compact entry is filled in by evaluating a hand through HR
+ * filename: where to write the compact table
+ * return: true if the file was written
+ */
+bool WriteCompactRanks(char *filename)
+{
+    CompactRanks ranks;
+    uint32_t *keys = malloc(sizeof(*keys) * MAX_RANK_COMBINATIONS);
+    uint16_t *values = malloc(sizeof(*values) * MAX_RANK_COMBINATIONS);
+    uint8_t rankcount[NUM_CARD_RANKS];
+    uint32_t version = COMPACT_VERSION;
+    int cards[COMPACT_MAX_CARDS];
+    int numcards;
+    int count;
+    int rank;
+    int left;
+    bool written;
+    FILE *file;
+
+    memset(&ranks, 0, sizeof(ranks));
+    ranks.flush = calloc(FLUSH_TABLE_SIZE, sizeof(*ranks.flush));
+    written = POKERLIB_INITIALIZED && HANDRANKS_FORMAT == FORMAT_TWO_PLUS_TWO
+        && keys && values && ranks.flush;
+
+    //Every flush uses a single suit, spades
+    for (int mask = 0; mask < FLUSH_TABLE_SIZE && written; mask++)
+    {
+        numcards = __builtin_popcount(mask);
+        if (numcards < COMPACT_MIN_CARDS || numcards > COMPACT_MAX_CARDS) continue;
+
+        numcards = 0;
+        for (rank = 0; rank < NUM_CARD_RANKS; rank++)
+        {
+            if (mask & (1 << rank))
+            {
+                cards[numcards++] = rank * NUM_CARD_SUITS + 1;
+            }
+        }
+
+        ranks.flush[mask] = GetHandValue(cards, numcards);
+    }
+
+    for (numcards = COMPACT_MIN_CARDS; numcards <= COMPACT_MAX_CARDS && written; numcards++)
+    {
+        //Count through every combination of rank counts like an odometer
+        count = 0;
+        memset(rankcount, 0, sizeof(rankcount));
+        rankcount[0] = numcards;
+        while (true)
+        {
+            //Deal the cards out over the suits in turn so no flush can form
+            keys[count] = 0;
+            left = 0;
+            for (rank = 0; rank < NUM_CARD_RANKS && rankcount[rank] <= NUM_CARD_SUITS; rank++)
+            {
+                for (int c = 0; c < rankcount[rank]; c++, left++)
+                {
+                    cards[left] = rank * NUM_CARD_SUITS + left % NUM_CARD_SUITS + 1;
+                    keys[count] += RANK_KEYS[rank];
+                }
+            }
+
+            //Skip combinations holding more cards of a rank than there are suits
+            if (rank == NUM_CARD_RANKS)
+            {
+                values[count++] = GetHandValue(cards, numcards);
+            }
+
+            //Move one card from the lowest nonempty rank up a rank,
+            //gathering everything below it back into the lowest rank
+            for (rank = 0; rank < NUM_CARD_RANKS - 1 && !rankcount[rank]; rank++);
+            if (rank == NUM_CARD_RANKS - 1) break;
+
+            left = rankcount[rank] - 1;
+            rankcount[rank] = 0;
+            rankcount[rank + 1]++;
+            rankcount[0] = left;
+        }
+
+        written = BuildCompactHash(&ranks, numcards, keys, values, count);
+    }
+
+    free(keys);
+    free(values);
+
+    file = written ? fopen(filename, "wb") : NULL;
+    written = file
+        && fwrite(COMPACT_MAGIC, 1, sizeof(COMPACT_MAGIC) - 1, file) == sizeof(COMPACT_MAGIC) - 1
+        && fwrite(&version, sizeof(version), 1, file) == 1
+        && fwrite(ranks.flush, sizeof(*ranks.flush), FLUSH_TABLE_SIZE, file) == FLUSH_TABLE_SIZE;
+
+    for (numcards = COMPACT_MIN_CARDS; numcards <= COMPACT_MAX_CARDS && written; numcards++)
+    {
+        written = fwrite(&ranks.num_rows[numcards], sizeof(uint32_t), 1, file) == 1
+            && fwrite(&ranks.num_slots[numcards], sizeof(uint32_t), 1, file) == 1
+            && fwrite(ranks.rowoffset[numcards], sizeof(uint32_t), ranks.num_rows[numcards], file)
+                == ranks.num_rows[numcards]
+            && fwrite(ranks.unsuited[numcards], sizeof(uint16_t), ranks.num_slots[numcards], file)
+                == ranks.num_slots[numcards];
+    }
+
+    if (file)
+    {
+        written = !fclose(file) && written;
+    }
+
+    FreeCompactRanks(&ranks);
+    return written;
+}
+
 /*
  * Evaluate a hand of 5, 6, or 7 cards
  * cards: an array of 5, 6, or 7 cards
@@ -40,11 +332,372 @@ void InitEvaluator(char *handranksfile)
  */
 int GetHandValue(int *cards, int num_cards)
 {
-    int p = HR[53 + cards[0]];
-    for (int i = 1; i < num_cards; i++)
+    BoardState hand;
+
+    if (HANDRANKS_FORMAT == FORMAT_COMPACT)
     {
-        p = HR[p + cards[i]];
+        StartBoard(&hand);
+        AddBoardCards(&hand, cards, num_cards);
+        return GetCompactHandValue(&hand);
+    }
+
+    int p = AdvanceHandNode(HANDRANKS_ROOT, cards, num_cards);
+
+    //Walks of 5 or 6 cards stop on a node, whose first slot holds the rank
+    if (num_cards < 7)
+    {
+        p = HandRanks()[p];
     }
 
     return p;
 }
+
+/*
+ * Map the lookup table file directly into memory
+ * The mapping is read-only, so every process using the same
+ * file shares a single copy through the page cache
+ * fd: an open descriptor for the hand ranks file
+ * flags: a combination of LoadFlags
+ * return: true if the table was mapped
+ */
+static
+bool MapHandRanks(int fd, int flags)
+{
+    struct stat info;
+    int mapflags = MAP_SHARED;
+    void *table;
+
+    //Touching a mapping past the end of a short file raises SIGBUS
+    if (fstat(fd, &info) || info.st_size < (off_t)HANDRANKS_BYTES)
+    {
+        return false;
+    }
+
+#ifdef MAP_POPULATE
+    if (flags & LOAD_POPULATE)
+    {
+        mapflags |= MAP_POPULATE;
+    }
+#endif
+
+    table = mmap(NULL, HANDRANKS_BYTES, PROT_READ, mapflags, fd, 0);
+    if (table == MAP_FAILED)
+    {
+        return false;
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (flags & LOAD_HUGEPAGES)
+    {
+        madvise(table, HANDRANKS_BYTES, MADV_HUGEPAGE);
+    }
+#endif
+
+    HR = table;
+    return true;
+}
+
+/*
+ * Read the lookup table file into private anonymous memory
+ * fd: an open descriptor for the hand ranks file
+ * flags: a combination of LoadFlags
+ */
+static
+void ReadHandRanks(int fd, int flags)
+{
+    size_t total = 0;
+    ssize_t count;
+
+    //Anonymous memory starts zeroed, so a short file leaves the rest empty
+    int *table = AllocateHandRanks(flags, flags & LOAD_REPLICATE ? 0 : -1);
+    if (!table)
+    {
+        fprintf(stderr, "\n%sFATAL: Could not allocate hand ranks table.%s\n", COLOR_ERROR, COLOR_DEFAULT);
+        exit(1);
+    }
+
+    while (total < HANDRANKS_BYTES)
+    {
+        count = read(fd, (char *)table + total, HANDRANKS_BYTES - total);
+        if (count <= 0) break;
+        total += count;
+    }
+
+    HR = table;
+}
+
+/*
+ * Allocate private anonymous memory for a copy of the table
+ * flags: a combination of LoadFlags
+ * node: the NUMA node to place the copy on, or -1 for no preference
+ * return: the memory, or NULL if it could not be allocated
+ */
+static
+int *AllocateHandRanks(int flags, int node)
+{
+    void *table = mmap(NULL, HANDRANKS_BYTES, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (table == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (flags & LOAD_HUGEPAGES)
+    {
+        madvise(table, HANDRANKS_BYTES, MADV_HUGEPAGE);
+    }
+#endif
+
+    //The policy has to be in place before the pages are first touched
+    if (node >= 0)
+    {
+        BindMemoryToNode(table, HANDRANKS_BYTES, node);
+    }
+    else if (flags & LOAD_INTERLEAVE)
+    {
+        InterleaveMemory(table, HANDRANKS_BYTES);
+    }
+
+    return table;
+}
+
+/*
+ * Copy the loaded table onto every other NUMA node
+ * If a copy cannot be allocated, the nodes left over share the copies made
+ * flags: a combination of LoadFlags
+ */
+static
+void ReplicateHandRanks(int flags)
+{
+    int num_nodes = GetNumNodes();
+    int *table;
+
+    for (int node = 1; node < num_nodes; node++)
+    {
+        table = AllocateHandRanks(flags, node);
+        if (!table) break;
+
+        memcpy(table, HR_REPLICAS[0], HANDRANKS_BYTES);
+        HR_REPLICAS[NUM_HR_REPLICAS++] = table;
+    }
+}
+
+/*
+ * Build the perfect hash of one unsuited table
+ * Rows are placed fullest first, each at the lowest offset
+ * where none of its keys land on a slot already taken
+ * ranks: the compact tables to fill in
+ * numcards: the number of cards in every hand
+ * keys: the rank key of every hand
+ * values: the rank of every hand
+ * count: the number of hands
+ * return: true if the tables could be allocated
+ */
+static
+bool BuildCompactHash(CompactRanks *ranks, int numcards, uint32_t *keys, uint16_t *values, int count)
+{
+    uint32_t maxkey = 0;
+    uint32_t num_rows;
+    uint32_t *rowcount;
+    uint32_t *rowstart;
+    uint32_t *byrow;
+    uint32_t *rowoffset;
+    uint32_t offset;
+    uint32_t row;
+    bool *taken;
+    bool fits;
+
+    for (int i = 0; i < count; i++)
+    {
+        maxkey = keys[i] > maxkey ? keys[i] : maxkey;
+    }
+    num_rows = (maxkey >> COMPACT_ROW_SHIFT) + 1;
+
+    //Worst case every row keeps its own place, so maxkey slots always suffice
+    rowcount = calloc(num_rows + 1, sizeof(*rowcount));
+    rowstart = calloc(num_rows + 1, sizeof(*rowstart));
+    byrow = malloc(sizeof(*byrow) * count);
+    rowoffset = calloc(num_rows, sizeof(*rowoffset));
+    taken = calloc(maxkey + 1, sizeof(*taken));
+    if (!rowcount || !rowstart || !byrow || !rowoffset || !taken)
+    {
+        free(rowcount);
+        free(rowstart);
+        free(byrow);
+        free(rowoffset);
+        free(taken);
+        return false;
+    }
+
+    //Group the hands by row
+    for (int i = 0; i < count; i++)
+    {
+        rowcount[keys[i] >> COMPACT_ROW_SHIFT]++;
+    }
+    for (row = 0; row < num_rows; row++)
+    {
+        rowstart[row + 1] = rowstart[row] + rowcount[row];
+    }
+    memset(rowcount, 0, sizeof(*rowcount) * num_rows);
+    for (int i = 0; i < count; i++)
+    {
+        row = keys[i] >> COMPACT_ROW_SHIFT;
+        byrow[rowstart[row] + rowcount[row]++] = i;
+    }
+
+    ranks->num_slots[numcards] = 0;
+    for (uint32_t size = COMPACT_ROW_MASK + 1; size > 0; size--)
+    {
+        for (row = 0; row < num_rows; row++)
+        {
+            if (rowcount[row] != size) continue;
+
+            //Offsets never wrap below zero, so every column of a row is a valid slot
+            for (offset = 0, fits = false; !fits; offset++)
+            {
+                fits = true;
+                for (uint32_t i = rowstart[row]; i < rowstart[row + 1] && fits; i++)
+                {
+                    fits = !taken[offset + (keys[byrow[i]] & COMPACT_ROW_MASK)];
+                }
+            }
+            rowoffset[row] = --offset;
+
+            for (uint32_t i = rowstart[row]; i < rowstart[row + 1]; i++)
+            {
+                taken[offset + (keys[byrow[i]] & COMPACT_ROW_MASK)] = true;
+                if (offset + (keys[byrow[i]] & COMPACT_ROW_MASK) >= ranks->num_slots[numcards])
+                {
+                    ranks->num_slots[numcards] = offset + (keys[byrow[i]] & COMPACT_ROW_MASK) + 1;
+                }
+            }
+        }
+    }
+
+    //Cover the whole span of columns of every row, so the loader can check
+    //that no key a row can be looked up with falls outside the table
+    for (row = 0; row < num_rows; row++)
+    {
+        if (rowoffset[row] + COMPACT_ROW_MASK >= ranks->num_slots[numcards])
+        {
+            ranks->num_slots[numcards] = rowoffset[row] + COMPACT_ROW_MASK + 1;
+        }
+    }
+
+    ranks->num_rows[numcards] = num_rows;
+    ranks->rowoffset[numcards] = rowoffset;
+    ranks->unsuited[numcards] = calloc(ranks->num_slots[numcards], sizeof(uint16_t));
+    if (ranks->unsuited[numcards])
+    {
+        for (int i = 0; i < count; i++)
+        {
+            ranks->unsuited[numcards][rowoffset[keys[i] >> COMPACT_ROW_SHIFT]
+                + (keys[i] & COMPACT_ROW_MASK)] = values[i];
+        }
+    }
+
+    free(rowcount);
+    free(rowstart);
+    free(byrow);
+    free(taken);
+    return ranks->unsuited[numcards] != NULL;
+}
+
+/*
+ * Read a compact table written by WriteCompactRanks
+ * fd: an open descriptor for the compact file, past the magic
+ * return: true if the whole table was read
+ */
+static
+bool ReadCompactRanks(int fd)
+{
+    uint32_t version;
+    uint32_t max_rows = ((COMPACT_MAX_CARDS * RANK_KEYS[NUM_CARD_RANKS - 1]) >> COMPACT_ROW_SHIFT) + 1;
+    uint32_t maxkey;
+    bool loaded;
+
+    memset(&COMPACT_RANKS, 0, sizeof(COMPACT_RANKS));
+    COMPACT_RANKS.flush = malloc(sizeof(*COMPACT_RANKS.flush) * FLUSH_TABLE_SIZE);
+    loaded = COMPACT_RANKS.flush
+        && ReadFully(fd, &version, sizeof(version)) && version == COMPACT_VERSION
+        && ReadFully(fd, COMPACT_RANKS.flush, sizeof(*COMPACT_RANKS.flush) * FLUSH_TABLE_SIZE);
+
+    for (int numcards = COMPACT_MIN_CARDS; numcards <= COMPACT_MAX_CARDS && loaded; numcards++)
+    {
+        loaded = ReadFully(fd, &COMPACT_RANKS.num_rows[numcards], sizeof(uint32_t))
+            && ReadFully(fd, &COMPACT_RANKS.num_slots[numcards], sizeof(uint32_t))
+            && COMPACT_RANKS.num_rows[numcards] <= max_rows;
+        if (!loaded) break;
+
+        COMPACT_RANKS.rowoffset[numcards] = malloc(sizeof(uint32_t) * COMPACT_RANKS.num_rows[numcards]);
+        COMPACT_RANKS.unsuited[numcards] = malloc(sizeof(uint16_t) * COMPACT_RANKS.num_slots[numcards]);
+        loaded = COMPACT_RANKS.rowoffset[numcards] && COMPACT_RANKS.unsuited[numcards]
+            && ReadFully(fd, COMPACT_RANKS.rowoffset[numcards],
+                    sizeof(uint32_t) * COMPACT_RANKS.num_rows[numcards])
+            && ReadFully(fd, COMPACT_RANKS.unsuited[numcards],
+                    sizeof(uint16_t) * COMPACT_RANKS.num_slots[numcards]);
+
+        //Four aces and then kings make the highest key a hand can look up
+        maxkey = 0;
+        for (int i = 0; i < numcards; i++)
+        {
+            maxkey += RANK_KEYS[NUM_CARD_RANKS - 1 - i / 4];
+        }
+        loaded = loaded && COMPACT_RANKS.num_rows[numcards] > (maxkey >> COMPACT_ROW_SHIFT);
+
+        //A corrupt offset would send CompactSlot outside the table
+        for (uint32_t row = 0; row < COMPACT_RANKS.num_rows[numcards] && loaded; row++)
+        {
+            loaded = (uint64_t)COMPACT_RANKS.rowoffset[numcards][row] + COMPACT_ROW_MASK
+                < COMPACT_RANKS.num_slots[numcards];
+        }
+    }
+
+    if (!loaded)
+    {
+        FreeCompactRanks(&COMPACT_RANKS);
+    }
+
+    return loaded;
+}
+
+/*
+ * Read exactly the given number of bytes
+ * fd: the descriptor to read from
+ * buffer: where to store the bytes
+ * bytes: the number of bytes to read
+ * return: true if every byte was read
+ */
+static
+bool ReadFully(int fd, void *buffer, size_t bytes)
+{
+    size_t total = 0;
+    ssize_t count;
+
+    while (total < bytes)
+    {
+        count = read(fd, (char *)buffer + total, bytes - total);
+        if (count <= 0) return false;
+        total += count;
+    }
+
+    return true;
+}
+
+/*
+ * Free every table of a compact format
+ * ranks: the tables to free
+ */
+static
+void FreeCompactRanks(CompactRanks *ranks)
+{
+    free(ranks->flush);
+    for (int numcards = COMPACT_MIN_CARDS; numcards <= COMPACT_MAX_CARDS; numcards++)
+    {
+        free(ranks->rowoffset[numcards]);
+        free(ranks->unsuited[numcards]);
+    }
+
+    memset(ranks, 0, sizeof(*ranks));
+}
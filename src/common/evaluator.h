@@ -2,28 +2,139 @@
 #define __EVALUATOR_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "topology.h"
 
 #define DEFAULT_HANDRANKS_FILE  "HANDRANKS.DAT"
+#define HANDRANKS_SIZE          32487834
+#define HANDRANKS_ROOT          53 //node of the empty hand
+#define DEFAULT_COMPACT_FILE    "HANDRANKS16.DAT"
+#define COMPACT_MAGIC           "HR16"
+#define COMPACT_VERSION         2
+#define NUM_CARD_RANKS          13
+#define NUM_CARD_SUITS          4
+#define FLUSH_TABLE_SIZE        (1 << NUM_CARD_RANKS)
+#define COMPACT_MIN_CARDS       5
+#define COMPACT_MAX_CARDS       7
+#define COMPACT_ROW_SHIFT       10
+#define COMPACT_ROW_MASK        ((1 << COMPACT_ROW_SHIFT) - 1)
+#define SUIT_COUNT_ONES         0x01010101u
 #define COLOR_ERROR "\033[1;31m"
 #define COLOR_DEFAULT "\033[0m"
 
-//Massive lookup table
-int HR[32487834];
+//Ways the lookup table can be brought into memory
+//Flags may be combined with a bitwise or
+typedef enum loadflags
+{
+    LOAD_READ       = 0,        //fread into a private copy of the table
+    LOAD_MMAP       = 1 << 0,   //read-only mapping shared through the page cache
+    LOAD_POPULATE   = 1 << 1,   //prefault the whole table while loading
+    LOAD_HUGEPAGES  = 1 << 2,   //ask the kernel to back the table with huge pages
+    LOAD_INTERLEAVE = 1 << 3,   //read a private copy spread page by page over every NUMA node
+    LOAD_REPLICATE  = 1 << 4    //read a private copy on every NUMA node, see UseLocalHandRanks
+} LoadFlags;
+
+//Lookup table layouts InitEvaluator understands
+typedef enum handranksformat
+{
+    FORMAT_TWO_PLUS_TWO,    //the 130MB 2+2 state machine in HR
+    FORMAT_COMPACT          //16-bit ranks indexed by rank counts or flush suit ranks
+} HandRanksFormat;
+
+//Tables of the compact format, about 400KB in total
+//Every entry holds the same rank the 2+2 table gives for that hand
+typedef struct compactranks
+{
+    //Best hand made from the ranks of a 13-bit flush suit mask
+    uint16_t *flush;
+
+    //Hands without a flush by number of cards, found by a perfect hash
+    //of the sum of their RANK_KEYS: each row of COMPACT_ROW_MASK + 1 keys
+    //is displaced into the table so that no two hands share a slot
+    uint16_t *unsuited[COMPACT_MAX_CARDS + 1];
+    uint32_t *rowoffset[COMPACT_MAX_CARDS + 1];
+    uint32_t num_slots[COMPACT_MAX_CARDS + 1];
+    uint32_t num_rows[COMPACT_MAX_CARDS + 1];
+} CompactRanks;
+
+//Cards shared by every player's hand, such as the community cards,
+//tracked in whichever form the loaded table format needs
+typedef struct boardstate
+{
+    //2+2 table node
+    int node;
+    int numcards;
+
+    //Compact format: sum of RANK_KEYS, one byte of card count per suit,
+    //and the ranks held in each suit
+    uint32_t rankkey;
+    uint32_t suitcount;
+    uint16_t suitranks[NUM_CARD_SUITS];
+} BoardState;
+
+//Massive lookup table, shared by every thread
+extern int *HR;
+
+//The copy of HR on the calling thread's NUMA node, set by UseLocalHandRanks
+//NULL on threads that have not asked for one, which use the shared HR
+extern __thread int *LOCAL_HR;
+
+//Which table was loaded, and the compact tables if they were
+extern HandRanksFormat HANDRANKS_FORMAT;
+extern CompactRanks COMPACT_RANKS;
+
+//Per rank keys whose sums are unique for every hand of up to 7 cards
+extern const uint32_t RANK_KEYS[NUM_CARD_RANKS];
 
 //We only want to initialize the lookup table once
 extern bool POKERLIB_INITIALIZED;
 
 /*
- * Initialize the 2+2 evaluator by loading the lookup table
+ * Initialize the 2+2 evaluator by mapping the lookup table
  * into the HR array.
  * handranksfile: the hand ranks look up table data
  */
 void InitEvaluator(char *handranksfile);
 
+/*
+ * Initialize the 2+2 evaluator with the given load flags
+ * If the file cannot be mapped, the table is read into memory instead
+ * A file written by WriteCompactRanks is recognized by its header
+ * and loads the compact format instead (the flags are ignored)
+ * handranksfile: the hand ranks look up table data
+ * flags: a combination of LoadFlags
+ */
+void InitEvaluatorWithFlags(char *handranksfile, int flags);
+
+/*
+ * Point the calling thread's LOCAL_HR at the copy of the table on its NUMA node
+ * Without LOAD_REPLICATE there is only one copy and the thread keeps using HR
+ * Threads that move between nodes keep the copy they were given
+ */
+void UseLocalHandRanks(void);
+
+/*
+ * Convert the loaded 2+2 table into the compact format
+ * Each compact entry is filled in by evaluating a hand through HR
+ * filename: where to write the compact table
+ * return: true if the file was written
+ */
+bool WriteCompactRanks(char *filename);
+
+/*
+ * Release the lookup table so that the evaluator can be initialized again
+ */
+void DestroyEvaluator(void);
+
 /*
  * Evaluate a hand of 5, 6, or 7 cards
  * cards: an array of 5, 6, or 7 cards
@@ -33,4 +144,192 @@ void InitEvaluator(char *handranksfile);
  */
 int GetHandValue(int *cards, int num_cards);
 
+/*
+ * Get the copy of the lookup table the calling thread should read
+ * return: the thread's local copy if it has one, otherwise the shared HR
+ */
+static inline
+const int *HandRanks(void)
+{
+    return LOCAL_HR ? LOCAL_HR : HR;
+}
+
+/*
+ * Walk the lookup table from the given node through more cards
+ * Cards may be added in any order, so a node reached from the
+ * community cards can be shared by every player's hand
+ * node: the node to start from (HANDRANKS_ROOT for an empty hand)
+ * cards: the cards to add
+ * num_cards: the number of cards to add
+ * return: the node reached, or the hand's rank once 7 cards are in
+ */
+static inline
+int AdvanceHandNode(int node, int *cards, int num_cards)
+{
+    const int *table = HandRanks();
+
+    for (int i = 0; i < num_cards; i++)
+    {
+        node = table[node + cards[i]];
+    }
+
+    return node;
+}
+
+/*
+ * Finish a 7-card hand from a node holding 5 community cards
+ * board: the node reached after the 5 community cards
+ * hand: the player's 2 hole cards
+ * return: the rank of the player's best hand
+ */
+static inline
+int GetHandValueFromBoard(int board, int *hand)
+{
+    const int *table = HandRanks();
+
+    return table[table[board + hand[0]] + hand[1]];
+}
+
+/*
+ * Find the slot of a hand without a flush in its unsuited table
+ * rankkey: the sum of the RANK_KEYS of the hand's cards
+ * numcards: the number of cards in the hand
+ * return: the index into COMPACT_RANKS.unsuited[numcards]
+ */
+static inline
+uint32_t CompactSlot(uint32_t rankkey, int numcards)
+{
+    return COMPACT_RANKS.rowoffset[numcards][rankkey >> COMPACT_ROW_SHIFT] + (rankkey & COMPACT_ROW_MASK);
+}
+
+/*
+ * Look up a complete hand of 5 to 7 cards in the compact tables
+ * hand: the hand's rank key and suits
+ * return: an int representing the relative rank of the hand
+ */
+static inline
+int GetCompactHandValue(const BoardState *hand)
+{
+    //A suit count of 5 or more carries into the top bit of its byte
+    //At most 7 cards, so only one suit can hold a flush
+    uint32_t flushes = (hand->suitcount + 3 * SUIT_COUNT_ONES) & (8 * SUIT_COUNT_ONES);
+
+    if (flushes)
+    {
+        return COMPACT_RANKS.flush[hand->suitranks[__builtin_ctz(flushes) >> 3]];
+    }
+
+    return COMPACT_RANKS.unsuited[hand->numcards][CompactSlot(hand->rankkey, hand->numcards)];
+}
+
+/*
+ * Start an empty board
+ * board: the board to clear
+ */
+static inline
+void StartBoard(BoardState *board)
+{
+    memset(board, 0, sizeof(*board));
+    board->node = HANDRANKS_ROOT;
+}
+
+/*
+ * Add cards to a board in the form the loaded table needs
+ * board: the board to add to
+ * cards: the cards to add
+ * num_cards: the number of cards to add
+ */
+static inline
+void AddBoardCards(BoardState *board, int *cards, int num_cards)
+{
+    if (HANDRANKS_FORMAT == FORMAT_TWO_PLUS_TWO)
+    {
+        board->node = AdvanceHandNode(board->node, cards, num_cards);
+    }
+    else
+    {
+        //Cards are 1 indexed, four suits per rank
+        for (int i = 0; i < num_cards; i++)
+        {
+            int rank = (cards[i] - 1) >> 2;
+            int suit = (cards[i] - 1) & 3;
+
+            board->rankkey += RANK_KEYS[rank];
+            board->suitcount += 1u << (suit * 8);
+            board->suitranks[suit] |= 1 << rank;
+        }
+    }
+
+    board->numcards += num_cards;
+}
+
+/*
+ * Finish a 7-card hand from a board holding all 5 community cards
+ * Works with either table format
+ * board: the board holding the 5 community cards
+ * hand: the player's 2 hole cards
+ * return: the rank of the player's best hand
+ */
+static inline
+int GetHandValueOnBoard(const BoardState *board, int *hand)
+{
+    int rank[2];
+    int suit[2];
+    uint32_t rankkey;
+    uint32_t flushes;
+    uint16_t suitranks;
+
+    if (HANDRANKS_FORMAT == FORMAT_TWO_PLUS_TWO)
+    {
+        return GetHandValueFromBoard(board->node, hand);
+    }
+
+    //Same as adding the hole cards to a copy of the board, without the copy
+    for (int i = 0; i < 2; i++)
+    {
+        rank[i] = (hand[i] - 1) >> 2;
+        suit[i] = (hand[i] - 1) & 3;
+    }
+
+    rankkey = board->rankkey + RANK_KEYS[rank[0]] + RANK_KEYS[rank[1]];
+    flushes = (board->suitcount + (1u << (suit[0] * 8)) + (1u << (suit[1] * 8))
+            + 3 * SUIT_COUNT_ONES) & (8 * SUIT_COUNT_ONES);
+
+    if (flushes)
+    {
+        flushes = __builtin_ctz(flushes) >> 3;
+        suitranks = board->suitranks[flushes]
+            | ((suit[0] == (int)flushes) << rank[0])
+            | ((suit[1] == (int)flushes) << rank[1]);
+        return COMPACT_RANKS.flush[suitranks];
+    }
+
+    return COMPACT_RANKS.unsuited[COMPACT_MAX_CARDS][CompactSlot(rankkey, COMPACT_MAX_CARDS)];
+}
+
+/*
+ * Find the best 7-card hand among players sharing a board
+ * Each player's lookups depend only on the board, so the loads of
+ * different players overlap without any explicit interleaving
+ * board: the board holding all 5 community cards
+ * hands: each player's 2 hole cards
+ * numhands: the number of players
+ * return: the rank of the best hand (0 if there are no players)
+ */
+static inline
+int BestHandOnBoard(const BoardState *board, int hands[][2], int numhands)
+{
+    int best = 0;
+    int score;
+
+    //Branch free, so a mispredicted new best cannot flush the loads in flight
+    for (int i = 0; i < numhands; i++)
+    {
+        score = GetHandValueOnBoard(board, hands[i]);
+        best = score > best ? score : best;
+    }
+
+    return best;
+}
+
 #endif
@@ -9,6 +9,17 @@
 #define JSON_ARRAY_ELEM(json, i) \
     cJSON_GetArrayItem(json, i)
 
+//Deepest nesting of values ParseGameState will skip over
+#define MAX_JSON_DEPTH  32
+
+//Position of ParseGameState in the text it is reading
+//Once an error is found every scan fails, so loops end by themselves
+typedef struct jsoncursor
+{
+    const char *p;
+    bool error;
+} JsonCursor;
+
 //Maps an integer to a card string
 char *CARDS[] = {"XX",                                                  \
 "2S", "2C", "2D", "2H", "3S", "3C", "3D", "3H", "4S", "4C", "4D", "4H", \
@@ -48,21 +59,6 @@ Phase GetPhase(char *phase)
     }
 }
 
-/*
- * Remove cards from the deck that have already been seen in play
- * deck: the deck to remove cards from
- * cards: the cards to remove
- * numcards: the number of cards to remove
- */
-static inline
-void RemoveCardsFromDeck(bool *deck, int *cards, int numcards)
-{
-    for (int i = 0; i < numcards; i++)
-    {
-        deck[cards[i]] = false;
-    }
-}
-
 /*
  * Set the opponents for the game
  * game: the gamestate to set the opponents for
@@ -103,6 +99,417 @@ void SetGameOpponents(GameState *game, cJSON *players)
     game->num_playing = playing;
 }
 
+/*
+ * Compute the values that follow from the rest of the game state
+ * game: the game state whose opponents, hand and community cards are set
+ */
+static
+void FinishGameState(GameState *game)
+{
+    //Update the current pot
+    game->current_pot = game->current_bet;
+    for (int i = 0; i < game->num_opponents; i++)
+    {
+        game->current_pot += game->opponents[i].current_bet;
+    }
+
+    UpdateGameDeck(game);
+}
+
+/*
+ * Mark the cursor as having found an error
+ * cur: the cursor
+ * return: false, for convenience
+ */
+static
+bool JsonFail(JsonCursor *cur)
+{
+    cur->error = true;
+    return false;
+}
+
+/*
+ * Step over any whitespace
+ * cur: the cursor
+ */
+static
+void JsonSkipSpace(JsonCursor *cur)
+{
+    while (*cur->p == ' ' || *cur->p == '\t' || *cur->p == '\n' || *cur->p == '\r')
+    {
+        cur->p++;
+    }
+}
+
+/*
+ * Step over the next character if it is the one given, skipping whitespace
+ * cur: the cursor
+ * c: the character to look for
+ * return: true if the character was there
+ */
+static
+bool JsonConsume(JsonCursor *cur, char c)
+{
+    JsonSkipSpace(cur);
+    if (*cur->p != c) return false;
+
+    cur->p++;
+    return true;
+}
+
+/*
+ * Move to the next element of an object or array
+ * The opening bracket must already have been consumed
+ * cur: the cursor
+ * close: the closing bracket of the container
+ * count: the number of elements entered so far, incremented here
+ * return: true if there is another element, false at the end or on an error
+ */
+static
+bool JsonNextElement(JsonCursor *cur, char close, int *count)
+{
+    if (cur->error || JsonConsume(cur, close)) return false;
+    if (*count > 0 && !JsonConsume(cur, ',')) return JsonFail(cur);
+
+    (*count)++;
+    return true;
+}
+
+/*
+ * Find the bounds of a string without copying it
+ * cur: the cursor, left after the closing quote
+ * len: where to store the length of the raw string
+ * return: the start of the raw string in the text, or NULL on an error
+ */
+static
+const char *JsonScanString(JsonCursor *cur, int *len)
+{
+    const char *start;
+
+    if (!JsonConsume(cur, '"'))
+    {
+        JsonFail(cur);
+        return NULL;
+    }
+
+    start = cur->p;
+    while (*cur->p != '"')
+    {
+        if (*cur->p == '\0')
+        {
+            JsonFail(cur);
+            return NULL;
+        }
+
+        //Step over the escaped character too, so an escaped quote cannot end the string
+        if (*cur->p == '\\' && cur->p[1] != '\0')
+        {
+            cur->p++;
+        }
+        cur->p++;
+    }
+
+    *len = cur->p - start;
+    cur->p++;
+    return start;
+}
+
+/*
+ * Read an object's key and the colon after it
+ * cur: the cursor
+ * len: where to store the length of the raw key
+ * return: the start of the raw key in the text, or NULL on an error
+ */
+static
+const char *JsonScanKey(JsonCursor *cur, int *len)
+{
+    const char *key = JsonScanString(cur, len);
+
+    if (key && !JsonConsume(cur, ':'))
+    {
+        JsonFail(cur);
+        return NULL;
+    }
+
+    return key;
+}
+
+/*
+ * Compare a raw key against a field name the way cJSON_GetObjectItem does
+ * key: the raw key
+ * len: the length of the raw key
+ * name: the field name, in lower case
+ * return: true if they match, ignoring case
+ */
+static inline
+bool JsonKeyIs(const char *key, int len, const char *name)
+{
+    //The length is known at compile time, so most keys are ruled out at once
+    if ((int)strlen(name) != len) return false;
+
+    for (int i = 0; i < len; i++)
+    {
+        if (tolower((unsigned char)key[i]) != name[i]) return false;
+    }
+
+    return true;
+}
+
+/*
+ * Copy a raw string into a buffer, decoding its escapes
+ * Characters past the end of the buffer are dropped
+ * raw: the raw string
+ * len: the length of the raw string
+ * out: the buffer to fill in, always terminated
+ * size: the length of the buffer
+ */
+static
+void JsonCopyString(const char *raw, int len, char *out, int size)
+{
+    unsigned code;
+    int n = 0;
+    char c;
+
+    for (int i = 0; i < len && n < size - 1; i++)
+    {
+        c = raw[i];
+        if (c == '\\' && i + 1 < len)
+        {
+            c = raw[++i];
+            switch (c)
+            {
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'u':
+                //Names are only printed, so code points that need
+                //more than two bytes of UTF-8 are left out
+                if (i + 4 >= len || sscanf(raw + i + 1, "%4x", &code) != 1)
+                {
+                    continue;
+                }
+                i += 4;
+
+                if (code < 0x80)
+                {
+                    c = code;
+                }
+                else if (code < 0x800 && n < size - 2)
+                {
+                    out[n++] = 0xc0 | (code >> 6);
+                    c = 0x80 | (code & 0x3f);
+                }
+                else
+                {
+                    continue;
+                }
+                break;
+            default: break; //quotes, slashes and backslashes stand for themselves
+            }
+        }
+
+        out[n++] = c;
+    }
+
+    out[n] = '\0';
+}
+
+/*
+ * Read a number or literal as cJSON's valueint would give it
+ * cur: the cursor
+ * return: the value, true as 1 and false or null as 0
+ */
+static
+int JsonScanInt(JsonCursor *cur)
+{
+    char *end;
+    double value;
+    bool negative;
+
+    JsonSkipSpace(cur);
+    if (!strncmp(cur->p, "true", 4))
+    {
+        cur->p += 4;
+        return 1;
+    }
+    if (!strncmp(cur->p, "false", 5) || !strncmp(cur->p, "null", 4))
+    {
+        cur->p += *cur->p == 'f' ? 5 : 4;
+        return 0;
+    }
+
+    //Plain integers are read directly, strtod is far slower
+    negative = *cur->p == '-';
+    end = (char *)cur->p + negative;
+    if (*end >= '0' && *end <= '9')
+    {
+        for (value = 0; *end >= '0' && *end <= '9'; end++)
+        {
+            value = value * 10 + (*end - '0');
+        }
+
+        if (*end != '.' && *end != 'e' && *end != 'E')
+        {
+            cur->p = end;
+            return (int)(negative ? -value : value);
+        }
+    }
+
+    value = strtod(cur->p, &end);
+    if (end == cur->p) return JsonFail(cur);
+
+    cur->p = end;
+    return (int)value;
+}
+
+/*
+ * Step over a value of any type
+ * cur: the cursor
+ * depth: how deeply the value is nested
+ */
+static
+void JsonSkipValue(JsonCursor *cur, int depth)
+{
+    int count = 0;
+    int len;
+
+    if (depth > MAX_JSON_DEPTH)
+    {
+        JsonFail(cur);
+    }
+    else if (JsonConsume(cur, '{'))
+    {
+        while (JsonNextElement(cur, '}', &count))
+        {
+            if (JsonScanKey(cur, &len)) JsonSkipValue(cur, depth + 1);
+        }
+    }
+    else if (JsonConsume(cur, '['))
+    {
+        while (JsonNextElement(cur, ']', &count))
+        {
+            JsonSkipValue(cur, depth + 1);
+        }
+    }
+    else if (*cur->p == '"')
+    {
+        JsonScanString(cur, &len);
+    }
+    else
+    {
+        JsonScanInt(cur);
+    }
+}
+
+/*
+ * Read an array of card strings
+ * cur: the cursor
+ * cards: where to store the cards
+ * max_cards: the length of cards, any more are read but left out
+ * return: the number of cards stored
+ */
+static
+int JsonScanCards(JsonCursor *cur, int *cards, int max_cards)
+{
+    const char *card;
+    int count = 0;
+    int len;
+
+    if (!JsonConsume(cur, '[')) return JsonFail(cur);
+
+    while (JsonNextElement(cur, ']', &count))
+    {
+        card = JsonScanString(cur, &len);
+        if (!card || len < 2) return JsonFail(cur);
+
+        //StringToCard only looks at the first two characters
+        if (count <= max_cards)
+        {
+            cards[count - 1] = StringToCard((char *)card);
+        }
+    }
+
+    return count < max_cards ? count : max_cards;
+}
+
+/*
+ * Read one player of the players_at_table array
+ * cur: the cursor
+ * player: the player to fill in, fields that are not given are zero
+ */
+static
+void JsonScanPlayer(JsonCursor *cur, Player *player)
+{
+    const char *key;
+    const char *name;
+    int count = 0;
+    int len;
+
+    memset(player, 0, sizeof(*player));
+    if (!JsonConsume(cur, '{'))
+    {
+        JsonFail(cur);
+        return;
+    }
+
+    while (JsonNextElement(cur, '}', &count))
+    {
+        if (!(key = JsonScanKey(cur, &len))) break;
+
+        if (JsonKeyIs(key, len, "player_name"))
+        {
+            if ((name = JsonScanString(cur, &len)))
+            {
+                JsonCopyString(name, len, player->name, sizeof(player->name));
+            }
+        }
+        else if (JsonKeyIs(key, len, "initial_stack")) player->initial_stack = JsonScanInt(cur);
+        else if (JsonKeyIs(key, len, "stack"))         player->stack = JsonScanInt(cur);
+        else if (JsonKeyIs(key, len, "current_bet"))   player->current_bet = JsonScanInt(cur);
+        else if (JsonKeyIs(key, len, "folded"))        player->folded = JsonScanInt(cur);
+        else JsonSkipValue(cur, 1);
+    }
+}
+
+/*
+ * Read the players_at_table array into the game's opponents
+ * cur: the cursor
+ * game: the game state to fill in
+ */
+static
+void JsonScanOpponents(JsonCursor *cur, GameState *game)
+{
+    Player extra;
+    int count = 0;
+
+    game->num_opponents = 0;
+    game->num_playing = 0;
+    if (!JsonConsume(cur, '['))
+    {
+        JsonFail(cur);
+        return;
+    }
+
+    while (JsonNextElement(cur, ']', &count))
+    {
+        //Players past the last slot are read but left out
+        if (count > MAX_OPPONENTS)
+        {
+            JsonScanPlayer(cur, &extra);
+            continue;
+        }
+
+        JsonScanPlayer(cur, &game->opponents[count - 1]);
+        game->num_opponents++;
+        if (!game->opponents[count - 1].folded)
+        {
+            game->num_playing++;
+        }
+    }
+}
+
 /*
  * Create an int representing the given card
  * card: the string representation of the card
@@ -192,18 +599,90 @@ void SetGameState(GameState *game, cJSON *json)
     //Set the AI's list of opponents
     SetGameOpponents(game, JSON(json, "players_at_table"));
 
-    //Update the current pot
-    game->current_pot = game->current_bet;
-    for (int i = 0; i < game->num_opponents; i++)
-    {
-        game->current_pot += game->opponents[i].current_bet;
-    }
-
     //Set the AI's hand and the community cards
     game->handsize = GetCardArray(game->hand, JSON(json, "hand"));
     game->communitysize = GetCardArray(game->community, JSON(json, "community_cards"));
 
-    UpdateGameDeck(game);
+    FinishGameState(game);
+}
+
+/*
+ * Fill in a game state from the text of a JSON game state as it is read
+ * game: the game state to fill in, fields missing from the text are zero
+ * text: the JSON text of the game state
+ * return: true if the text was well formed, the game state is incomplete otherwise
+ */
+static
+bool ScanGameState(GameState *game, const char *text)
+{
+    JsonCursor cursor = {text, false};
+    JsonCursor *cur = &cursor;
+    const char *key;
+    const char *phase;
+    char phasename[8];
+    int count = 0;
+    int len;
+
+    memset(game, 0, sizeof(*game));
+    game->phase = PHASE_ERROR;
+
+    if (!JsonConsume(cur, '{')) return false;
+
+    while (JsonNextElement(cur, '}', &count))
+    {
+        if (!(key = JsonScanKey(cur, &len))) break;
+
+        if (JsonKeyIs(key, len, "round_id"))                game->round_id = JsonScanInt(cur);
+        else if (JsonKeyIs(key, len, "initial_stack"))      game->initial_stack = JsonScanInt(cur);
+        else if (JsonKeyIs(key, len, "stack"))              game->stack = JsonScanInt(cur);
+        else if (JsonKeyIs(key, len, "current_bet"))        game->current_bet = JsonScanInt(cur);
+        else if (JsonKeyIs(key, len, "call_amount"))        game->call_amount = JsonScanInt(cur);
+        else if (JsonKeyIs(key, len, "your_turn"))          game->your_turn = JsonScanInt(cur);
+        else if (JsonKeyIs(key, len, "players_at_table"))   JsonScanOpponents(cur, game);
+        else if (JsonKeyIs(key, len, "hand"))
+        {
+            game->handsize = JsonScanCards(cur, game->hand, NUM_HAND);
+        }
+        else if (JsonKeyIs(key, len, "community_cards"))
+        {
+            game->communitysize = JsonScanCards(cur, game->community, NUM_COMMUNITY);
+        }
+        else if (JsonKeyIs(key, len, "betting_phase"))
+        {
+            if ((phase = JsonScanString(cur, &len)))
+            {
+                JsonCopyString(phase, len, phasename, sizeof(phasename));
+                game->phase = GetPhase(phasename);
+            }
+        }
+        else
+        {
+            JsonSkipValue(cur, 1);
+        }
+    }
+
+    FinishGameState(game);
+    return !cur->error;
+}
+
+/*
+ * Set the game state straight from the text of a JSON game state
+ * Reads the text once without building a cJSON tree or allocating,
+ * and fills in the same fields SetGameState would
+ * game: the game state to set, fields missing from the text are zero,
+ * left as it was if the text is malformed
+ * text: the JSON text of the game state
+ * return: true if the text was well formed
+ */
+bool ParseGameState(GameState *game, const char *text)
+{
+    GameState parsed;
+
+    //A truncated response must not leave a half-filled state behind
+    if (!ScanGameState(&parsed, text)) return false;
+
+    *game = parsed;
+    return true;
 }
 
 /*
@@ -214,9 +693,31 @@ void SetGameState(GameState *game, cJSON *json)
 void UpdateGameDeck(GameState *game)
 {
     //Remove these cards from the deck
-    memset(game->deck, 1, sizeof(game->deck) / sizeof(game->deck[0]));
-    RemoveCardsFromDeck(game->deck, game->hand, game->handsize);
-    RemoveCardsFromDeck(game->deck, game->community, game->communitysize);
+    game->deck = FULL_DECK_MASK
+        & ~CardsToMask(game->hand, game->handsize)
+        & ~CardsToMask(game->community, game->communitysize);
+}
+
+/*
+ * Collect the cards still in the game's deck
+ * cards: the int array of where to place the results (at least NUM_DECK long)
+ * return: the number of cards in the array
+ */
+int GetLiveCards(GameState *game, int *cards)
+{
+    int numcards = 0;
+
+    //Cards are 1 indexed
+    for (int i = 1; i < NUM_DECK; i++)
+    {
+        if (game->deck & CardToMask(i))
+        {
+            cards[numcards] = i;
+            numcards++;
+        }
+    }
+
+    return numcards;
 }
 
 /*
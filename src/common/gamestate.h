@@ -1,10 +1,12 @@
 #ifndef __GAMESTATE_H__
 #define __GAMESTATE_H__
 
+#include <ctype.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 
+#include "cardmask.h"
 #include "cJSON.h"
 #include "player.h"
 
@@ -39,7 +41,7 @@ typedef struct gamestate
     int num_playing;
     int community[NUM_COMMUNITY];
     int communitysize;
-    bool deck[NUM_DECK];
+    CardMask deck;
 } GameState;
 
 /*
@@ -49,6 +51,17 @@ typedef struct gamestate
  */
 void SetGameState(GameState *game, cJSON *json);
 
+/*
+ * Set the game state straight from the text of a JSON game state
+ * Reads the text once without building a cJSON tree or allocating,
+ * and fills in the same fields SetGameState would
+ * game: the game state to set, fields missing from the text are zero,
+ * left as it was if the text is malformed
+ * text: the JSON text of the game state
+ * return: true if the text was well formed
+ */
+bool ParseGameState(GameState *game, const char *text);
+
 /*
  * Update the game's deck based on
  * the game's hand and community cards
@@ -56,6 +69,13 @@ void SetGameState(GameState *game, cJSON *json);
  */
 void UpdateGameDeck(GameState *game);
 
+/*
+ * Collect the cards still in the game's deck
+ * cards: the int array of where to place the results (at least NUM_DECK long)
+ * return: the number of cards in the array
+ */
+int GetLiveCards(GameState *game, int *cards);
+
 /*
  * Create an int representing the given card
  * card: the string representation of the card
@@ -1,82 +1,381 @@
 #include "pokerai.h"
 
-//Naive way to get thread ID
-#define THREAD_ID ((unsigned int)pthread_self() % 100)
+//The backend SIM_BACKEND_AUTO resolves to, timed once per process
+static SimBackend FASTEST_BACKEND = SIM_BACKEND_TABLE;
+static pthread_once_t CALIBRATE_ONCE = PTHREAD_ONCE_INIT;
+
+//Per-worker buffers reused for every simulated game
+//so the simulation loop never touches the heap
+typedef struct simscratch
+{
+    //The spot being simulated and the cards left in its deck
+    GameState *game;
+    int live[NUM_DECK];
+    int num_live;
+
+    int deck[NUM_DECK];
+    int community[NUM_COMMUNITY];
+    int opponents[MAX_OPPONENTS][NUM_HAND];
+
+    //Board holding the known community cards
+    BoardState known_board;
+
+    //The same spot as card masks for SIM_BACKEND_MASK
+    SimBackend backend;
+    CardMask live_mask;
+    CardMask hand_mask;
+    CardMask known_mask;
+
+    //The range of each playing opponent, unused when none is ranged
+    const HandRange *ranges;
+    int num_ranged;
+
+    //Stratified runouts, taken in turn instead of dealt, unused when num_runouts is 0
+    const Runout *runouts;
+    int num_runouts;
+    int next_runout;
+
+    //Our final hand value in the last simulated game
+    int hero_value;
+} SimScratch;
+
+//A batch of queries shared by every worker
+typedef struct batchjob
+{
+    PokerAI *ai;
+    EquityQuery *queries;
+    int num_queries;
+    long long games;
+
+    //The next query to hand out, claimed atomically
+    int next;
+} BatchJob;
+
+/*
+ * Wake the AI's worker pool to simulate poker games
+ * and stop every worker once the timeout has passed
+ * ai: the AI whose workers should run
+ */
+static
+void RunMonteCarloWorkers(PokerAI *ai);
+
+/*
+ * Make the AI's current spot the one the workers simulate, starting from
+ * the games cached for it if there are any and no games otherwise
+ * ai: the AI whose workers are parked
+ */
+static
+void PrepareSimulation(PokerAI *ai);
+
+/*
+ * Hand the prepared spot to the worker pool and return while the workers
+ * simulate it, adding to the games already in the tallies
+ * ai: the AI whose workers should run
+ */
+static
+void StartMonteCarloWorkers(PokerAI *ai);
+
+/*
+ * Get the cache key of the spot the workers simulate
+ * ai: the AI whose sim_game is used
+ * key: where to store the key
+ * return: false if the AI has no cache or the spot cannot be cached,
+ * which is the case whenever an opponent is dealt from a range
+ */
+static
+bool SimCacheKey(PokerAI *ai, EquityKey *key);
+
+/*
+ * Record the games in the tallies as the results of the simulated spot
+ * ai: the AI whose workers are parked
+ */
+static
+void CacheSimulation(PokerAI *ai);
 
 /*
- * Calculate the preflop win probability based on hole cards
- * hand: the AI's hole cards
- * return: the win probability of the given hole cards
+ * Stop a speculative simulation and wait for the workers to park
+ * The games it simulated stay in the tallies
+ * ai: the AI that may be speculating
  */
 static
-double PreflopWinProbability(int *hand);
+void StopSpeculation(PokerAI *ai);
 
 /*
- * Spawn Monte Carlo threads to simulate poker games
- * ai: the AI which should spawn the threads
+ * Check whether two game states pose the same win probability question
+ * a: the first game state
+ * b: the second game state
+ * betting: also compare what every opponent has bet, which shapes their range
+ * return: true if the hand, community cards and players still in are the same
  */
 static
-void SpawnMonteCarloThreads(PokerAI *ai);
+bool SameSpot(GameState *a, GameState *b, bool betting);
+
+/*
+ * Check whether any playing opponent should be dealt from a range
+ * ai: the AI whose range modeling setting applies
+ * game: the game state to check
+ * return: true if ranges are modeled and an opponent's is not uniform
+ */
+static
+bool HasRangedOpponents(PokerAI *ai, GameState *game);
+
+/*
+ * Build the range of every playing opponent of the spot the workers simulate
+ * ai: the AI whose sim_game is about to be simulated
+ */
+static
+void BuildOpponentRanges(PokerAI *ai);
+
+/*
+ * Check whether GetWinProbability would simulate a spot
+ * rather than look it up or enumerate it
+ * ai: the AI whose enumerate limit and range modeling apply
+ * game: the spot to check
+ * return: true if the spot needs Monte Carlo simulation
+ */
+static
+bool NeedsSimulation(PokerAI *ai, GameState *game);
 
 /*
  * Simulate games for the given AI
  * _ai: a void pointer to a PokerAI pointer
- * return: NULL (pthread requirement)
+ * worker: the index of the pool worker running the simulations
+ */
+static
+void SimulateGames(void *_ai, int worker);
+
+/*
+ * Make a worker's totals visible to every other thread
+ * Only the worker that owns the tally may publish to it
+ * tally: the worker's tally
+ * won: the games the worker has won so far
+ * simulated: the games the worker has simulated so far
+ */
+static inline
+void PublishTally(WorkerTally *tally, long long won, long long simulated);
+
+/*
+ * Make a worker's games and pot shares by hand class visible to every other thread
+ * Published before PublishTally, which releases them
+ * tally: the worker's tally
+ * class_games: the games the worker has simulated with each class
+ * class_shares: the pot shares the worker has won with each class
+ */
+static inline
+void PublishClassTally(WorkerTally *tally, const long long *class_games, const long long *class_shares);
+
+/*
+ * Add up the published totals of every worker without blocking any of them
+ * ai: the AI whose workers are simulating
+ * won: where to store the games won
+ * simulated: where to store the games simulated
  */
 static
-void *SimulateGames(void *_ai);
+void SumTallies(PokerAI *ai, long long *won, long long *simulated);
 
 /*
- * Simulate a single poker game for the given AI
- * ai: the poker AI to simulate games for
- * seed_index: which seed the thread will use for rand()
- * return: 1 on AI win, 0 on AI lose
+ * Estimate the win probability of the simulated spot with the AI's estimator
+ * from the class tallies every worker has published
+ * ai: the AI whose workers are simulating
+ * winprob: where to store the estimate
+ * variance: where to store the variance of the estimate
+ * return: false if no games have been published yet
  */
 static
-int SimulateSingleGame(PokerAI *ai, int seed_index);
+bool ReducedEstimate(PokerAI *ai, double *winprob, double *variance);
 
 /*
- * Randomly draw a card from the deck
- * and remove that card from the deck
- * deck: the deck to draw a card from
- * psize: a pointer to the size of the deck
- * rand_num: the random number to use in the draw
- * return: a random card from the deck
+ * Split our final hand values in sim_game into classes of about the same
+ * chance, by playing out every way the community cards can still come
+ * Classes are only told apart when the estimator asks for it and
+ * the spot allows it, otherwise every game falls in class 0
+ * ai: the AI whose sim_game is about to be simulated
  */
 static
-int draw(int *deck, int *psize, int rand_num);
+void SetClassProbabilities(PokerAI *ai);
 
 /*
- * Calculate the maximum opponent score
- * from the given list of opponent hands
- * opponents: an array of poker hands
- * numopponents: the number of opponents in the array
- * numcards: the size of each hand
- * return: the score of the best hand
+ * Value our hand on a complete board the way a backend does
+ * backend: the backend the workers simulate with
+ * cards: our hole cards followed by the five community cards
+ * return: the hand value
  */
 static
-int BestOpponentHand(int **opponents, int numopponents, int numcards);
+int RunoutValue(SimBackend backend, int *cards);
 
 /*
- * Set the AI's action given its expected gain
- * ai: the AI to set the action for
+ * List every runout of sim_game for stratified simulation, ordered by
+ * a stride of the golden ratio so that any stretch of them is spread over
+ * every turn card, and start each worker at its own share of the list
+ * Leaves no runouts when stratifying is off or the spot does not allow it
+ * ai: the AI whose sim_game is about to be simulated
  */
 static
-void MakeDecision(PokerAI *ai);
+void BuildRunouts(PokerAI *ai);
+
+/*
+ * Find the greatest common divisor of two numbers
+ * return: the greatest common divisor of a and b
+ */
+static
+int GreatestCommonDivisor(int a, int b);
+
+/*
+ * Find the class of our final hand value
+ * ai: the AI whose classes were set by SetClassProbabilities
+ * value: our hand value, from the backend the workers simulate with
+ * return: the class index
+ */
+static inline
+int HandClass(PokerAI *ai, int value);
+
+/*
+ * Order hand values for qsort
+ * a: the first value
+ * b: the second value
+ * return: negative, zero or positive as a is lower, equal or higher
+ */
+static
+int CompareValues(const void *a, const void *b);
+
+/*
+ * Decide whether every worker may stop simulating
+ * The first worker to see the estimate converge raises the AI's stop flag
+ * ai: the AI the workers are simulating games for
+ * return: true if the workers should stop simulating
+ */
+static
+bool ShouldStopSimulating(PokerAI *ai);
+
+/*
+ * Check whether a running estimate is precise enough to stop
+ * ai: the AI whose target error and thresholds apply
+ * won: the games won so far
+ * simulated: the games simulated so far
+ * return: true if the estimate meets the adaptive stopping rule
+ */
+static
+bool EstimateConverged(PokerAI *ai, long long won, long long simulated);
+
+/*
+ * Fill in the AI's decision thresholds for the given pot odds
+ * ai: the AI about to make a decision
+ * potodds: the pot odds of the decision
+ */
+static
+void SetDecisionThresholds(PokerAI *ai, double potodds);
+
+/*
+ * Evaluate the queries of a batch handed out to one worker
+ * _job: a void pointer to the BatchJob
+ * worker: the index of the pool worker
+ */
+static
+void RunBatchQueries(void *_job, int worker);
+
+/*
+ * Fill in a game state with the spot of a batch query
+ * query: the query to read
+ * game: the game state to fill in
+ */
+static
+void QueryGameState(EquityQuery *query, GameState *game);
+
+/*
+ * Fill in the parts of a worker's scratch buffers
+ * that stay the same for every simulated game
+ * game: the spot to simulate games for
+ * backend: the backend to simulate with (not SIM_BACKEND_AUTO)
+ * scratch: the worker's scratch buffers
+ */
+static
+void InitSimScratch(GameState *game, SimBackend backend, SimScratch *scratch);
+
+/*
+ * Simulate a single poker game from a worker's spot
+ * scratch: the worker's scratch buffers, set up by InitSimScratch
+ * rng: the worker's random number generator
+ * return: 0 on AI lose, otherwise the number of players
+ * splitting the pot (1 on an outright AI win)
+ */
+static
+int SimulateSingleGame(SimScratch *scratch, RandomState *rng);
+
+/*
+ * Simulate a single poker game from a worker's spot with card masks
+ * scratch: the worker's scratch buffers, set up by InitSimScratch
+ * rng: the worker's random number generator
+ * return: 0 on AI lose, otherwise the number of players
+ * splitting the pot (1 on an outright AI win)
+ */
+static
+int SimulateSingleGameMasks(SimScratch *scratch, RandomState *rng);
+
+/*
+ * Take the next runout of a stratified simulation, starting the list
+ * over once every runout has been taken
+ * scratch: the worker's scratch buffers, with runouts
+ * return: the runout to deal
+ */
+static inline
+const Runout *NextRunout(SimScratch *scratch);
+
+/*
+ * Deal every opponent with a range their hand for one game
+ * scratch: the worker's scratch buffers, the hands are written to its opponents
+ * rng: the worker's random number generator
+ * return: the mask of the cards dealt
+ */
+static inline
+CardMask DealRangedOpponents(SimScratch *scratch, RandomState *rng);
+
+/*
+ * Draw a card from the deck that has not been dealt from a range
+ * rng: the worker's random number generator
+ * deck: the deck to draw a card from
+ * psize: a pointer to the size of the deck
+ * dealt: the cards dealt from ranges in this game
+ * return: the card drawn
+ */
+static inline
+int DrawSimCard(RandomState *rng, int *deck, int *psize, CardMask dealt);
+
+/*
+ * Deal a card for SimulateSingleGameMasks
+ * Selecting a card out of a mask is only quick with pdep, without it
+ * the card is drawn from the scratch deck and turned into a mask
+ * scratch: the worker's scratch buffers
+ * rng: the worker's random number generator
+ * deck: the live cards as a mask
+ * psize: a pointer to the number of live cards
+ * dealt: the cards dealt from ranges in this game, already taken out of deck
+ * return: the mask of the dealt card
+ */
+static inline
+CardMask DealSimMaskCard(SimScratch *scratch, RandomState *rng, CardMask *deck, int *psize, CardMask dealt);
+
+/*
+ * Time both simulation backends on a fixed spot
+ * and remember the faster one in FASTEST_BACKEND
+ */
+static
+void CalibrateSimBackend(void);
 
 /*
- * Get the next free seed index of the AI
- * ai: the AI to get the next seed index from
- * return: the next free seed index
+ * Time single-threaded simulated games with one backend
+ * game: the spot to simulate
+ * backend: the backend to time
+ * return: the time taken in nanoseconds
  */
 static
-int GetNextFreeSeedIndex(PokerAI *ai);
+double TimeSimBackend(GameState *game, SimBackend backend);
 
-/* Release a held seed index
- * ai: the AI to release the seed index to
+/*
+ * Set the AI's action given its expected gain
+ * ai: the AI to set the action for
  */
 static
-void ReleaseSeedIndex(PokerAI *ai, int index);
+void MakeDecision(PokerAI *ai);
 
 /*
  * Create a new PokerAI
@@ -85,30 +384,76 @@ void ReleaseSeedIndex(PokerAI *ai, int index);
  * return a new PokerAI
  */
 PokerAI *CreatePokerAI(int timeout)
+{
+    return CreatePokerAIWithThreads(timeout, sysconf(_SC_NPROCESSORS_ONLN));
+}
+
+/*
+ * Create a new PokerAI with the given number of worker threads
+ *
+ * timeout: how long (in milliseconds) each thread may simulate games
+ * num_threads: the number of Monte Carlo workers
+ * return a new PokerAI
+ */
+PokerAI *CreatePokerAIWithThreads(int timeout, int num_threads)
 {
     PokerAI *ai = malloc(sizeof(*ai));
-    int num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    void *memory;
+
+    //Give every worker its own cache line to count games in
+    if (posix_memalign(&memory, CACHE_LINE_SIZE, sizeof(*ai->tallies) * num_threads))
+    {
+        free(ai);
+        return NULL;
+    }
+    ai->tallies = memory;
+    memset(ai->tallies, 0, sizeof(*ai->tallies) * num_threads);
 
     //Allocate worker thread members
     ai->num_threads = num_threads;
     ai->timeout = timeout;
-    ai->threads = malloc(sizeof(pthread_t) * num_threads);
-    pthread_mutex_init(&ai->mutex, NULL);
-
-    //Create random seeds for the worker threads
-    ai->seed_avail = malloc(sizeof(*ai->seeds) * num_threads);
-    ai->seeds = malloc(sizeof(*ai->seeds) * num_threads);
-    pthread_mutex_init(&ai->seed_mutex, NULL);
-    for (int i = 0; i < num_threads; i++)
-    {
-        ai->seed_avail[i] = true;
-        ai->seeds[i] = rand();
-    }
+    ai->enumerate_limit = DEFAULT_ENUMERATE_LIMIT;
+    ai->target_error = 0;
+    ai->num_thresholds = 0;
+    ai->stop_overshoot = 0;
+    memset(ai->node_games, 0, sizeof(ai->node_games));
+    SetSimBackend(ai, SIM_BACKEND_AUTO);
+
+    //Nothing has been simulated yet
+    ai->speculate = false;
+    ai->speculating = false;
+    ai->sim_valid = false;
+    ai->speculated_games = 0;
+
+    //Every opponent is dealt uniformly until ranges are turned on
+    ai->model_ranges = false;
+    ai->ranges = malloc(sizeof(*ai->ranges) * MAX_OPPONENTS);
+    ai->num_ranged = 0;
+
+    //Runouts are dealt at random until stratifying is turned on
+    ai->stratify = false;
+    ai->runouts = malloc(sizeof(*ai->runouts) * MAX_RUNOUTS);
+    ai->num_runouts = 0;
+
+    //Nothing is cached unless the caller provides a cache
+    ai->cache = NULL;
+
+    //Games are counted plainly until an estimator is chosen
+    ai->estimator = ESTIMATE_PLAIN;
+    ai->num_classes = 1;
+    ai->effective_games = 0;
+
+    //Give every worker thread its own random number generator
+    ai->rngs = CreateRandomStates(num_threads, ((uint64_t)rand() << 32) ^ rand());
+
+    //Start the workers now so they are parked and ready for each decision
+    ai->pool = CreateThreadPool(num_threads);
 
     //Set the initial state to no other players
     ai->game.num_opponents = 0;
     ai->game.num_playing = 0;
 
+    ai->loglevel = LOGLEVEL_NONE;
     ai->logfile = NULL;
     return ai;
 }
@@ -121,16 +466,19 @@ void DestroyPokerAI(PokerAI *ai)
 {
     if (!ai) return;
 
+    //A speculating worker may still log, so park the workers first
+    StopSpeculation(ai);
+    DestroyThreadPool(ai->pool);
+
     if (ai->logfile)
     {
         fclose(ai->logfile);
     }
 
-    pthread_mutex_destroy(&ai->mutex);
-    pthread_mutex_destroy(&ai->seed_mutex);
-
-    free(ai->seeds);
-    free(ai->threads);
+    DestroyRandomStates(ai->rngs);
+    free(ai->ranges);
+    free(ai->runouts);
+    free(ai->tallies);
     free(ai);
 }
 
@@ -150,6 +498,176 @@ void SetLogging(PokerAI *ai, LOGLEVEL level, FILE *file)
     fprintf(file, "timeout: %dms\n\n", ai->timeout);
 }
 
+/*
+ * Set the largest spot the AI will solve by exact enumeration
+ * Spots with more possible deals are sampled with Monte Carlo simulation
+ * ai: the AI to configure
+ * limit: the maximum number of deals to enumerate (0 disables enumeration)
+ */
+void SetEnumerateLimit(PokerAI *ai, long long limit)
+{
+    ai->enumerate_limit = limit;
+}
+
+/*
+ * Pin each of the AI's workers to its own CPU, or let them float again
+ * Pinned workers stay on one NUMA node, so with a table loaded
+ * with LOAD_REPLICATE each one only ever reads its local copy
+ * ai: the AI to configure
+ * pin: true to pin the workers, false to allow every CPU again
+ * return: true if every worker's affinity was set
+ */
+bool SetWorkerPinning(PokerAI *ai, bool pin)
+{
+    return PinThreadPool(ai->pool, pin);
+}
+
+/*
+ * Choose how the AI deals and evaluates simulated games
+ * Exact enumeration always walks the hand rank table
+ * ai: the AI to configure
+ * backend: the backend to simulate with, SIM_BACKEND_AUTO
+ * picks whichever is faster on this machine
+ */
+void SetSimBackend(PokerAI *ai, SimBackend backend)
+{
+    if (backend != SIM_BACKEND_AUTO)
+    {
+        ai->backend = backend;
+    }
+    else if (!POKERLIB_INITIALIZED)
+    {
+        //Without a table there is nothing to compare against
+        ai->backend = SIM_BACKEND_MASK;
+    }
+    else
+    {
+        pthread_once(&CALIBRATE_ONCE, CalibrateSimBackend);
+        ai->backend = FASTEST_BACKEND;
+    }
+}
+
+/*
+ * Let the AI stop simulating before the timeout once its estimate is good enough
+ * The timeout remains an upper bound on the simulation time
+ * ai: the AI to configure
+ * target_error: the largest acceptable half-width of the 99% confidence
+ * interval on the win probability (0 disables adaptive stopping)
+ */
+void SetTargetError(PokerAI *ai, double target_error)
+{
+    ai->target_error = target_error;
+}
+
+/*
+ * Choose how the AI estimates win probabilities from simulated games
+ * ESTIMATE_HAND_CLASSES only applies when at most MAX_CLASS_RUNOUT
+ * community cards are to come and no opponent is ranged, and spots
+ * are not cached while any estimator is set
+ * ESTIMATE_SPLIT_TIES also simulates preflop spots, since the preflop
+ * table counts ties as wins
+ * ai: the AI to configure
+ * flags: a combination of EstimateFlags (ESTIMATE_PLAIN by default)
+ */
+void SetEstimator(PokerAI *ai, int flags)
+{
+    //Games tallied for the old estimator cannot be carried over
+    StopSpeculation(ai);
+    ai->estimator = flags;
+    ai->sim_valid = false;
+}
+
+/*
+ * Model what each opponent holds from their betting this hand
+ * Opponents who have committed a large share of their stack are dealt
+ * stronger hands, so the AI simulates every spot where anyone has,
+ * including preflop and spots small enough to enumerate
+ * ai: the AI to configure
+ * model: true to deal from ranges, false to deal every hand uniformly
+ */
+void SetRangeModeling(PokerAI *ai, bool model)
+{
+    //Games simulated under the other model cannot be carried over
+    StopSpeculation(ai);
+    ai->model_ranges = model;
+    ai->sim_valid = false;
+}
+
+/*
+ * Stratify simulated games by their runout: with at most MAX_RUNOUT_CARDS
+ * community cards to come, each worker takes every turn and river in turn
+ * instead of dealing them at random, so no runout is repeated before every
+ * other has come up, and only the opponents' hands are left to chance
+ * Spots where an opponent is dealt from a range are still dealt at random
+ * ai: the AI to configure
+ * stratify: true to take every runout in turn, false to deal them at random
+ */
+void SetStratifiedRunouts(PokerAI *ai, bool stratify)
+{
+    //The workers are handed the runouts when a simulation is prepared
+    StopSpeculation(ai);
+    ai->stratify = stratify;
+    ai->sim_valid = false;
+}
+
+/*
+ * Give the AI a cache of simulated spots to start from and add to
+ * ai: the AI to configure
+ * cache: the cache to use, which the caller keeps ownership of (NULL for none)
+ */
+void SetEquityCache(PokerAI *ai, EquityCache *cache)
+{
+    StopSpeculation(ai);
+    ai->cache = cache;
+}
+
+/*
+ * Let the AI simulate the current spot in the background while it waits for its turn
+ * Game states that are not the AI's turn start the workers on their spot,
+ * and GetWinProbability keeps every game simulated since the spot last changed
+ * ai: the AI to configure
+ * speculate: true to speculate, false to stop any running speculation
+ */
+void SetSpeculation(PokerAI *ai, bool speculate)
+{
+    if (!speculate)
+    {
+        StopSpeculation(ai);
+    }
+
+    ai->speculate = speculate;
+}
+
+/*
+ * Start refining the win probability of the current spot in the background
+ * Does nothing if the workers are already simulating this spot, or if the
+ * spot is looked up or enumerated instead of simulated
+ * Called by UpdateGameState when speculation is enabled
+ * ai: the AI whose spot should be simulated
+ */
+void SpeculateWinProbability(PokerAI *ai)
+{
+    bool same = ai->sim_valid && SameSpot(&ai->sim_game, &ai->game, ai->model_ranges);
+
+    if (ai->speculating && same) return;
+
+    StopSpeculation(ai);
+    if (!NeedsSimulation(ai, &ai->game)) return;
+
+    if (ai->loglevel >= LOGLEVEL_DEBUG)
+    {
+        fprintf(ai->logfile, "Speculating on the spot while waiting for our turn.\n");
+    }
+
+    //Keep whatever was simulated for this spot before, such as our last decision
+    if (!same)
+    {
+        PrepareSimulation(ai);
+    }
+    StartMonteCarloWorkers(ai);
+    ai->speculating = true;
+}
+
 /*
  * Update the given PokerAI's game state
  * ai: the PokerAI to update
@@ -164,6 +682,42 @@ void UpdateGameState(PokerAI *ai, cJSON *new_state)
     {
         PrintTableInfo(&ai->game, ai->logfile);
     }
+
+    if (ai->speculate && !ai->game.your_turn)
+    {
+        SpeculateWinProbability(ai);
+    }
+}
+
+/*
+ * Update the given PokerAI's game state from the text of a JSON game state
+ * Faster than parsing the text with cJSON and calling UpdateGameState
+ * ai: the PokerAI to update
+ * text: the JSON text of the new game state
+ * return: true if the text was a well formed game state, the AI keeps
+ * its last game state otherwise
+ */
+bool UpdateGameStateFromText(PokerAI *ai, const char *text)
+{
+    bool parsed;
+
+    parsed = ParseGameState(&ai->game, text);
+    if (parsed)
+    {
+        ai->action.type = ACTION_UNSET;
+    }
+
+    if (parsed && ai->loglevel >= LOGLEVEL_INFO)
+    {
+        PrintTableInfo(&ai->game, ai->logfile);
+    }
+
+    if (parsed && ai->speculate && !ai->game.your_turn)
+    {
+        SpeculateWinProbability(ai);
+    }
+
+    return parsed;
 }
 
 /*
@@ -219,6 +773,9 @@ char *GetBestAction(PokerAI *ai)
     ai->games_won = 0;
     ai->games_simulated = 0;
 
+    //The workers read the thresholds, so they must be parked first
+    StopSpeculation(ai);
+
     //Set the pot odds
     if (ai->game.call_amount > 0)
     {
@@ -231,7 +788,10 @@ char *GetBestAction(PokerAI *ai)
     }
 
     //Set the rate of return
+    //The thresholds let the simulation stop once the decision is clear
+    SetDecisionThresholds(ai, potodds);
     winprob = GetWinProbability(ai);
+    ai->num_thresholds = 0;
     expectedgain = winprob / potodds;
 
     if (ai->loglevel >= LOGLEVEL_INFO)
@@ -240,380 +800,1466 @@ char *GetBestAction(PokerAI *ai)
         fprintf(ai->logfile, "Rate of return:  %.2lf\n", expectedgain);
     }
 
-    ai->action.winprob = winprob;
-    ai->action.expectedgain = expectedgain;
+    ai->action.winprob = winprob;
+    ai->action.expectedgain = expectedgain;
+
+    MakeDecision(ai);
+    return ActionGetString(&ai->action);
+}
+
+/*
+ * Use Monte Carlo simulation to determine the win probability given the AI's hand and community cards
+ * ai: the AI that is predicting the win probability
+ * return: the win probability as a double in the range [0, 1]
+ */
+double GetWinProbability(PokerAI *ai)
+{
+    double winprob;
+    double variance;
+    bool ranged = HasRangedOpponents(ai, &ai->game);
+    ai->games_won = 0;
+    ai->games_simulated = 0;
+    ai->speculated_games = 0;
+    ai->effective_games = 0;
+
+    StopSpeculation(ai);
+
+    //Use the precomputed preflop equity table if there aren't any community cards yet
+    //The table and the enumerator both assume uniformly random opponents,
+    //and the table counts ties as wins, so split ties are simulated
+    if (ai->game.communitysize == 0 && !ranged && !(ai->estimator & ESTIMATE_SPLIT_TIES))
+    {
+        if (ai->loglevel >= LOGLEVEL_DEBUG)
+        {
+            fprintf(ai->logfile, "Looking up preflop equity.\n");
+        }
+
+        winprob = PreflopEquity(ai->game.hand, ai->game.num_playing);
+    }
+    //Small spots are solved exactly, which is faster than sampling them
+    else if (!ranged && CountDeals(&ai->game) <= ai->enumerate_limit)
+    {
+        long long won;
+        long long deals;
+
+        if (ai->loglevel >= LOGLEVEL_DEBUG)
+        {
+            fprintf(ai->logfile, "Enumerating every possible deal.\n");
+        }
+
+        if (ai->estimator & ESTIMATE_SPLIT_TIES)
+        {
+            deals = EnumerateEquity(&ai->game, &won, &winprob);
+        }
+        else
+        {
+            deals = EnumerateDeals(&ai->game, &won);
+            winprob = ((double) won) / deals;
+        }
+        ai->games_won = won;
+        ai->games_simulated = deals;
+        ai->effective_games = deals;
+
+        if (ai->loglevel >= LOGLEVEL_INFO)
+        {
+            fprintf(ai->logfile, "Enumerated %lld deals.\n", deals);
+        }
+    }
+    //Otherwise, wake the Monte Carlo workers
+    else
+    {
+        if (ai->loglevel >= LOGLEVEL_DEBUG)
+        {
+            fprintf(ai->logfile, "Performing Monte Carlo simulations.\n");
+        }
+
+        RunMonteCarloWorkers(ai);
+        winprob = ((double) ai->games_won) / ai->games_simulated;
+        ai->effective_games = ai->games_simulated;
+
+        //The estimator's variance tells how many plain games it is worth
+        if (ai->estimator && ReducedEstimate(ai, &winprob, &variance) && variance > 0)
+        {
+            ai->effective_games = winprob * (1 - winprob) / variance;
+        }
+
+        if (ai->loglevel >= LOGLEVEL_INFO)
+        {
+            //Human-readable output
+            if (ai->games_simulated > 1000000)
+            {
+                fprintf(ai->logfile, "Simulated %.3fM games.\n", (double)ai->games_simulated / 1000000);
+            }
+            else if (ai->games_simulated > 1000)
+            {
+                fprintf(ai->logfile, "Simulated %lldk games.\n", ai->games_simulated / 1000);
+            }
+            else
+            {
+                fprintf(ai->logfile, "Simulated %lld games.\n", ai->games_simulated);
+            }
+
+            if (ai->estimator)
+            {
+                fprintf(ai->logfile, "As precise as %.3fM plain games.\n", ai->effective_games / 1000000);
+            }
+        }
+    }
+
+    return winprob;
+}
+
+/*
+ * Read the running totals of the current simulation without waiting for it
+ * Safe to call from any thread while GetWinProbability is simulating;
+ * the workers are never blocked, and each publishes its totals every 1000 games
+ * ai: the AI that is simulating
+ * won: where to store the games won so far (may be NULL)
+ * simulated: where to store the games simulated so far (may be NULL)
+ * return: the running win probability, or 0 if no games have been published
+ */
+double GetSimulationProgress(PokerAI *ai, long long *won, long long *simulated)
+{
+    long long sumwon;
+    long long sumsimulated;
+
+    SumTallies(ai, &sumwon, &sumsimulated);
+    if (won) *won = sumwon;
+    if (simulated) *simulated = sumsimulated;
+
+    return sumsimulated > 0 ? ((double) sumwon) / sumsimulated : 0;
+}
+
+/*
+ * Determine the win probability of many spots in one call
+ * Spots are handed to the AI's workers one at a time and each is
+ * looked up, enumerated or simulated just like GetWinProbability would,
+ * except that simulated spots run a fixed number of games instead of a timeout
+ * ai: the AI whose workers and enumerate limit are used
+ * queries: the spots to evaluate, the results are written back into them
+ * num_queries: the number of spots
+ * games: how many games to simulate for each spot that is not enumerated
+ */
+void GetWinProbabilities(PokerAI *ai, EquityQuery *queries, int num_queries, long long games)
+{
+    BatchJob job;
+    GameState game;
+    EquityKey key;
+
+    StopSpeculation(ai);
+
+    //Simulated spots start from their cached games, and only the
+    //games they are short of are simulated
+    for (int i = 0; i < num_queries; i++)
+    {
+        queries[i].games_won = 0;
+        queries[i].games_simulated = 0;
+        if (!ai->cache) continue;
+
+        QueryGameState(&queries[i], &game);
+        if (NeedsSimulation(ai, &game))
+        {
+            key = MakeEquityKey(game.hand, game.community, game.communitysize, game.num_playing);
+            LookupEquity(ai->cache, &key, &queries[i].games_won, &queries[i].games_simulated);
+        }
+    }
+
+    job.ai = ai;
+    job.queries = queries;
+    job.num_queries = num_queries;
+    job.games = games;
+    job.next = 0;
+
+    ThreadPoolRun(ai->pool, RunBatchQueries, &job);
+
+    if (!ai->cache) return;
+
+    for (int i = 0; i < num_queries; i++)
+    {
+        QueryGameState(&queries[i], &game);
+        if (NeedsSimulation(ai, &game))
+        {
+            key = MakeEquityKey(game.hand, game.community, game.communitysize, game.num_playing);
+            StoreEquity(ai->cache, &key, queries[i].games_won, queries[i].games_simulated);
+        }
+    }
+}
+
+/*
+ * Print the AI's decision to the given FILE
+ * ai: the AI that is making the decision
+ * file: the FILE where output should be written
+ */
+void WriteAction(PokerAI *ai, FILE *file)
+{
+    switch(ai->action.type)
+    {
+    case ACTION_FOLD:
+        fprintf(file, "ACTION:\tFOLDING\n");
+        break;
+
+    case ACTION_CALL:
+        if (ai->action.bluff)
+        {
+            fprintf(file, "ACTION:\tCALLING (BLUFF)\n");
+        }
+        else
+        {
+            fprintf(file, "ACTION:\tCALLING\n");
+        }
+        break;
+
+    case ACTION_BET:
+        if (ai->action.bluff)
+        {
+            fprintf(file, "ACTION:\tBETTING %d (BLUFF)\n", ai->action.amount);
+        }
+        else
+        {
+            fprintf(file, "ACTION:\tBETTING %d\n", ai->action.amount);
+        }
+        break;
+
+    default:
+        fprintf(file, "!! No action set !!\n");
+        break;
+    }
+}
+
+/*
+ * Wake the AI's worker pool to simulate poker games
+ * and stop every worker once the timeout has passed
+ * ai: the AI whose workers should run
+ */
+static
+void RunMonteCarloWorkers(PokerAI *ai)
+{
+    struct timespec deadline;
+    unsigned long long stopped;
+    bool resume = ai->speculate && ai->sim_valid
+        && SameSpot(&ai->sim_game, &ai->game, ai->model_ranges);
+    bool decided = false;
+
+    ai->stop_overshoot = 0;
+
+    if (!resume)
+    {
+        PrepareSimulation(ai);
+    }
+
+    //Games simulated while waiting for our turn or found in the cache count
+    //towards the decision, and may already be enough to decide at once
+    SumTallies(ai, &ai->games_won, &ai->speculated_games);
+    if (ai->speculated_games > 0)
+    {
+        decided = ai->target_error > 0 && EstimateConverged(ai, ai->games_won, ai->speculated_games);
+
+        if (ai->loglevel >= LOGLEVEL_DEBUG)
+        {
+            fprintf(ai->logfile, "Reusing %lld games simulated earlier.\n", ai->speculated_games);
+        }
+    }
+
+    if (!decided)
+    {
+        if (ai->loglevel >= LOGLEVEL_DEBUG)
+        {
+            fprintf(ai->logfile, "Waking Monte Carlo workers.\n");
+        }
+
+        //This thread is the only one watching the clock, the workers
+        //simulate games until it (or adaptive stopping) raises the stop flag
+        SetDeadline(&deadline, ai->timeout);
+        StartMonteCarloWorkers(ai);
+
+        if (!ThreadPoolWaitUntil(ai->pool, &deadline))
+        {
+            stopped = MonotonicNanoseconds();
+            __atomic_store_n(&ai->stop_simulating, true, __ATOMIC_RELAXED);
+            ThreadPoolWait(ai->pool);
+            ai->stop_overshoot = MonotonicNanoseconds() - stopped;
+        }
+    }
+
+    //The workers are parked, so their tallies are final
+    SumTallies(ai, &ai->games_won, &ai->games_simulated);
+    CacheSimulation(ai);
+    memset(ai->node_games, 0, sizeof(ai->node_games));
+    for (int i = 0; i < ai->num_threads; i++)
+    {
+        ai->node_games[ai->tallies[i].node] += ai->tallies[i].simulated;
+    }
+
+    if (ai->loglevel >= LOGLEVEL_DEBUG)
+    {
+        fprintf(ai->logfile, "All Monte Carlo workers finished %lluus after the timeout.\n",
+                ai->stop_overshoot / 1000);
+        for (int node = 0; node < MAX_NUMA_NODES; node++)
+        {
+            if (ai->node_games[node] > 0)
+            {
+                fprintf(ai->logfile, "Node %d simulated %lld games.\n", node, ai->node_games[node]);
+            }
+        }
+    }
+}
+
+/*
+ * Make the AI's current spot the one the workers simulate, starting from
+ * the games cached for it if there are any and no games otherwise
+ * ai: the AI whose workers are parked
+ */
+static
+void PrepareSimulation(PokerAI *ai)
+{
+    EquityKey key;
+
+    //The workers simulate a copy, so the game state can change under them
+    ai->sim_game = ai->game;
+    memset(ai->tallies, 0, sizeof(*ai->tallies) * ai->num_threads);
+    BuildOpponentRanges(ai);
+    BuildRunouts(ai);
+    SetClassProbabilities(ai);
+
+    //The first worker carries on from the cached games
+    if (SimCacheKey(ai, &key))
+    {
+        LookupEquity(ai->cache, &key, &ai->tallies[0].won, &ai->tallies[0].simulated);
+    }
+
+    ai->sim_valid = true;
+}
+
+/*
+ * Hand the prepared spot to the worker pool and return while the workers
+ * simulate it, adding to the games already in the tallies
+ * ai: the AI whose workers should run
+ */
+static
+void StartMonteCarloWorkers(PokerAI *ai)
+{
+    ai->stop_simulating = false;
+    ThreadPoolSubmit(ai->pool, SimulateGames, ai);
+}
+
+/*
+ * Get the cache key of the spot the workers simulate
+ * ai: the AI whose sim_game is used
+ * key: where to store the key
+ * return: false if the AI has no cache or the spot cannot be cached,
+ * which is the case whenever an opponent is dealt from a range
+ */
+static
+bool SimCacheKey(PokerAI *ai, EquityKey *key)
+{
+    GameState *game = &ai->sim_game;
+
+    //The cache only holds plain counts
+    if (!ai->cache || ai->estimator || ai->num_ranged > 0 || game->handsize != NUM_HAND) return false;
+
+    *key = MakeEquityKey(game->hand, game->community, game->communitysize, game->num_playing);
+    return true;
+}
+
+/*
+ * Record the games in the tallies as the results of the simulated spot
+ * ai: the AI whose workers are parked
+ */
+static
+void CacheSimulation(PokerAI *ai)
+{
+    EquityKey key;
+    long long won;
+    long long simulated;
+
+    if (!ai->sim_valid || !SimCacheKey(ai, &key)) return;
+
+    //The tallies started from the cached games, so they replace them
+    SumTallies(ai, &won, &simulated);
+    if (simulated > 0)
+    {
+        StoreEquity(ai->cache, &key, won, simulated);
+    }
+}
+
+/*
+ * Stop a speculative simulation and wait for the workers to park
+ * The games it simulated stay in the tallies
+ * ai: the AI that may be speculating
+ */
+static
+void StopSpeculation(PokerAI *ai)
+{
+    if (!ai->speculating) return;
+
+    __atomic_store_n(&ai->stop_simulating, true, __ATOMIC_RELAXED);
+    ThreadPoolWait(ai->pool);
+    ai->speculating = false;
+
+    //Keep the games even if the spot never comes up for a decision
+    CacheSimulation(ai);
+}
+
+/*
+ * Check whether two game states pose the same win probability question
+ * a: the first game state
+ * b: the second game state
+ * betting: also compare what every opponent has bet, which shapes their range
+ * return: true if the hand, community cards and players still in are the same
+ */
+static
+bool SameSpot(GameState *a, GameState *b, bool betting)
+{
+    if (a->handsize != b->handsize
+            || a->communitysize != b->communitysize
+            || a->num_playing != b->num_playing
+            || memcmp(a->hand, b->hand, sizeof(*a->hand) * a->handsize)
+            || memcmp(a->community, b->community, sizeof(*a->community) * a->communitysize))
+    {
+        return false;
+    }
+
+    if (!betting) return true;
+
+    if (a->num_opponents != b->num_opponents) return false;
+    for (int i = 0; i < a->num_opponents; i++)
+    {
+        if (a->opponents[i].folded != b->opponents[i].folded
+                || a->opponents[i].initial_stack != b->opponents[i].initial_stack
+                || a->opponents[i].stack != b->opponents[i].stack)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Check whether any playing opponent should be dealt from a range
+ * ai: the AI whose range modeling setting applies
+ * game: the game state to check
+ * return: true if ranges are modeled and an opponent's is not uniform
+ */
+static
+bool HasRangedOpponents(PokerAI *ai, GameState *game)
+{
+    if (!ai->model_ranges) return false;
+
+    for (int i = 0; i < game->num_opponents; i++)
+    {
+        if (!game->opponents[i].folded && RangeKeep(&game->opponents[i]) < 1.0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Build the range of every playing opponent of the spot the workers simulate
+ * ai: the AI whose sim_game is about to be simulated
+ */
+static
+void BuildOpponentRanges(PokerAI *ai)
+{
+    GameState *game = &ai->sim_game;
+    CardMask dead;
+    int playing = 0;
+
+    ai->num_ranged = 0;
+    if (!ai->model_ranges) return;
+
+    //Nobody can hold our cards or the board
+    dead = CardsToMask(game->hand, game->handsize) | CardsToMask(game->community, game->communitysize);
+
+    for (int i = 0; i < game->num_opponents && playing < game->num_playing; i++)
+    {
+        if (game->opponents[i].folded) continue;
+
+        SetPlayerRange(&ai->ranges[playing], &game->opponents[i], dead);
+        if (!ai->ranges[playing].uniform)
+        {
+            ai->num_ranged++;
+        }
+        playing++;
+    }
+
+    //Players the game state does not describe are dealt uniformly
+    for (; playing < game->num_playing; playing++)
+    {
+        ai->ranges[playing].uniform = true;
+    }
+}
+
+/*
+ * Check whether GetWinProbability would simulate a spot
+ * rather than look it up or enumerate it
+ * ai: the AI whose enumerate limit and range modeling apply
+ * game: the spot to check
+ * return: true if the spot needs Monte Carlo simulation
+ */
+static
+bool NeedsSimulation(PokerAI *ai, GameState *game)
+{
+    if (game->handsize != NUM_HAND || game->num_playing < 1) return false;
+
+    return HasRangedOpponents(ai, game)
+        || (game->communitysize > 0 && CountDeals(game) > ai->enumerate_limit);
+}
+
+/*
+ * Simulate games for the given AI
+ * _ai: a void pointer to a PokerAI pointer
+ * worker: the index of the pool worker running the simulations
+ */
+static
+void SimulateGames(void *_ai, int worker)
+{
+    PokerAI *ai = (PokerAI *)_ai;
+    WorkerTally *tally = &ai->tallies[worker];
+    SimScratch scratch;
+    long long class_games[NUM_HAND_CLASSES];
+    long long class_shares[NUM_HAND_CLASSES];
+    long long shares[MAX_OPPONENTS + 2];
+    int players;
+    int cls;
+
+    if (ai->loglevel >= LOGLEVEL_DEBUG)
+    {
+        fprintf(ai->logfile, "[Worker %d] starting\n", worker);
+    }
+
+    //Carry on from the games already simulated for this spot
+    long long simulated = tally->simulated;
+    long long won = tally->won;
+    memcpy(class_games, tally->class_games, sizeof(class_games));
+    memcpy(class_shares, tally->class_shares, sizeof(class_shares));
+
+    //A pot split between some players is worth a share to each,
+    //looked up so that winning or losing costs no branch
+    shares[0] = 0;
+    for (int i = 1; i < MAX_OPPONENTS + 2; i++)
+    {
+        shares[i] = (ai->estimator & ESTIMATE_SPLIT_TIES) ? TIE_SHARES / i : TIE_SHARES;
+    }
+
+    tally->node = GetCurrentNode();
+    UseLocalHandRanks();
+    InitSimScratch(&ai->sim_game, ai->backend, &scratch);
+    if (ai->num_ranged > 0)
+    {
+        scratch.ranges = ai->ranges;
+        scratch.num_ranged = ai->num_ranged;
+    }
+    if (ai->num_runouts > 0)
+    {
+        scratch.runouts = ai->runouts;
+        scratch.num_runouts = ai->num_runouts;
+        scratch.next_runout = tally->next_runout;
+    }
+
+    //The stop flag is a single load on a line nobody writes until the end,
+    //so checking it after every game lets all workers stop together
+    while (!__atomic_load_n(&ai->stop_simulating, __ATOMIC_RELAXED))
+    {
+        //Only share progress and check for convergence every 1000 simulations
+        if (simulated % 1000 == 0)
+        {
+            //Share progress so any thread can read the running estimate
+            if (ai->estimator)
+            {
+                PublishClassTally(tally, class_games, class_shares);
+            }
+            PublishTally(tally, won, simulated);
+
+            if (ShouldStopSimulating(ai))
+            {
+                break;
+            }
+        }
+
+        players = SimulateSingleGame(&scratch, &ai->rngs[worker]);
+        won += (players > 0);
+        simulated++;
+
+        if (ai->estimator)
+        {
+            cls = ai->num_classes > 1 ? HandClass(ai, scratch.hero_value) : 0;
+            class_games[cls]++;
+            class_shares[cls] += shares[players];
+        }
+    }
+
+    if (ai->loglevel >= LOGLEVEL_DEBUG)
+    {
+        fprintf(ai->logfile, "[Worker %d] done\t(simulated %lld games on node %d)\n", worker, simulated, tally->node);
+    }
+
+    //A resumed simulation carries on with the runouts this worker has not taken
+    tally->next_runout = scratch.next_runout;
+    if (ai->estimator)
+    {
+        PublishClassTally(tally, class_games, class_shares);
+    }
+    PublishTally(tally, won, simulated);
+}
+
+/*
+ * Make a worker's games and pot shares by hand class visible to every other thread
+ * Published before PublishTally, which releases them
+ * tally: the worker's tally
+ * class_games: the games the worker has simulated with each class
+ * class_shares: the pot shares the worker has won with each class
+ */
+static inline
+void PublishClassTally(WorkerTally *tally, const long long *class_games, const long long *class_shares)
+{
+    for (int i = 0; i < NUM_HAND_CLASSES; i++)
+    {
+        __atomic_store_n(&tally->class_games[i], class_games[i], __ATOMIC_RELAXED);
+        __atomic_store_n(&tally->class_shares[i], class_shares[i], __ATOMIC_RELAXED);
+    }
+}
+
+/*
+ * Make a worker's totals visible to every other thread
+ * Only the worker that owns the tally may publish to it
+ * tally: the worker's tally
+ * won: the games the worker has won so far
+ * simulated: the games the worker has simulated so far
+ */
+static inline
+void PublishTally(WorkerTally *tally, long long won, long long simulated)
+{
+    //Games won are released last, so a reader that sees them
+    //also sees at least as many games simulated
+    __atomic_store_n(&tally->simulated, simulated, __ATOMIC_RELAXED);
+    __atomic_store_n(&tally->won, won, __ATOMIC_RELEASE);
+}
+
+/*
+ * Add up the published totals of every worker without blocking any of them
+ * ai: the AI whose workers are simulating
+ * won: where to store the games won
+ * simulated: where to store the games simulated
+ */
+static
+void SumTallies(PokerAI *ai, long long *won, long long *simulated)
+{
+    *won = 0;
+    *simulated = 0;
+
+    for (int i = 0; i < ai->num_threads; i++)
+    {
+        *won += __atomic_load_n(&ai->tallies[i].won, __ATOMIC_ACQUIRE);
+        *simulated += __atomic_load_n(&ai->tallies[i].simulated, __ATOMIC_RELAXED);
+    }
+}
+
+/*
+ * Decide whether every worker may stop simulating
+ * The first worker to see the estimate converge raises the AI's stop flag
+ * ai: the AI the workers are simulating games for
+ * return: true if the workers should stop simulating
+ */
+static
+bool ShouldStopSimulating(PokerAI *ai)
+{
+    long long won;
+    long long simulated;
+
+    if (__atomic_load_n(&ai->stop_simulating, __ATOMIC_RELAXED)) return true;
+    if (ai->target_error <= 0) return false;
+
+    SumTallies(ai, &won, &simulated);
+    if (!EstimateConverged(ai, won, simulated)) return false;
+
+    //Only the worker that raises the flag logs it
+    if (__sync_bool_compare_and_swap(&ai->stop_simulating, false, true)
+            && ai->loglevel >= LOGLEVEL_DEBUG)
+    {
+        fprintf(ai->logfile, "Estimate converged after %lld games.\n", simulated);
+    }
+
+    return true;
+}
+
+/*
+ * Check whether a running estimate is precise enough to stop
+ * ai: the AI whose target error and thresholds apply
+ * won: the games won so far
+ * simulated: the games simulated so far
+ * return: true if the estimate meets the adaptive stopping rule
+ */
+static
+bool EstimateConverged(PokerAI *ai, long long won, long long simulated)
+{
+    double n = simulated;
+    double p;
+    double z2;
+    double center;
+    double halfwidth;
+    double variance;
+
+    if (n < STOP_MIN_GAMES) return false;
+
+    if (ai->estimator)
+    {
+        //Normal interval on the variance of the estimator
+        if (!ReducedEstimate(ai, &center, &variance)) return false;
+        halfwidth = STOP_CONFIDENCE_Z * sqrt(variance);
+    }
+    else
+    {
+        //Wilson score interval, which stays sensible near 0 and 1
+        p = won / n;
+        z2 = STOP_CONFIDENCE_Z * STOP_CONFIDENCE_Z;
+        center = (p + z2 / (2 * n)) / (1 + z2 / n);
+        halfwidth = STOP_CONFIDENCE_Z / (1 + z2 / n) * sqrt(p * (1 - p) / n + z2 / (4 * n * n));
+    }
+
+    if (halfwidth < ai->target_error) return true;
+
+    //The decision can only change if a threshold lies inside the interval
+    if (ai->num_thresholds == 0) return false;
+
+    for (int i = 0; i < ai->num_thresholds; i++)
+    {
+        if (fabs(ai->thresholds[i] - center) <= halfwidth) return false;
+    }
 
-    MakeDecision(ai);
-    return ActionGetString(&ai->action);
+    return true;
 }
 
 /*
- * Use Monte Carlo simulation to determine the win probability given the AI's hand and community cards
- * ai: the AI that is predicting the win probability
- * return: the win probability as a double in the range [0, 1]
+ * Estimate the win probability of the simulated spot with the AI's estimator
+ * from the class tallies every worker has published
+ * ai: the AI whose workers are simulating
+ * winprob: where to store the estimate
+ * variance: where to store the variance of the estimate
+ * return: false if no games have been published yet
  */
-double GetWinProbability(PokerAI *ai)
+static
+bool ReducedEstimate(PokerAI *ai, double *winprob, double *variance)
 {
-    double winprob;
-    ai->games_won = 0;
-    ai->games_simulated = 0;
+    long long games[NUM_HAND_CLASSES] = {0};
+    long long shares[NUM_HAND_CLASSES] = {0};
+    long long totalgames = 0;
+    long long totalshares = 0;
+    double n;
+    double won;
+    double p;
+    double q;
 
-    //Use preflop statistics if there aren't any community cards yet
-    if (ai->game.communitysize == 0)
+    for (int i = 0; i < ai->num_threads; i++)
     {
-        if (ai->loglevel >= LOGLEVEL_DEBUG)
+        for (int cls = 0; cls < NUM_HAND_CLASSES; cls++)
         {
-            fprintf(ai->logfile, "Performing simple preflop computation.\n");
+            games[cls] += __atomic_load_n(&ai->tallies[i].class_games[cls], __ATOMIC_RELAXED);
+            shares[cls] += __atomic_load_n(&ai->tallies[i].class_shares[cls], __ATOMIC_RELAXED);
         }
+    }
 
-        winprob = PreflopWinProbability(ai->game.hand);
+    for (int cls = 0; cls < NUM_HAND_CLASSES; cls++)
+    {
+        totalgames += games[cls];
+        totalshares += shares[cls];
     }
-    //Otherwise, start spawning Monte Carlo threads
-    else
+
+    if (totalgames == 0) return false;
+
+    //Average the classes weighted by their exact chance rather than by how
+    //often they came up; a class that has not come up yet gets the overall average
+    *winprob = 0;
+    *variance = 0;
+    for (int cls = 0; cls < ai->num_classes; cls++)
     {
-        if (ai->loglevel >= LOGLEVEL_DEBUG)
-        {
-            fprintf(ai->logfile, "Performing Monte Carlo simulations.\n");
-        }
+        n = games[cls] > 0 ? games[cls] : totalgames;
+        won = (double)(games[cls] > 0 ? shares[cls] : totalshares) / TIE_SHARES;
+        p = won / n;
 
-        SpawnMonteCarloThreads(ai);
-        winprob = ((double) ai->games_won) / ai->games_simulated;
+        //The variance of a share is at most that of a win or a loss, and a
+        //class that has always won or always lost is still taken as uncertain
+        q = (won + 1) / (n + 2);
 
-        if (ai->loglevel >= LOGLEVEL_INFO)
-        {
-            //Human-readable output
-            if (ai->games_simulated > 1000000)
-            {
-                fprintf(ai->logfile, "Simulated %.3fM games.\n", (double)ai->games_simulated / 1000000);
-            }
-            else if (ai->games_simulated > 1000)
-            {
-                fprintf(ai->logfile, "Simulated %dk games.\n", ai->games_simulated / 1000);
-            }
-            else
-            {
-                fprintf(ai->logfile, "Simulated %d games.\n", ai->games_simulated);
-            }
-        }
+        *winprob += ai->class_probs[cls] * p;
+        *variance += ai->class_probs[cls] * ai->class_probs[cls] * q * (1 - q) / n;
     }
 
-    return winprob;
+    return true;
 }
 
 /*
- * Print the AI's decision to the given FILE
- * ai: the AI that is making the decision
- * file: the FILE where output should be written
+ * Split our final hand values in sim_game into classes of about the same
+ * chance, by playing out every way the community cards can still come
+ * Classes are only told apart when the estimator asks for it and
+ * the spot allows it, otherwise every game falls in class 0
+ * ai: the AI whose sim_game is about to be simulated
  */
-void WriteAction(PokerAI *ai, FILE *file)
+static
+void SetClassProbabilities(PokerAI *ai)
 {
-    switch(ai->action.type)
+    GameState *game = &ai->sim_game;
+    int missing = NUM_COMMUNITY - game->communitysize;
+    int cards[NUM_HAND + NUM_COMMUNITY];
+    int live[NUM_DECK];
+    int num_live;
+    int *values;
+    int runouts = 0;
+    int cls;
+
+    //Unused classes start above every value so HandClass never lands in them
+    ai->num_classes = 1;
+    ai->class_floors[0] = 0;
+    ai->class_probs[0] = 1;
+    for (int i = 1; i < NUM_HAND_CLASSES; i++)
     {
-    case ACTION_FOLD:
-        fprintf(file, "ACTION:\tFOLDING\n");
-        break;
+        ai->class_floors[i] = INT_MAX;
+    }
 
-    case ACTION_CALL:
-        if (ai->action.bluff)
-        {
-            fprintf(file, "ACTION:\tCALLING (BLUFF)\n");
-        }
-        else
+    //Ranged opponents hold on to strong cards, so the board is no longer uniform
+    if (!(ai->estimator & ESTIMATE_HAND_CLASSES) || ai->num_ranged > 0
+            || game->handsize != NUM_HAND || missing > MAX_CLASS_RUNOUT)
+    {
+        return;
+    }
+
+    memcpy(cards, game->hand, sizeof(*cards) * NUM_HAND);
+    memcpy(cards + NUM_HAND, game->community, sizeof(*cards) * game->communitysize);
+    num_live = GetLiveCards(game, live);
+    values = malloc(sizeof(*values) * num_live * num_live);
+
+    //Value every runout with the workers' backend, whose values they will compare
+    if (missing == 0)
+    {
+        values[runouts++] = RunoutValue(ai->backend, cards);
+    }
+
+    for (int i = 0; i < num_live && missing > 0; i++)
+    {
+        cards[NUM_HAND + game->communitysize] = live[i];
+        if (missing == 1)
         {
-            fprintf(file, "ACTION:\tCALLING\n");
+            values[runouts++] = RunoutValue(ai->backend, cards);
+            continue;
         }
-        break;
 
-    case ACTION_BET:
-        if (ai->action.bluff)
+        for (int j = i + 1; j < num_live; j++)
         {
-            fprintf(file, "ACTION:\tBETTING %d (BLUFF)\n", ai->action.amount);
+            cards[NUM_HAND + game->communitysize + 1] = live[j];
+            values[runouts++] = RunoutValue(ai->backend, cards);
         }
-        else
+    }
+
+    //Start a new class whenever a value falls in the next slice of
+    //the runouts, so equal values always share a class
+    qsort(values, runouts, sizeof(*values), CompareValues);
+    ai->class_probs[0] = 0;
+    ai->class_floors[0] = values[0];
+    for (int i = 0; i < runouts; i++)
+    {
+        cls = ai->num_classes - 1;
+        if (i > 0 && values[i] != values[i - 1] && (long long)i * NUM_HAND_CLASSES / runouts > cls)
         {
-            fprintf(file, "ACTION:\tBETTING %d\n", ai->action.amount);
+            cls = ai->num_classes++;
+            ai->class_floors[cls] = values[i];
+            ai->class_probs[cls] = 0;
         }
-        break;
 
-    default:
-        fprintf(file, "!! No action set !!\n");
-        break;
+        ai->class_probs[cls] += 1.0 / runouts;
     }
+
+    free(values);
 }
 
 /*
- * Calculate the preflop win probability based on hole cards
- * hand: the AI's hole cards
- * return: the win probability of the given hole cards
+ * Value our hand on a complete board the way a backend does
+ * backend: the backend the workers simulate with
+ * cards: our hole cards followed by the five community cards
+ * return: the hand value
  */
 static
-double PreflopWinProbability(int *hand)
+int RunoutValue(SimBackend backend, int *cards)
 {
-    /*
-     * Quick guide:
-     * val:     0  1  2  3  4  5  6  7  8  9  10 11 12
-     * card:    2  3  4  5  6  7  8  9  T  J  Q  K  A
-     * score([AH,AD]) = 30
-     * score([AH,KD]) = 23
-     * score([TD,8D]) = 18
-     * score([AH,TD]) = 16
-     * score([KH,TD]) = 16
-     * score([JD,7D]) = 14
-     * score([4D,5D]) = 9
-     * score([2H,2D]) = 6
-     * score([2H,7H]) = 5
-     * score([2H,7D]) = 1
-     */
+    if (backend == SIM_BACKEND_MASK)
+    {
+        return GetMaskHandValue(CardsToMask(cards, NUM_HAND + NUM_COMMUNITY));
+    }
 
-    int score  = 0;
-    int c1val  = (hand[0] - 1) / 4;
-    int c2val  = (hand[1] - 1) / 4;
-    int c1suit = (hand[0] - 1) % 4;
-    int c2suit = (hand[1] - 1) % 4;
-    int diff = abs(c1val - c2val);
+    return GetHandValue(cards, NUM_HAND + NUM_COMMUNITY);
+}
 
-    //Be warned: many magic numbers exist in this function
-    //They have been chosen based on logic fine-tuning
+/*
+ * List every runout of sim_game for stratified simulation, ordered by
+ * a stride of the golden ratio so that any stretch of them is spread over
+ * every turn card, and start each worker at its own share of the list
+ * Leaves no runouts when stratifying is off or the spot does not allow it
+ * ai: the AI whose sim_game is about to be simulated
+ */
+static
+void BuildRunouts(PokerAI *ai)
+{
+    GameState *game = &ai->sim_game;
+    int missing = NUM_COMMUNITY - game->communitysize;
+    int live[NUM_DECK];
+    int num_live;
+    int count;
+    int stride;
+    Runout *runout;
+
+    ai->num_runouts = 0;
+
+    //Ranged opponents hold on to strong cards, so every runout is not equally likely
+    if (!ai->stratify || ai->num_ranged > 0 || game->handsize != NUM_HAND
+            || missing == 0 || missing > MAX_RUNOUT_CARDS)
+    {
+        return;
+    }
 
-    score = c1val + c2val;
+    num_live = GetLiveCards(game, live);
+    count = missing == 1 ? num_live : num_live * (num_live - 1) / 2;
+    if (count > MAX_RUNOUTS) return;
 
-    //Give bonuses to valued pairs and suited pairs
-    if (c1val == c2val)
+    //A stride with no common divisor visits every runout once per pass
+    stride = (int)(count * GOLDEN_RATIO_CONJUGATE + 0.5);
+    while (GreatestCommonDivisor(stride, count) != 1)
     {
-        score += 6;
+        stride++;
     }
-    else if (c1suit == c2suit)
+
+    //The n-th runout by turn card, then river card, goes n strides into the list
+    for (int i = 0; i < num_live; i++)
     {
-        score += 4;
+        if (missing == 1)
+        {
+            runout = &ai->runouts[(long long)ai->num_runouts++ * stride % count];
+            runout->cards[0] = live[i];
+            runout->mask = CardToMask(live[i]);
+            continue;
+        }
+
+        for (int j = i + 1; j < num_live; j++)
+        {
+            runout = &ai->runouts[(long long)ai->num_runouts++ * stride % count];
+            runout->cards[0] = live[i];
+            runout->cards[1] = live[j];
+            runout->mask = CardToMask(live[i]) | CardToMask(live[j]);
+        }
     }
 
-    //Lower the score of cards with a large value difference
-    if (diff > 4)
+    for (int i = 0; i < ai->num_threads; i++)
     {
-        score -= 4;
+        ai->tallies[i].next_runout = (int)((long long)i * count / ai->num_threads);
     }
-    else if (diff > 2)
+}
+
+/*
+ * Find the class of our final hand value
+ * ai: the AI whose classes were set by SetClassProbabilities
+ * value: our hand value, from the backend the workers simulate with
+ * return: the class index
+ */
+static inline
+int HandClass(PokerAI *ai, int value)
+{
+    int cls = 0;
+
+    //The last class whose lowest value is no higher than this one, found in
+    //a fixed number of conditional moves since the class is hard to predict
+    for (int step = NUM_HAND_CLASSES / 2; step > 0; step /= 2)
     {
-        score -= diff;
+        cls += (ai->class_floors[cls + step] <= value) ? step : 0;
     }
 
-    return score / 30.0;
+    return cls;
 }
 
 /*
- * Spawn Monte Carlo threads to simulate poker games
- * ai: the AI which should spawn the threads
+ * Order hand values for qsort
+ * a: the first value
+ * b: the second value
+ * return: negative, zero or positive as a is lower, equal or higher
  */
 static
-void SpawnMonteCarloThreads(PokerAI *ai)
+int CompareValues(const void *a, const void *b)
 {
-    if (ai->loglevel >= LOGLEVEL_DEBUG)
-    {
-        fprintf(ai->logfile, "Spawning Monte Carlo threads.\n");
-    }
+    int x = *(const int *)a;
+    int y = *(const int *)b;
 
-    //Spawn threads to perform Monte Carlo simulations
-    for (int i = 0; i < ai->num_threads; i++)
-    {
-        pthread_create(&ai->threads[i], NULL, SimulateGames, ai);
-    }
+    return (x > y) - (x < y);
+}
 
-    //Wait until each thread has finished simulating games
-    for (int i = 0; i < ai->num_threads; i++)
-    {
-        pthread_join(ai->threads[i], NULL);
-    }
+/*
+ * Find the greatest common divisor of two numbers
+ * return: the greatest common divisor of a and b
+ */
+static
+int GreatestCommonDivisor(int a, int b)
+{
+    int rest;
 
-    if (ai->loglevel >= LOGLEVEL_DEBUG)
+    while (b != 0)
     {
-        fprintf(ai->logfile, "All Monte Carlo threads finished.\n");
+        rest = a % b;
+        a = b;
+        b = rest;
     }
+
+    return a;
 }
 
 /*
- * Simulate games for the given AI
- * _ai: a void pointer to a PokerAI pointer
- * return: NULL (pthread requirement)
+ * Fill in the AI's decision thresholds for the given pot odds
+ * These must match the comparisons made in MakeDecision
+ * ai: the AI about to make a decision
+ * potodds: the pot odds of the decision
  */
 static
-void *SimulateGames(void *_ai)
+void SetDecisionThresholds(PokerAI *ai, double potodds)
 {
-    PokerAI *ai = (PokerAI *)_ai;
-    Timer timer;
-    int seed_index = GetNextFreeSeedIndex(ai);
+    static const double winprobs[] = {0.1, 0.5, 0.8, 0.85, 0.9, 0.95};
+    static const double gains[] = {0.8, 1.0, 1.3};
+    int n = 0;
 
-    if (ai->loglevel >= LOGLEVEL_DEBUG)
+    for (int i = 0; i < sizeof(winprobs) / sizeof(*winprobs); i++)
+    {
+        ai->thresholds[n++] = winprobs[i];
+    }
+
+    //expectedgain is winprob / potodds
+    for (int i = 0; i < sizeof(gains) / sizeof(*gains); i++)
     {
-        fprintf(ai->logfile, "[Thread %u] starting (obtained seed index %d)\n", THREAD_ID, seed_index);
+        ai->thresholds[n++] = gains[i] * potodds;
     }
 
-    int simulated = 0;
-    int won = 0;
+    ai->num_thresholds = n;
+}
 
-    StartTimer(&timer);
-    //Only check the timer after every 5 simulations
-    while (1)
+/*
+ * Evaluate the queries of a batch handed out to one worker
+ * _job: a void pointer to the BatchJob
+ * worker: the index of the pool worker
+ */
+static
+void RunBatchQueries(void *_job, int worker)
+{
+    BatchJob *job = (BatchJob *)_job;
+    PokerAI *ai = job->ai;
+    RandomState *rng = &ai->rngs[worker];
+    EquityQuery *query;
+    SimScratch scratch;
+    GameState game;
+    long long won;
+    long long simulated;
+    int index;
+
+    UseLocalHandRanks();
+
+    //Claim one query at a time so that slow spots do not hold up a whole worker's share
+    while ((index = __sync_fetch_and_add(&job->next, 1)) < job->num_queries)
     {
-        if (simulated % 1000 == 0 && GetElapsedTime(&timer) > ai->timeout)
+        query = &job->queries[index];
+        QueryGameState(query, &game);
+
+        if (game.communitysize == 0)
         {
-            break;
+            query->winprob = PreflopEquity(game.hand, game.num_playing);
+            continue;
         }
 
-        won += SimulateSingleGame(ai, seed_index);
-        simulated++;
-    }
+        if (CountDeals(&game) <= ai->enumerate_limit)
+        {
+            query->games_simulated = EnumerateDeals(&game, &query->games_won);
+        }
+        else
+        {
+            //Count locally, neighbouring queries may share a cache line,
+            //and top up whatever games the query was given from the cache
+            InitSimScratch(&game, ai->backend, &scratch);
+            won = query->games_won;
+            simulated = query->games_simulated;
+            for (; simulated < job->games; simulated++)
+            {
+                won += (SimulateSingleGame(&scratch, rng) > 0);
+            }
+            query->games_won = won;
+            query->games_simulated = simulated;
+        }
 
-    if (ai->loglevel >= LOGLEVEL_DEBUG)
-    {
-        fprintf(ai->logfile, "[Thread %u] done\t(simulated %d games)\n", THREAD_ID, simulated);
+        query->winprob = ((double) query->games_won) / query->games_simulated;
     }
+}
 
-    //Release our random seed
-    ReleaseSeedIndex(ai, seed_index);
-
-    //Lock the AI mutex and update the totals
-    pthread_mutex_lock(&ai->mutex);
-    ai->games_won += won;
-    ai->games_simulated += simulated;
-    pthread_mutex_unlock(&ai->mutex);
+/*
+ * Fill in a game state with the spot of a batch query
+ * query: the query to read
+ * game: the game state to fill in
+ */
+static
+void QueryGameState(EquityQuery *query, GameState *game)
+{
+    memcpy(game->hand, query->hand, sizeof(game->hand));
+    memcpy(game->community, query->community, sizeof(*game->community) * query->communitysize);
+    game->handsize = NUM_HAND;
+    game->communitysize = query->communitysize;
+    game->num_playing = query->num_playing;
+    game->num_opponents = 0;
+    UpdateGameDeck(game);
+}
 
-    return NULL;
+/*
+ * Fill in the parts of a worker's scratch buffers
+ * that stay the same for every simulated game
+ * game: the spot to simulate games for
+ * backend: the backend to simulate with (not SIM_BACKEND_AUTO)
+ * scratch: the worker's scratch buffers
+ */
+static
+void InitSimScratch(GameState *game, SimBackend backend, SimScratch *scratch)
+{
+    scratch->game = game;
+    scratch->num_live = GetLiveCards(game, scratch->live);
+
+    scratch->backend = backend;
+    scratch->live_mask = game->deck;
+    scratch->hand_mask = CardsToMask(game->hand, NUM_HAND);
+    scratch->known_mask = CardsToMask(game->community, game->communitysize);
+
+    //The known community cards are added to the board
+    //once here instead of once per player per game
+    memcpy(scratch->community, game->community, sizeof(*game->community) * game->communitysize);
+    StartBoard(&scratch->known_board);
+    AddBoardCards(&scratch->known_board, game->community, game->communitysize);
+
+    //Opponents are dealt uniformly unless the caller hands over ranges
+    scratch->ranges = NULL;
+    scratch->num_ranged = 0;
+
+    //The board is dealt at random unless the caller hands over runouts
+    scratch->runouts = NULL;
+    scratch->num_runouts = 0;
+    scratch->next_runout = 0;
 }
 
 /*
- * Simulate a single poker game for the given AI
- * ai: the poker AI to simulate games for
- * seed_index: which seed the thread will use for rand()
- * return: AI_WIN on AI win or AI_LOSE on AI lose
+ * Simulate a single poker game from a worker's spot
+ * scratch: the worker's scratch buffers, set up by InitSimScratch
+ * rng: the worker's random number generator
+ * return: 0 on AI lose, otherwise the number of players
+ * splitting the pot (1 on an outright AI win)
  */
 static
-int SimulateSingleGame(PokerAI *ai, int seed_index)
+int SimulateSingleGame(SimScratch *scratch, RandomState *rng)
 {
-    GameState *game = &ai->game;
-    int me[NUM_HAND + NUM_COMMUNITY];
-    int *opponents[MAX_OPPONENTS];
-    int community[NUM_COMMUNITY];
+    GameState *game = scratch->game;
+    int *deck = scratch->deck;
+    int *community = scratch->community;
+    int decksize = scratch->num_live;
+    BoardState board = scratch->known_board;
+    const Runout *runout;
+    CardMask dealt = 0;
     int myscore;
     int bestopponent;
-    int rand_num;
+    int ties;
 
-    for (int i = 0; i < game->num_playing; i++)
+    if (scratch->backend == SIM_BACKEND_MASK)
     {
-        opponents[i] = malloc(sizeof(*opponents[i]) * (NUM_HAND + NUM_COMMUNITY));
+        return SimulateSingleGameMasks(scratch, rng);
     }
 
-    //Create a deck as a randomized queue data structure
-    int deck[NUM_DECK] = {0};
-    int decksize = 0;
+    //Start from the prebuilt deck of live cards
+    memcpy(deck, scratch->live, sizeof(*deck) * decksize);
 
-    //Cards are 1 indexed
-    for (int i = 1; i < NUM_DECK; i++)
+    //Opponents with a range go first, the rest of the deal avoids their cards
+    if (scratch->num_ranged > 0)
     {
-        if (game->deck[i])
-        {
-            deck[decksize] = i;
-            decksize++;
-        }
+        dealt = DealRangedOpponents(scratch, rng);
     }
 
-    //Add the known community cards to the simulation community list
-    for (int i = 0; i < game->communitysize; i++)
+    //Distribute the rest of the community cards, or take the next runout and
+    //leave its cards in the deck to be thrown away if an opponent draws them
+    if (scratch->num_runouts > 0)
     {
-        community[i] = game->community[i];
+        runout = NextRunout(scratch);
+        memcpy(community + game->communitysize, runout->cards,
+                sizeof(*community) * (NUM_COMMUNITY - game->communitysize));
+        dealt |= runout->mask;
     }
-
-    //Distribute the rest of the community cards
-    for (int i = game->communitysize; i < NUM_COMMUNITY; i++)
+    else
     {
-        ai->seeds[seed_index] = rand_r((unsigned int *)&ai->seeds[seed_index]);
-        rand_num = ai->seeds[seed_index];
-        community[i] = draw(deck, &decksize, rand_num);
+        for (int i = game->communitysize; i < NUM_COMMUNITY; i++)
+        {
+            community[i] = DrawSimCard(rng, deck, &decksize, dealt);
+        }
     }
 
     //Give each opponent their cards
     for (int opp = 0; opp < game->num_playing; opp++)
     {
-        //Personal cards
+        if (scratch->num_ranged > 0 && !scratch->ranges[opp].uniform) continue;
+
         for (int i = 0; i < NUM_HAND; i++)
         {
-            ai->seeds[seed_index] = rand_r((unsigned int *)&ai->seeds[seed_index]);
-            rand_num = ai->seeds[seed_index];
-            opponents[opp][i] = draw(deck, &decksize, rand_num);
+            scratch->opponents[opp][i] = DrawSimCard(rng, deck, &decksize, dealt);
         }
+    }
 
-        //Community cards
-        for (int i = NUM_HAND; i < NUM_COMMUNITY + NUM_HAND; i++)
-        {
-            opponents[opp][i] = community[i - NUM_HAND];
-        }
+    //Every player shares the same board, so walk it only once
+    AddBoardCards(&board, community + game->communitysize,
+            NUM_COMMUNITY - game->communitysize);
+
+    //See who won
+    myscore = GetHandValueOnBoard(&board, game->hand);
+    bestopponent = BestHandOnBoard(&board, scratch->opponents, game->num_playing);
+    scratch->hero_value = myscore;
+
+    if (myscore != bestopponent)
+    {
+        return (myscore > bestopponent);
     }
 
-    //Put my cards into a new array
-    for (int i = 0; i < NUM_HAND; i++)
+    //Ties are rare enough to score the opponents again to count who shares the pot
+    ties = 1;
+    for (int opp = 0; opp < game->num_playing; opp++)
     {
-        me[i] = game->hand[i];
+        ties += (GetHandValueOnBoard(&board, scratch->opponents[opp]) == myscore);
     }
-    for (int i = NUM_HAND; i < NUM_HAND + NUM_COMMUNITY; i++)
+
+    return ties;
+}
+
+/*
+ * Take the next runout of a stratified simulation, starting the list
+ * over once every runout has been taken
+ * scratch: the worker's scratch buffers, with runouts
+ * return: the runout to deal
+ */
+static inline
+const Runout *NextRunout(SimScratch *scratch)
+{
+    const Runout *runout = &scratch->runouts[scratch->next_runout];
+
+    if (++scratch->next_runout == scratch->num_runouts)
     {
-        me[i] = community[i - NUM_HAND];
+        scratch->next_runout = 0;
     }
 
-    //See who won
-    myscore = GetHandValue(me, NUM_HAND + NUM_COMMUNITY);
-    bestopponent = BestOpponentHand(opponents, game->num_playing, NUM_HAND + NUM_COMMUNITY);
+    return runout;
+}
+
+/*
+ * Deal every opponent with a range their hand for one game
+ * scratch: the worker's scratch buffers, the hands are written to its opponents
+ * rng: the worker's random number generator
+ * return: the mask of the cards dealt
+ */
+static inline
+CardMask DealRangedOpponents(SimScratch *scratch, RandomState *rng)
+{
+    CardMask dealt = 0;
+    int combo;
 
-    //Free allocated memory
-    for (int i = 0; i < game->num_playing; i++)
+    for (int opp = 0; opp < scratch->game->num_playing; opp++)
     {
-        free(opponents[i]);
+        if (scratch->ranges[opp].uniform) continue;
+
+        combo = DealRangeHand(&scratch->ranges[opp], rng, dealt);
+        scratch->opponents[opp][0] = COMBO_CARDS[combo][0];
+        scratch->opponents[opp][1] = COMBO_CARDS[combo][1];
+        dealt |= COMBO_MASKS[combo];
     }
 
-    //Count ties as a win
-    return (myscore >= bestopponent);
+    return dealt;
 }
 
 /*
- * Randomly draw a card from the deck
- * and remove that card from the deck
+ * Draw a card from the deck that has not been dealt from a range
+ * rng: the worker's random number generator
  * deck: the deck to draw a card from
  * psize: a pointer to the size of the deck
- * rand_num: the random number to use in the draw
- * return: a random card from the deck
+ * dealt: the cards dealt from ranges in this game
+ * return: the card drawn
  */
-static
-int draw(int *deck, int *psize, int rand_num)
+static inline
+int DrawSimCard(RandomState *rng, int *deck, int *psize, CardMask dealt)
 {
-    int index = rand_num % *psize;
-    int value = deck[index];
-    deck[index] = deck[*psize - 1];
-    *psize -= 1;
+    int card;
 
-    return value;
+    //A dealt card is simply thrown away, it has left the deck anyway
+    do
+    {
+        card = DrawCard(rng, deck, psize);
+    } while (CardToMask(card) & dealt);
+
+    return card;
+}
+
+/*
+ * Deal a card for SimulateSingleGameMasks
+ * Selecting a card out of a mask is only quick with pdep, without it
+ * the card is drawn from the scratch deck and turned into a mask
+ * scratch: the worker's scratch buffers
+ * rng: the worker's random number generator
+ * deck: the live cards as a mask
+ * psize: a pointer to the number of live cards
+ * dealt: the cards dealt from ranges in this game, already taken out of deck
+ * return: the mask of the dealt card
+ */
+static inline
+CardMask DealSimMaskCard(SimScratch *scratch, RandomState *rng, CardMask *deck, int *psize, CardMask dealt)
+{
+#ifdef __BMI2__
+    return DealMaskCard(rng, deck, psize);
+#else
+    return CardToMask(DrawSimCard(rng, scratch->deck, psize, dealt));
+#endif
 }
 
 /*
- * Calculate the maximum opponent score
- * from the given list of opponent hands
- * opponents: an array of poker hands
- * numopponents: the number of opponents in the array
- * numcards: the size of each hand
- * return: the score of the best hand
+ * Simulate a single poker game from a worker's spot with card masks
+ * scratch: the worker's scratch buffers, set up by InitSimScratch
+ * rng: the worker's random number generator
+ * return: 0 on AI lose, otherwise the number of players
+ * splitting the pot (1 on an outright AI win)
  */
 static
-int BestOpponentHand(int **opponents, int numopponents, int numcards)
+int SimulateSingleGameMasks(SimScratch *scratch, RandomState *rng)
 {
-    int max = 0;
+    GameState *game = scratch->game;
+    CardMask deck = scratch->live_mask;
+    CardMask board = scratch->known_mask;
+    CardMask runout;
+    CardMask opponent;
+    CardMask dealt = 0;
+    int decksize = scratch->num_live;
+    int myscore;
+    int bestopponent = 0;
     int score;
-    for (int i = 0; i < numopponents; i++)
+    int ties = 1;
+
+#ifndef __BMI2__
+    memcpy(scratch->deck, scratch->live, sizeof(*scratch->deck) * decksize);
+#endif
+
+    //Opponents with a range go first, the rest of the deal avoids their cards
+    if (scratch->num_ranged > 0)
+    {
+        dealt = DealRangedOpponents(scratch, rng);
+#ifdef __BMI2__
+        deck &= ~dealt;
+        decksize -= NUM_HAND * scratch->num_ranged;
+#endif
+    }
+
+    //Distribute the rest of the community cards, or take the next runout
+    if (scratch->num_runouts > 0)
+    {
+        runout = NextRunout(scratch)->mask;
+        board |= runout;
+        dealt |= runout;
+#ifdef __BMI2__
+        deck &= ~runout;
+        decksize -= NUM_COMMUNITY - game->communitysize;
+#endif
+    }
+    else
     {
-        score = GetHandValue(opponents[i], numcards);
-        if (score > max)
+        for (int i = game->communitysize; i < NUM_COMMUNITY; i++)
+        {
+            board |= DealSimMaskCard(scratch, rng, &deck, &decksize, dealt);
+        }
+    }
+
+    //A hand is just the board with two more bits set
+    myscore = GetMaskHandValue(board | scratch->hand_mask);
+    for (int opp = 0; opp < game->num_playing; opp++)
+    {
+        if (scratch->num_ranged > 0 && !scratch->ranges[opp].uniform)
+        {
+            opponent = CardsToMask(scratch->opponents[opp], NUM_HAND);
+        }
+        else
         {
-            max = score;
+            opponent = DealSimMaskCard(scratch, rng, &deck, &decksize, dealt);
+            opponent |= DealSimMaskCard(scratch, rng, &deck, &decksize, dealt);
         }
+        score = GetMaskHandValue(board | opponent);
+        bestopponent = score > bestopponent ? score : bestopponent;
+        ties += (score == myscore);
+    }
+
+    scratch->hero_value = myscore;
+    if (myscore != bestopponent)
+    {
+        return (myscore > bestopponent);
+    }
+
+    return ties;
+}
+
+/*
+ * Time both simulation backends on a fixed spot
+ * and remember the faster one in FASTEST_BACKEND
+ */
+static
+void CalibrateSimBackend(void)
+{
+    //A flop against three opponents, close to a typical decision
+    int hand[] = {StringToCard("AH"), StringToCard("KD")};
+    int community[] = {StringToCard("2C"), StringToCard("7S"), StringToCard("9H")};
+    GameState game;
+
+    memcpy(game.hand, hand, sizeof(hand));
+    memcpy(game.community, community, sizeof(community));
+    game.handsize = NUM_HAND;
+    game.communitysize = 3;
+    game.num_playing = 3;
+    UpdateGameDeck(&game);
+
+    if (TimeSimBackend(&game, SIM_BACKEND_MASK) < TimeSimBackend(&game, SIM_BACKEND_TABLE))
+    {
+        FASTEST_BACKEND = SIM_BACKEND_MASK;
+    }
+    else
+    {
+        FASTEST_BACKEND = SIM_BACKEND_TABLE;
     }
+}
+
+/*
+ * Time single-threaded simulated games with one backend
+ * game: the spot to simulate
+ * backend: the backend to time
+ * return: the time taken in nanoseconds
+ */
+static
+double TimeSimBackend(GameState *game, SimBackend backend)
+{
+    SimScratch scratch;
+    RandomState rng;
+    struct timespec start;
+    struct timespec end;
+    volatile int won = 0;
+
+    InitSimScratch(game, backend, &scratch);
+    SeedRandom(&rng, CALIBRATION_GAMES);
+
+    //Warm up the caches (and the table's pages) before timing
+    for (int i = 0; i < CALIBRATION_GAMES / 10; i++)
+    {
+        won += (SimulateSingleGame(&scratch, &rng) > 0);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < CALIBRATION_GAMES; i++)
+    {
+        won += (SimulateSingleGame(&scratch, &rng) > 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
 
-    return max;
+    return (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
 }
 
 /*
@@ -635,6 +2281,7 @@ void MakeDecision(PokerAI *ai)
     //Don't bet too much on a bluff
     int bluffbet = randnum * maxbet / 100 / 2;
 
+    //Keep these thresholds in sync with SetDecisionThresholds
     if (expectedgain < 0.8 && winprob < 0.8)
     {
         if (randnum < 95)
@@ -720,40 +2367,3 @@ void MakeDecision(PokerAI *ai)
         ai->action.type = ACTION_CALL;
     }
 }
-
-/*
- * Get the next free seed index of the AI
- * ai: the AI to get the next seed index from
- * return: the next free seed index
- */
-static
-int GetNextFreeSeedIndex(PokerAI *ai)
-{
-    int index = -1;
-
-    pthread_mutex_lock(&ai->seed_mutex);
-
-    for (int i = 0; i < ai->num_threads; i++)
-    {
-        if (ai->seed_avail[i])
-        {
-            ai->seed_avail[i] = false;
-            index = i;
-            break;
-        }
-    }
-
-    pthread_mutex_unlock(&ai->seed_mutex);
-    return index;
-}
-
-/* Release a held seed index
- * ai: the AI to release the seed index to
- */
-static
-void ReleaseSeedIndex(PokerAI *ai, int index)
-{
-    pthread_mutex_lock(&ai->seed_mutex);
-    ai->seed_avail[index] = true;
-    pthread_mutex_unlock(&ai->seed_mutex);
-}
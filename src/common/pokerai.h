@@ -1,20 +1,92 @@
 #ifndef __POKER_AI_H__
 #define __POKER_AI_H__
 
+#include <limits.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "action.h"
+#include "cardmask.h"
+#include "enumerator.h"
+#include "equitycache.h"
 #include "evaluator.h"
 #include "gamestate.h"
+#include "preflop.h"
+#include "random.h"
+#include "range.h"
+#include "threadpool.h"
 #include "timer.h"
 
 #define NUM_RAISE_LIMIT     2
 #define SEED_COUNT          100
 
+//Spots with at most this many possible deals are solved exactly
+#define DEFAULT_ENUMERATE_LIMIT 2000000
+
+//Adaptive stopping: the z-score of the confidence interval (99%)
+//and how many games must be simulated before it is trusted
+#define STOP_CONFIDENCE_Z       2.576
+#define STOP_MIN_GAMES          10000
+
+//Win probabilities where MakeDecision can change its mind
+#define MAX_DECISION_THRESHOLDS 16
+
+//Games simulated for each query of a batch that is not enumerated
+#define DEFAULT_BATCH_GAMES     100000
+
+//Games timed for each backend when picking the faster one
+#define CALIBRATION_GAMES       20000
+
+//A game's pot is split into this many shares, which every number
+//of players from 1 to 11 can divide evenly
+#define TIE_SHARES              27720
+
+//Most classes our final hand value is split into, each about as likely as the others
+//A power of two, so HandClass can search them in a fixed number of steps
+#define NUM_HAND_CLASSES        32
+
+//Most community cards still to come for which the chance
+//of each of our final hand classes is worked out exactly
+#define MAX_CLASS_RUNOUT        2
+
+//Most community cards still to come for which the workers can take every
+//runout in turn, and the most runouts there can be, on the flop
+#define MAX_RUNOUT_CARDS        2
+#define MAX_RUNOUTS             1081 //(47 choose 2)
+
+//Consecutive runouts are this fraction of the list apart, which spreads
+//any number of them about as evenly over the list as possible
+#define GOLDEN_RATIO_CONJUGATE  0.6180339887
+
+//How win probabilities are estimated from simulated games
+//Flags may be combined with a bitwise or
+typedef enum estimateflags
+{
+    ESTIMATE_PLAIN          = 0,        //count the games won, ties count as wins
+    ESTIMATE_SPLIT_TIES     = 1 << 0,   //a tie wins a share of the pot split between the tied players
+    ESTIMATE_HAND_CLASSES   = 1 << 1    //weight the games by the exact chance of our final hand class
+} EstimateFlags;
+
+//The community cards still to come in one runout of a stratified simulation
+typedef struct runout
+{
+    int cards[MAX_RUNOUT_CARDS];
+    CardMask mask;
+} Runout;
+
+//How simulated games are dealt and evaluated
+typedef enum simbackend
+{
+    SIM_BACKEND_AUTO,   //time both backends once and use the faster one
+    SIM_BACKEND_TABLE,  //int cards walked through the loaded hand rank table
+    SIM_BACKEND_MASK    //card masks and GetMaskHandValue, no table needed
+} SimBackend;
+
 typedef enum loglevel
 {
     LOGLEVEL_NONE,
@@ -22,22 +94,107 @@ typedef enum loglevel
     LOGLEVEL_DEBUG
 } LOGLEVEL;
 
+//Games one worker has simulated for the current decision
+//Each tally fills its own cache line and is only written by its worker,
+//so any thread can add them up while the workers are running
+typedef struct workertally
+{
+    long long won;
+    long long simulated;
+
+    //The NUMA node the worker ran on
+    int node;
+
+    //With an estimator, the games and pot shares (out of TIE_SHARES
+    //a game) won with each of our final hand classes
+    long long class_games[NUM_HAND_CLASSES];
+    long long class_shares[NUM_HAND_CLASSES];
+
+    //The runout the worker takes next when stratifying
+    int next_runout;
+} __attribute__((aligned(CACHE_LINE_SIZE))) WorkerTally;
+
 typedef struct pokerai
 {
     //Worker threads
-    pthread_mutex_t mutex;
-    pthread_t *threads;
+    ThreadPool *pool;
     int num_threads;
     int timeout;
 
-    //Random seeds for worker threads
-    pthread_mutex_t seed_mutex;
-    bool *seed_avail;
-    int *seeds;
+    //Largest number of deals to enumerate instead of sampling
+    long long enumerate_limit;
+
+    //Adaptive stopping: workers stop once the confidence interval
+    //is narrower than target_error either side of the estimate,
+    //or no longer contains any decision threshold (0 disables)
+    double target_error;
+    double thresholds[MAX_DECISION_THRESHOLDS];
+    int num_thresholds;
 
-    //Scoring
-    int games_won;
-    int games_simulated;
+    //Raised once the workers should stop, polled by them after every game
+    bool stop_simulating;
+
+    //How long the last simulation ran past its timeout
+    //before every worker had stopped, in nanoseconds
+    unsigned long long stop_overshoot;
+
+    //Random number generators for worker threads, indexed by worker
+    RandomState *rngs;
+
+    //Running totals of the current simulation, indexed by worker
+    WorkerTally *tallies;
+
+    //Games simulated on each NUMA node during the last decision
+    long long node_games[MAX_NUMA_NODES];
+
+    //How the workers deal and evaluate simulated games
+    SimBackend backend;
+
+    //Scoring, filled in once the workers have finished
+    long long games_won;
+    long long games_simulated;
+
+    //How win probabilities are estimated, a combination of EstimateFlags
+    int estimator;
+
+    //The exact chance of each of our final hand classes in sim_game and
+    //the lowest hand value in each, or a single class when the games are not
+    //told apart by class
+    double class_probs[NUM_HAND_CLASSES];
+    int class_floors[NUM_HAND_CLASSES];
+    int num_classes;
+
+    //How many games counted plainly the last win probability is as precise as
+    double effective_games;
+
+    //Speculation: the workers simulate the current spot in the background
+    //while waiting for our turn, and the decision carries their games over
+    bool speculate;
+    bool speculating;
+
+    //The spot the workers simulate, and whether the tallies hold its games
+    GameState sim_game;
+    bool sim_valid;
+
+    //Games carried over into the last decision from earlier runs or the cache
+    long long speculated_games;
+
+    //Opponent ranges: opponents who have bet are dealt hands weighted
+    //by their betting instead of uniformly random hands
+    bool model_ranges;
+
+    //The range of each playing opponent of sim_game, and how many are not uniform
+    HandRange *ranges;
+    int num_ranged;
+
+    //Stratified runouts: the workers take every way the rest of the board can come
+    //in turn, in a low-discrepancy order, and only deal the opponents at random
+    bool stratify;
+    Runout *runouts;
+    int num_runouts;
+
+    //Games simulated for earlier spots, owned by the caller (may be NULL)
+    EquityCache *cache;
 
     //Current game state
     GameState game;
@@ -54,6 +211,20 @@ typedef struct pokerai
     //TODO
 } PokerAI;
 
+//One spot of a batch of win probability queries
+typedef struct equityquery
+{
+    int hand[NUM_HAND];
+    int community[NUM_COMMUNITY];
+    int communitysize;
+    int num_playing;
+
+    //Filled in by GetWinProbabilities
+    double winprob;
+    long long games_won;
+    long long games_simulated;
+} EquityQuery;
+
 /*
  * Create a new PokerAI
  *
@@ -62,6 +233,15 @@ typedef struct pokerai
  */
 PokerAI *CreatePokerAI(int timeout);
 
+/*
+ * Create a new PokerAI with the given number of worker threads
+ *
+ * timeout: how long (in milliseconds) each thread may simulate games
+ * num_threads: the number of Monte Carlo workers
+ * return a new PokerAI
+ */
+PokerAI *CreatePokerAIWithThreads(int timeout, int num_threads);
+
 /*
  * Destroy the PokerAI and all associated memory
  * ai: the PokerAI to destroy
@@ -77,6 +257,102 @@ void DestroyPokerAI(PokerAI *ai);
  */
 void SetLogging(PokerAI *ai, LOGLEVEL level, FILE *file);
 
+/*
+ * Set the largest spot the AI will solve by exact enumeration
+ * Spots with more possible deals are sampled with Monte Carlo simulation
+ * ai: the AI to configure
+ * limit: the maximum number of deals to enumerate (0 disables enumeration)
+ */
+void SetEnumerateLimit(PokerAI *ai, long long limit);
+
+/*
+ * Pin each of the AI's workers to its own CPU, or let them float again
+ * Pinned workers stay on one NUMA node, so with a table loaded
+ * with LOAD_REPLICATE each one only ever reads its local copy
+ * ai: the AI to configure
+ * pin: true to pin the workers, false to allow every CPU again
+ * return: true if every worker's affinity was set
+ */
+bool SetWorkerPinning(PokerAI *ai, bool pin);
+
+/*
+ * Choose how the AI deals and evaluates simulated games
+ * Exact enumeration always walks the hand rank table
+ * ai: the AI to configure
+ * backend: the backend to simulate with, SIM_BACKEND_AUTO
+ * picks whichever is faster on this machine
+ */
+void SetSimBackend(PokerAI *ai, SimBackend backend);
+
+/*
+ * Let the AI stop simulating before the timeout once its estimate is good enough
+ * The timeout remains an upper bound on the simulation time
+ * ai: the AI to configure
+ * target_error: the largest acceptable half-width of the 99% confidence
+ * interval on the win probability (0 disables adaptive stopping)
+ */
+void SetTargetError(PokerAI *ai, double target_error);
+
+/*
+ * Choose how the AI estimates win probabilities from simulated games
+ * ESTIMATE_HAND_CLASSES only applies when at most MAX_CLASS_RUNOUT
+ * community cards are to come and no opponent is ranged, and spots
+ * are not cached while any estimator is set
+ * ESTIMATE_SPLIT_TIES also simulates preflop spots, since the preflop
+ * table counts ties as wins
+ * ai: the AI to configure
+ * flags: a combination of EstimateFlags (ESTIMATE_PLAIN by default)
+ */
+void SetEstimator(PokerAI *ai, int flags);
+
+/*
+ * Model what each opponent holds from their betting this hand
+ * Opponents who have committed a large share of their stack are dealt
+ * stronger hands, so the AI simulates every spot where anyone has,
+ * including preflop and spots small enough to enumerate
+ * ai: the AI to configure
+ * model: true to deal from ranges, false to deal every hand uniformly
+ */
+void SetRangeModeling(PokerAI *ai, bool model);
+
+/*
+ * Stratify simulated games by their runout: with at most MAX_RUNOUT_CARDS
+ * community cards to come, each worker takes every turn and river in turn
+ * instead of dealing them at random, so no runout is repeated before every
+ * other has come up, and only the opponents' hands are left to chance
+ * Spots where an opponent is dealt from a range are still dealt at random
+ * ai: the AI to configure
+ * stratify: true to take every runout in turn, false to deal them at random
+ */
+void SetStratifiedRunouts(PokerAI *ai, bool stratify);
+
+/*
+ * Give the AI a cache of simulated spots to start from and add to
+ * Every simulated spot with no ranged opponents first looks up the games
+ * cached for it and tops them up, then stores the new totals
+ * ai: the AI to configure
+ * cache: the cache to use, which the caller keeps ownership of (NULL for none)
+ */
+void SetEquityCache(PokerAI *ai, EquityCache *cache);
+
+/*
+ * Let the AI simulate the current spot in the background while it waits for its turn
+ * Game states that are not the AI's turn start the workers on their spot,
+ * and GetWinProbability keeps every game simulated since the spot last changed
+ * ai: the AI to configure
+ * speculate: true to speculate, false to stop any running speculation
+ */
+void SetSpeculation(PokerAI *ai, bool speculate);
+
+/*
+ * Start refining the win probability of the current spot in the background
+ * Does nothing if the workers are already simulating this spot, or if the
+ * spot is looked up or enumerated instead of simulated
+ * Called by UpdateGameState when speculation is enabled
+ * ai: the AI whose spot should be simulated
+ */
+void SpeculateWinProbability(PokerAI *ai);
+
 /*
  * Update the given PokerAI's game state
  * ai: the PokerAI to update
@@ -84,6 +360,16 @@ void SetLogging(PokerAI *ai, LOGLEVEL level, FILE *file);
  */
 void UpdateGameState(PokerAI *ai, cJSON *new_state);
 
+/*
+ * Update the given PokerAI's game state from the text of a JSON game state
+ * Faster than parsing the text with cJSON and calling UpdateGameState
+ * ai: the PokerAI to update
+ * text: the JSON text of the new game state
+ * return: true if the text was a well formed game state, the AI keeps
+ * its last game state otherwise
+ */
+bool UpdateGameStateFromText(PokerAI *ai, const char *text);
+
 /*
  * Manually set the AI's hand cards
  * ai: the pokerAI to update
@@ -121,6 +407,30 @@ char *GetBestAction(PokerAI *ai);
  */
 double GetWinProbability(PokerAI *ai);
 
+/*
+ * Read the running totals of the current simulation without waiting for it
+ * Safe to call from any thread while GetWinProbability is simulating;
+ * the workers are never blocked, and each publishes its totals every 1000 games
+ * ai: the AI that is simulating
+ * won: where to store the games won so far (may be NULL)
+ * simulated: where to store the games simulated so far (may be NULL)
+ * return: the running win probability, or 0 if no games have been published
+ */
+double GetSimulationProgress(PokerAI *ai, long long *won, long long *simulated);
+
+/*
+ * Determine the win probability of many spots in one call
+ * Spots are handed to the AI's workers one at a time and each is
+ * looked up, enumerated or simulated just like GetWinProbability would,
+ * except that simulated spots run a fixed number of games instead of a timeout
+ * With a cache, simulated spots only simulate the games their cached results are short of
+ * ai: the AI whose workers and enumerate limit are used
+ * queries: the spots to evaluate, the results are written back into them
+ * num_queries: the number of spots
+ * games: how many games to simulate for each spot that is not enumerated
+ */
+void GetWinProbabilities(PokerAI *ai, EquityQuery *queries, int num_queries, long long games);
+
 /*
  * Print the AI's decision to the given FILE
  * ai: the AI that is making the decision
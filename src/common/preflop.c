@@ -0,0 +1,47 @@
+#include "preflop.h"
+
+/*
+ * Get the starting hand class of the given hole cards
+ * Classes form a 13x13 grid of ranks (0 == deuce, 12 == ace):
+ * pairs on the diagonal, suited hands at [high][low]
+ * and offsuit hands at [low][high]
+ * hand: the two hole cards
+ * return: the class index in [0, NUM_PREFLOP_CLASSES)
+ */
+int PreflopClass(int *hand)
+{
+    //Cards are 1 indexed, four suits per rank
+    int c1val  = (hand[0] - 1) / 4;
+    int c2val  = (hand[1] - 1) / 4;
+    int c1suit = (hand[0] - 1) % 4;
+    int c2suit = (hand[1] - 1) % 4;
+    int high = c1val > c2val ? c1val : c2val;
+    int low  = c1val > c2val ? c2val : c1val;
+
+    if (c1suit == c2suit)
+    {
+        return high * NUM_RANKS + low;
+    }
+
+    return low * NUM_RANKS + high;
+}
+
+/*
+ * Look up the all-in win probability of the given hole cards
+ * hand: the two hole cards
+ * num_opponents: the number of opponents still in the hand
+ * return: the win probability as a double in the range [0, 1]
+ */
+double PreflopEquity(int *hand, int num_opponents)
+{
+    //Nobody left to beat
+    if (num_opponents < 1) return 1.0;
+
+    //The table stops at a full ring game
+    if (num_opponents > MAX_PREFLOP_OPPONENTS)
+    {
+        num_opponents = MAX_PREFLOP_OPPONENTS;
+    }
+
+    return PREFLOP_EQUITY[PreflopClass(hand)][num_opponents - 1];
+}
@@ -0,0 +1,33 @@
+#ifndef __PREFLOP_H__
+#define __PREFLOP_H__
+
+#include "gamestate.h"
+
+#define NUM_RANKS               13
+#define NUM_PREFLOP_CLASSES     (NUM_RANKS * NUM_RANKS)
+#define MAX_PREFLOP_OPPONENTS   9
+
+//Win probability (ties count as wins) of every starting hand class
+//against 1 to MAX_PREFLOP_OPPONENTS random hands, generated by bin/preflopgen
+//Rows are indexed by PreflopClass, columns by the number of opponents - 1
+extern const float PREFLOP_EQUITY[NUM_PREFLOP_CLASSES][MAX_PREFLOP_OPPONENTS];
+
+/*
+ * Get the starting hand class of the given hole cards
+ * Classes form a 13x13 grid of ranks (0 == deuce, 12 == ace):
+ * pairs on the diagonal, suited hands at [high][low]
+ * and offsuit hands at [low][high]
+ * hand: the two hole cards
+ * return: the class index in [0, NUM_PREFLOP_CLASSES)
+ */
+int PreflopClass(int *hand);
+
+/*
+ * Look up the all-in win probability of the given hole cards
+ * hand: the two hole cards
+ * num_opponents: the number of opponents still in the hand
+ * return: the win probability as a double in the range [0, 1]
+ */
+double PreflopEquity(int *hand, int num_opponents);
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * Generated by bin/preflopgen with 1000000 games per entry -- do not edit
+ * Heads up entries are exact
+ * Win probability (ties count as wins) of each starting hand class
+ * against 1 to 9 random opponents
+ */
+#include "preflop.h"
+
+const float PREFLOP_EQUITY[NUM_PREFLOP_CLASSES][MAX_PREFLOP_OPPONENTS] =
+{
+    /* 22  */ {0.5128f, 0.3134f, 0.2255f, 0.1823f, 0.1595f, 0.1446f, 0.1352f, 0.1279f, 0.1214f},
+    /* 32o */ {0.3537f, 0.2159f, 0.1536f, 0.1204f, 0.0996f, 0.0861f, 0.0765f, 0.0694f, 0.0637f},
+    /* 42o */ {0.3628f, 0.2260f, 0.1628f, 0.1274f, 0.1069f, 0.0924f, 0.0833f, 0.0752f, 0.0696f},
+    /* 52o */ {0.3738f, 0.2341f, 0.1698f, 0.1340f, 0.1122f, 0.0980f, 0.0874f, 0.0793f, 0.0735f},
+    /* 62o */ {0.3707f, 0.2280f, 0.1627f, 0.1263f, 0.1031f, 0.0880f, 0.0783f, 0.0697f, 0.0634f},
+    /* 72o */ {0.3746f, 0.2243f, 0.1581f, 0.1210f, 0.0982f, 0.0834f, 0.0727f, 0.0647f, 0.0582f},
+    /* 82o */ {0.3957f, 0.2375f, 0.1683f, 0.1284f, 0.1048f, 0.0875f, 0.0759f, 0.0673f, 0.0604f},
+    /* 92o */ {0.4168f, 0.2507f, 0.1780f, 0.1371f, 0.1109f, 0.0932f, 0.0803f, 0.0708f, 0.0635f},
+    /* T2o */ {0.4410f, 0.2680f, 0.1910f, 0.1486f, 0.1212f, 0.1024f, 0.0895f, 0.0793f, 0.0711f},
+    /* J2o */ {0.4665f, 0.2853f, 0.2041f, 0.1579f, 0.1288f, 0.1093f, 0.0944f, 0.0834f, 0.0748f},
+    /* Q2o */ {0.4948f, 0.3074f, 0.2206f, 0.1709f, 0.1407f, 0.1185f, 0.1025f, 0.0899f, 0.0807f},
+    /* K2o */ {0.5259f, 0.3333f, 0.2409f, 0.1881f, 0.1544f, 0.1324f, 0.1142f, 0.1001f, 0.0897f},
+    /* A2o */ {0.5691f, 0.3741f, 0.2757f, 0.2190f, 0.1820f, 0.1553f, 0.1355f, 0.1199f, 0.1068f},
+    /* 32s */ {0.3888f, 0.2563f, 0.1956f, 0.1613f, 0.1405f, 0.1259f, 0.1148f, 0.1064f, 0.0996f},
+    /* 33  */ {0.5455f, 0.3429f, 0.2451f, 0.1942f, 0.1672f, 0.1497f, 0.1387f, 0.1295f, 0.1237f},
+    /* 43o */ {0.3823f, 0.2449f, 0.1803f, 0.1427f, 0.1196f, 0.1044f, 0.0937f, 0.0850f, 0.0785f},
+    /* 53o */ {0.3936f, 0.2545f, 0.1891f, 0.1509f, 0.1268f, 0.1115f, 0.1005f, 0.0919f, 0.0854f},
+    /* 63o */ {0.3909f, 0.2476f, 0.1806f, 0.1422f, 0.1177f, 0.1027f, 0.0907f, 0.0824f, 0.0750f},
+    /* 73o */ {0.3949f, 0.2445f, 0.1760f, 0.1375f, 0.1122f, 0.0965f, 0.0843f, 0.0754f, 0.0681f},
+    /* 83o */ {0.4022f, 0.2441f, 0.1734f, 0.1338f, 0.1083f, 0.0915f, 0.0795f, 0.0708f, 0.0636f},
+    /* 93o */ {0.4261f, 0.2594f, 0.1855f, 0.1422f, 0.1148f, 0.0977f, 0.0844f, 0.0744f, 0.0667f},
+    /* T3o */ {0.4503f, 0.2768f, 0.1993f, 0.1544f, 0.1260f, 0.1067f, 0.0926f, 0.0823f, 0.0739f},
+    /* J3o */ {0.4758f, 0.2945f, 0.2113f, 0.1643f, 0.1347f, 0.1134f, 0.0985f, 0.0871f, 0.0775f},
+    /* Q3o */ {0.5041f, 0.3156f, 0.2277f, 0.1774f, 0.1449f, 0.1222f, 0.1062f, 0.0932f, 0.0835f},
+    /* K3o */ {0.5352f, 0.3427f, 0.2484f, 0.1944f, 0.1601f, 0.1358f, 0.1179f, 0.1036f, 0.0928f},
+    /* A3o */ {0.5783f, 0.3848f, 0.2841f, 0.2266f, 0.1892f, 0.1628f, 0.1421f, 0.1251f, 0.1116f},
+    /* 42s */ {0.3974f, 0.2645f, 0.2028f, 0.1685f, 0.1466f, 0.1320f, 0.1208f, 0.1122f, 0.1046f},
+    /* 43s */ {0.4156f, 0.2828f, 0.2197f, 0.1819f, 0.1588f, 0.1426f, 0.1307f, 0.1214f, 0.1143f},
+    /* 44  */ {0.5779f, 0.3743f, 0.2680f, 0.2107f, 0.1767f, 0.1565f, 0.1438f, 0.1328f, 0.1256f},
+    /* 54o */ {0.4124f, 0.2740f, 0.2063f, 0.1657f, 0.1402f, 0.1239f, 0.1111f, 0.1026f, 0.0947f},
+    /* 64o */ {0.4102f, 0.2675f, 0.1989f, 0.1588f, 0.1340f, 0.1162f, 0.1039f, 0.0948f, 0.0868f},
+    /* 74o */ {0.4144f, 0.2656f, 0.1958f, 0.1548f, 0.1281f, 0.1106f, 0.0977f, 0.0877f, 0.0801f},
+    /* 84o */ {0.4218f, 0.2647f, 0.1919f, 0.1497f, 0.1230f, 0.1038f, 0.0915f, 0.0813f, 0.0744f},
+    /* 94o */ {0.4326f, 0.2660f, 0.1901f, 0.1481f, 0.1206f, 0.1012f, 0.0876f, 0.0774f, 0.0696f},
+    /* T4o */ {0.4595f, 0.2863f, 0.2063f, 0.1604f, 0.1303f, 0.1117f, 0.0966f, 0.0857f, 0.0768f},
+    /* J4o */ {0.4850f, 0.3030f, 0.2188f, 0.1707f, 0.1396f, 0.1175f, 0.1024f, 0.0902f, 0.0809f},
+    /* Q4o */ {0.5133f, 0.3252f, 0.2366f, 0.1842f, 0.1507f, 0.1278f, 0.1097f, 0.0972f, 0.0865f},
+    /* K4o */ {0.5443f, 0.3523f, 0.2558f, 0.2014f, 0.1660f, 0.1404f, 0.1222f, 0.1078f, 0.0964f},
+    /* A4o */ {0.5873f, 0.3941f, 0.2935f, 0.2340f, 0.1952f, 0.1672f, 0.1462f, 0.1296f, 0.1165f},
+    /* 52s */ {0.4077f, 0.2736f, 0.2108f, 0.1739f, 0.1522f, 0.1368f, 0.1245f, 0.1165f, 0.1084f},
+    /* 53s */ {0.4263f, 0.2912f, 0.2270f, 0.1899f, 0.1655f, 0.1494f, 0.1369f, 0.1274f, 0.1196f},
+    /* 54s */ {0.4437f, 0.3101f, 0.2431f, 0.2043f, 0.1788f, 0.1609f, 0.1471f, 0.1370f, 0.1288f},
+    /* 55  */ {0.6101f, 0.4055f, 0.2940f, 0.2303f, 0.1905f, 0.1653f, 0.1500f, 0.1381f, 0.1284f},
+    /* 65o */ {0.4288f, 0.2866f, 0.2170f, 0.1741f, 0.1469f, 0.1284f, 0.1151f, 0.1051f, 0.0978f},
+    /* 75o */ {0.4335f, 0.2854f, 0.2147f, 0.1714f, 0.1432f, 0.1237f, 0.1109f, 0.1002f, 0.0927f},
+    /* 85o */ {0.4411f, 0.2846f, 0.2115f, 0.1666f, 0.1384f, 0.1189f, 0.1052f, 0.0945f, 0.0856f},
+    /* 95o */ {0.4520f, 0.2857f, 0.2101f, 0.1642f, 0.1350f, 0.1141f, 0.0997f, 0.0885f, 0.0803f},
+    /* T5o */ {0.4664f, 0.2915f, 0.2118f, 0.1664f, 0.1361f, 0.1153f, 0.1007f, 0.0899f, 0.0802f},
+    /* J5o */ {0.4946f, 0.3128f, 0.2267f, 0.1769f, 0.1455f, 0.1232f, 0.1068f, 0.0937f, 0.0841f},
+    /* Q5o */ {0.5228f, 0.3354f, 0.2436f, 0.1904f, 0.1569f, 0.1322f, 0.1143f, 0.1003f, 0.0898f},
+    /* K5o */ {0.5537f, 0.3629f, 0.2656f, 0.2083f, 0.1720f, 0.1457f, 0.1266f, 0.1115f, 0.0993f},
+    /* A5o */ {0.5965f, 0.4040f, 0.3027f, 0.2418f, 0.2014f, 0.1724f, 0.1512f, 0.1337f, 0.1197f},
+    /* 62s */ {0.4050f, 0.2668f, 0.2023f, 0.1669f, 0.1436f, 0.1276f, 0.1161f, 0.1076f, 0.1004f},
+    /* 63s */ {0.4238f, 0.2854f, 0.2210f, 0.1822f, 0.1574f, 0.1406f, 0.1283f, 0.1188f, 0.1109f},
+    /* 64s */ {0.4419f, 0.3042f, 0.2371f, 0.1975f, 0.1717f, 0.1540f, 0.1408f, 0.1307f, 0.1217f},
+    /* 65s */ {0.4592f, 0.3216f, 0.2538f, 0.2123f, 0.1844f, 0.1655f, 0.1513f, 0.1411f, 0.1313f},
+    /* 66  */ {0.6387f, 0.4373f, 0.3210f, 0.2496f, 0.2047f, 0.1773f, 0.1589f, 0.1450f, 0.1354f},
+    /* 76o */ {0.4499f, 0.3037f, 0.2313f, 0.1863f, 0.1563f, 0.1357f, 0.1205f, 0.1092f, 0.1011f},
+    /* 86o */ {0.4579f, 0.3043f, 0.2288f, 0.1837f, 0.1530f, 0.1317f, 0.1170f, 0.1056f, 0.0964f},
+    /* 96o */ {0.4688f, 0.3061f, 0.2281f, 0.1814f, 0.1500f, 0.1276f, 0.1120f, 0.1000f, 0.0910f},
+    /* T6o */ {0.4834f, 0.3117f, 0.2303f, 0.1821f, 0.1503f, 0.1280f, 0.1116f, 0.0990f, 0.0893f},
+    /* J6o */ {0.4998f, 0.3189f, 0.2327f, 0.1816f, 0.1496f, 0.1264f, 0.1092f, 0.0965f, 0.0868f},
+    /* Q6o */ {0.5305f, 0.3433f, 0.2518f, 0.1970f, 0.1618f, 0.1370f, 0.1177f, 0.1035f, 0.0925f},
+    /* K6o */ {0.5615f, 0.3702f, 0.2728f, 0.2152f, 0.1773f, 0.1499f, 0.1302f, 0.1145f, 0.1023f},
+    /* A6o */ {0.5949f, 0.4004f, 0.2962f, 0.2339f, 0.1936f, 0.1651f, 0.1440f, 0.1272f, 0.1140f},
+    /* 72s */ {0.4087f, 0.2648f, 0.1999f, 0.1632f, 0.1398f, 0.1233f, 0.1117f, 0.1027f, 0.0954f},
+    /* 73s */ {0.4277f, 0.2825f, 0.2169f, 0.1776f, 0.1529f, 0.1353f, 0.1225f, 0.1133f, 0.1050f},
+    /* 74s */ {0.4459f, 0.3018f, 0.2344f, 0.1933f, 0.1671f, 0.1485f, 0.1345f, 0.1239f, 0.1166f},
+    /* 75s */ {0.4637f, 0.3208f, 0.2510f, 0.2095f, 0.1813f, 0.1618f, 0.1477f, 0.1365f, 0.1276f},
+    /* 76s */ {0.4791f, 0.3385f, 0.2664f, 0.2229f, 0.1933f, 0.1716f, 0.1569f, 0.1456f, 0.1358f},
+    /* 77  */ {0.6675f, 0.4694f, 0.3496f, 0.2719f, 0.2232f, 0.1911f, 0.1689f, 0.1529f, 0.1414f},
+    /* 87o */ {0.4741f, 0.3239f, 0.2477f, 0.2010f, 0.1672f, 0.1445f, 0.1283f, 0.1155f, 0.1056f},
+    /* 97o */ {0.4852f, 0.3249f, 0.2474f, 0.1989f, 0.1661f, 0.1428f, 0.1250f, 0.1125f, 0.1025f},
+    /* T7o */ {0.4999f, 0.3322f, 0.2504f, 0.2002f, 0.1669f, 0.1431f, 0.1256f, 0.1126f, 0.1018f},
+    /* J7o */ {0.5164f, 0.3385f, 0.2523f, 0.2004f, 0.1652f, 0.1401f, 0.1213f, 0.1077f, 0.0969f},
+    /* Q7o */ {0.5363f, 0.3504f, 0.2582f, 0.2032f, 0.1675f, 0.1414f, 0.1223f, 0.1073f, 0.0955f},
+    /* K7o */ {0.5696f, 0.3795f, 0.2821f, 0.2224f, 0.1841f, 0.1553f, 0.1347f, 0.1188f, 0.1050f},
+    /* A7o */ {0.6051f, 0.4124f, 0.3089f, 0.2453f, 0.2021f, 0.1725f, 0.1495f, 0.1320f, 0.1166f},
+    /* 82s */ {0.4286f, 0.2782f, 0.2092f, 0.1706f, 0.1453f, 0.1286f, 0.1161f, 0.1061f, 0.0976f},
+    /* 83s */ {0.4346f, 0.2832f, 0.2143f, 0.1743f, 0.1495f, 0.1315f, 0.1191f, 0.1085f, 0.1007f},
+    /* 84s */ {0.4530f, 0.3011f, 0.2313f, 0.1891f, 0.1628f, 0.1436f, 0.1304f, 0.1191f, 0.1105f},
+    /* 85s */ {0.4710f, 0.3208f, 0.2490f, 0.2062f, 0.1774f, 0.1571f, 0.1427f, 0.1310f, 0.1215f},
+    /* 86s */ {0.4867f, 0.3388f, 0.2658f, 0.2218f, 0.1905f, 0.1697f, 0.1541f, 0.1418f, 0.1316f},
+    /* 87s */ {0.5019f, 0.3556f, 0.2835f, 0.2354f, 0.2037f, 0.1809f, 0.1637f, 0.1508f, 0.1399f},
+    /* 88  */ {0.6961f, 0.5037f, 0.3806f, 0.2999f, 0.2450f, 0.2071f, 0.1827f, 0.1631f, 0.1493f},
+    /* 98o */ {0.5013f, 0.3451f, 0.2666f, 0.2161f, 0.1814f, 0.1566f, 0.1371f, 0.1224f, 0.1119f},
+    /* T8o */ {0.5162f, 0.3525f, 0.2701f, 0.2194f, 0.1854f, 0.1599f, 0.1403f, 0.1262f, 0.1151f},
+    /* J8o */ {0.5327f, 0.3586f, 0.2728f, 0.2189f, 0.1833f, 0.1567f, 0.1367f, 0.1213f, 0.1096f},
+    /* Q8o */ {0.5527f, 0.3708f, 0.2785f, 0.2221f, 0.1844f, 0.1571f, 0.1361f, 0.1201f, 0.1068f},
+    /* K8o */ {0.5761f, 0.3878f, 0.2893f, 0.2298f, 0.1904f, 0.1620f, 0.1399f, 0.1232f, 0.1091f},
+    /* A8o */ {0.6137f, 0.4234f, 0.3182f, 0.2537f, 0.2108f, 0.1791f, 0.1555f, 0.1369f, 0.1214f},
+    /* 92s */ {0.4486f, 0.2898f, 0.2188f, 0.1793f, 0.1522f, 0.1345f, 0.1207f, 0.1101f, 0.1013f},
+    /* 93s */ {0.4572f, 0.2972f, 0.2253f, 0.1836f, 0.1568f, 0.1378f, 0.1238f, 0.1131f, 0.1044f},
+    /* 94s */ {0.4632f, 0.3039f, 0.2311f, 0.1884f, 0.1597f, 0.1418f, 0.1269f, 0.1163f, 0.1073f},
+    /* 95s */ {0.4813f, 0.3226f, 0.2474f, 0.2037f, 0.1742f, 0.1541f, 0.1381f, 0.1259f, 0.1170f},
+    /* 96s */ {0.4971f, 0.3406f, 0.2663f, 0.2192f, 0.1884f, 0.1656f, 0.1503f, 0.1367f, 0.1279f},
+    /* 97s */ {0.5125f, 0.3593f, 0.2832f, 0.2361f, 0.2028f, 0.1797f, 0.1616f, 0.1485f, 0.1380f},
+    /* 98s */ {0.5275f, 0.3769f, 0.3016f, 0.2515f, 0.2163f, 0.1923f, 0.1733f, 0.1583f, 0.1472f},
+    /* 99  */ {0.7245f, 0.5403f, 0.4170f, 0.3314f, 0.2718f, 0.2287f, 0.1991f, 0.1766f, 0.1603f},
+    /* T9o */ {0.5325f, 0.3743f, 0.2925f, 0.2414f, 0.2046f, 0.1777f, 0.1575f, 0.1415f, 0.1290f},
+    /* J9o */ {0.5486f, 0.3805f, 0.2945f, 0.2404f, 0.2024f, 0.1749f, 0.1537f, 0.1367f, 0.1237f},
+    /* Q9o */ {0.5686f, 0.3919f, 0.3004f, 0.2435f, 0.2041f, 0.1752f, 0.1526f, 0.1351f, 0.1214f},
+    /* K9o */ {0.5922f, 0.4090f, 0.3110f, 0.2505f, 0.2101f, 0.1795f, 0.1561f, 0.1374f, 0.1224f},
+    /* A9o */ {0.6210f, 0.4325f, 0.3283f, 0.2623f, 0.2193f, 0.1867f, 0.1631f, 0.1433f, 0.1271f},
+    /* T2s */ {0.4714f, 0.3062f, 0.2313f, 0.1903f, 0.1627f, 0.1434f, 0.1295f, 0.1192f, 0.1103f},
+    /* T3s */ {0.4801f, 0.3146f, 0.2390f, 0.1954f, 0.1674f, 0.1477f, 0.1330f, 0.1213f, 0.1130f},
+    /* T4s */ {0.4886f, 0.3219f, 0.2453f, 0.2007f, 0.1720f, 0.1518f, 0.1361f, 0.1247f, 0.1152f},
+    /* T5s */ {0.4949f, 0.3282f, 0.2507f, 0.2061f, 0.1768f, 0.1558f, 0.1395f, 0.1279f, 0.1181f},
+    /* T6s */ {0.5108f, 0.3467f, 0.2679f, 0.2204f, 0.1892f, 0.1668f, 0.1504f, 0.1374f, 0.1273f},
+    /* T7s */ {0.5263f, 0.3660f, 0.2857f, 0.2375f, 0.2045f, 0.1810f, 0.1632f, 0.1490f, 0.1384f},
+    /* T8s */ {0.5416f, 0.3835f, 0.3051f, 0.2554f, 0.2213f, 0.1968f, 0.1770f, 0.1623f, 0.1506f},
+    /* T9s */ {0.5568f, 0.4042f, 0.3247f, 0.2749f, 0.2392f, 0.2131f, 0.1910f, 0.1756f, 0.1632f},
+    /* TT  */ {0.7536f, 0.5804f, 0.4570f, 0.3680f, 0.3047f, 0.2580f, 0.2230f, 0.1971f, 0.1770f},
+    /* JTo */ {0.5667f, 0.4057f, 0.3220f, 0.2690f, 0.2306f, 0.2013f, 0.1783f, 0.1608f, 0.1464f},
+    /* QTo */ {0.5863f, 0.4174f, 0.3287f, 0.2717f, 0.2318f, 0.2019f, 0.1784f, 0.1590f, 0.1444f},
+    /* KTo */ {0.6098f, 0.4344f, 0.3402f, 0.2797f, 0.2374f, 0.2065f, 0.1812f, 0.1620f, 0.1466f},
+    /* ATo */ {0.6388f, 0.4577f, 0.3559f, 0.2925f, 0.2464f, 0.2137f, 0.1869f, 0.1668f, 0.1486f},
+    /* J2s */ {0.4955f, 0.3238f, 0.2443f, 0.1993f, 0.1716f, 0.1516f, 0.1363f, 0.1241f, 0.1149f},
+    /* J3s */ {0.5042f, 0.3314f, 0.2508f, 0.2050f, 0.1757f, 0.1551f, 0.1394f, 0.1271f, 0.1176f},
+    /* J4s */ {0.5127f, 0.3398f, 0.2584f, 0.2118f, 0.1806f, 0.1588f, 0.1422f, 0.1294f, 0.1203f},
+    /* J5s */ {0.5215f, 0.3469f, 0.2660f, 0.2176f, 0.1853f, 0.1631f, 0.1465f, 0.1335f, 0.1235f},
+    /* J6s */ {0.5264f, 0.3536f, 0.2702f, 0.2210f, 0.1892f, 0.1669f, 0.1485f, 0.1360f, 0.1253f},
+    /* J7s */ {0.5420f, 0.3727f, 0.2880f, 0.2373f, 0.2039f, 0.1790f, 0.1606f, 0.1465f, 0.1344f},
+    /* J8s */ {0.5572f, 0.3923f, 0.3080f, 0.2555f, 0.2200f, 0.1939f, 0.1742f, 0.1591f, 0.1468f},
+    /* J9s */ {0.5721f, 0.4117f, 0.3285f, 0.2753f, 0.2387f, 0.2105f, 0.1902f, 0.1731f, 0.1594f},
+    /* JTs */ {0.5890f, 0.4338f, 0.3537f, 0.3017f, 0.2634f, 0.2350f, 0.2126f, 0.1949f, 0.1806f},
+    /* JJ  */ {0.7779f, 0.6164f, 0.4959f, 0.4065f, 0.3403f, 0.2898f, 0.2520f, 0.2217f, 0.1989f},
+    /* QJo */ {0.5936f, 0.4268f, 0.3405f, 0.2832f, 0.2429f, 0.2122f, 0.1871f, 0.1666f, 0.1508f},
+    /* KJo */ {0.6170f, 0.4448f, 0.3512f, 0.2914f, 0.2485f, 0.2164f, 0.1916f, 0.1701f, 0.1534f},
+    /* AJo */ {0.6459f, 0.4677f, 0.3686f, 0.3038f, 0.2575f, 0.2241f, 0.1972f, 0.1760f, 0.1569f},
+    /* Q2s */ {0.5224f, 0.3431f, 0.2606f, 0.2126f, 0.1820f, 0.1605f, 0.1450f, 0.1320f, 0.1220f},
+    /* Q3s */ {0.5310f, 0.3524f, 0.2675f, 0.2190f, 0.1877f, 0.1650f, 0.1485f, 0.1349f, 0.1245f},
+    /* Q4s */ {0.5395f, 0.3602f, 0.2743f, 0.2240f, 0.1919f, 0.1687f, 0.1512f, 0.1380f, 0.1275f},
+    /* Q5s */ {0.5483f, 0.3689f, 0.2817f, 0.2312f, 0.1974f, 0.1737f, 0.1552f, 0.1414f, 0.1308f},
+    /* Q6s */ {0.5555f, 0.3771f, 0.2890f, 0.2364f, 0.2026f, 0.1774f, 0.1585f, 0.1446f, 0.1329f},
+    /* Q7s */ {0.5608f, 0.3837f, 0.2941f, 0.2415f, 0.2065f, 0.1810f, 0.1617f, 0.1475f, 0.1356f},
+    /* Q8s */ {0.5762f, 0.4024f, 0.3128f, 0.2601f, 0.2227f, 0.1950f, 0.1751f, 0.1591f, 0.1458f},
+    /* Q9s */ {0.5911f, 0.4222f, 0.3343f, 0.2795f, 0.2404f, 0.2121f, 0.1901f, 0.1730f, 0.1588f},
+    /* QTs */ {0.6076f, 0.4462f, 0.3590f, 0.3051f, 0.2666f, 0.2371f, 0.2134f, 0.1958f, 0.1814f},
+    /* QJs */ {0.6145f, 0.4555f, 0.3710f, 0.3155f, 0.2755f, 0.2453f, 0.2206f, 0.2016f, 0.1847f},
+    /* QQ  */ {0.8022f, 0.6532f, 0.5395f, 0.4510f, 0.3836f, 0.3302f, 0.2875f, 0.2530f, 0.2269f},
+    /* KQo */ {0.6248f, 0.4563f, 0.3647f, 0.3053f, 0.2630f, 0.2293f, 0.2031f, 0.1816f, 0.1634f},
+    /* AQo */ {0.6535f, 0.4807f, 0.3814f, 0.3173f, 0.2717f, 0.2366f, 0.2101f, 0.1870f, 0.1678f},
+    /* K2s */ {0.5518f, 0.3699f, 0.2820f, 0.2304f, 0.1978f, 0.1747f, 0.1570f, 0.1433f, 0.1319f},
+    /* K3s */ {0.5604f, 0.3784f, 0.2871f, 0.2361f, 0.2027f, 0.1785f, 0.1603f, 0.1471f, 0.1348f},
+    /* K4s */ {0.5688f, 0.3865f, 0.2952f, 0.2429f, 0.2073f, 0.1837f, 0.1649f, 0.1500f, 0.1370f},
+    /* K5s */ {0.5775f, 0.3946f, 0.3035f, 0.2490f, 0.2133f, 0.1878f, 0.1687f, 0.1538f, 0.1407f},
+    /* K6s */ {0.5848f, 0.4031f, 0.3106f, 0.2548f, 0.2180f, 0.1916f, 0.1715f, 0.1560f, 0.1435f},
+    /* K7s */ {0.5923f, 0.4120f, 0.3174f, 0.2612f, 0.2234f, 0.1961f, 0.1760f, 0.1594f, 0.1469f},
+    /* K8s */ {0.5983f, 0.4187f, 0.3246f, 0.2689f, 0.2302f, 0.2024f, 0.1805f, 0.1640f, 0.1501f},
+    /* K9s */ {0.6134f, 0.4391f, 0.3453f, 0.2866f, 0.2472f, 0.2174f, 0.1946f, 0.1769f, 0.1620f},
+    /* KTs */ {0.6299f, 0.4619f, 0.3709f, 0.3136f, 0.2731f, 0.2424f, 0.2182f, 0.1994f, 0.1834f},
+    /* KJs */ {0.6366f, 0.4724f, 0.3818f, 0.3237f, 0.2824f, 0.2518f, 0.2267f, 0.2066f, 0.1899f},
+    /* KQs */ {0.6439f, 0.4823f, 0.3937f, 0.3370f, 0.2948f, 0.2633f, 0.2379f, 0.2166f, 0.1975f},
+    /* KK  */ {0.8267f, 0.6923f, 0.5864f, 0.5014f, 0.4332f, 0.3783f, 0.3319f, 0.2952f, 0.2639f},
+    /* AKo */ {0.6617f, 0.4937f, 0.3972f, 0.3343f, 0.2900f, 0.2551f, 0.2270f, 0.2028f, 0.1833f},
+    /* A2s */ {0.5925f, 0.4084f, 0.3147f, 0.2602f, 0.2240f, 0.1984f, 0.1792f, 0.1629f, 0.1506f},
+    /* A3s */ {0.6011f, 0.4178f, 0.3241f, 0.2669f, 0.2303f, 0.2044f, 0.1841f, 0.1683f, 0.1559f},
+    /* A4s */ {0.6093f, 0.4262f, 0.3312f, 0.2740f, 0.2353f, 0.2091f, 0.1891f, 0.1731f, 0.1586f},
+    /* A5s */ {0.6178f, 0.4360f, 0.3387f, 0.2807f, 0.2419f, 0.2142f, 0.1926f, 0.1762f, 0.1630f},
+    /* A6s */ {0.6163f, 0.4322f, 0.3326f, 0.2738f, 0.2352f, 0.2077f, 0.1857f, 0.1701f, 0.1565f},
+    /* A7s */ {0.6258f, 0.4428f, 0.3437f, 0.2831f, 0.2430f, 0.2146f, 0.1914f, 0.1737f, 0.1589f},
+    /* A8s */ {0.6338f, 0.4535f, 0.3520f, 0.2907f, 0.2506f, 0.2200f, 0.1965f, 0.1787f, 0.1634f},
+    /* A9s */ {0.6405f, 0.4614f, 0.3632f, 0.2993f, 0.2579f, 0.2264f, 0.2029f, 0.1835f, 0.1686f},
+    /* ATs */ {0.6572f, 0.4851f, 0.3878f, 0.3253f, 0.2832f, 0.2507f, 0.2260f, 0.2048f, 0.1882f},
+    /* AJs */ {0.6639f, 0.4956f, 0.3988f, 0.3366f, 0.2930f, 0.2600f, 0.2334f, 0.2124f, 0.1953f},
+    /* AQs */ {0.6710f, 0.5060f, 0.4101f, 0.3491f, 0.3061f, 0.2718f, 0.2446f, 0.2229f, 0.2044f},
+    /* AKs */ {0.6787f, 0.5181f, 0.4256f, 0.3652f, 0.3212f, 0.2879f, 0.2598f, 0.2370f, 0.2174f},
+    /* AA  */ {0.8548f, 0.7376f, 0.6420f, 0.5610f, 0.4962f, 0.4387f, 0.3904f, 0.3505f, 0.3141f}
+};
@@ -0,0 +1,79 @@
+#include "random.h"
+
+/*
+ * Advance a splitmix64 state
+ * Used to spread a single seed over the whole generator state
+ * state: the splitmix64 state to advance
+ * return: the next splitmix64 output
+ */
+static
+uint64_t SplitMix(uint64_t *state);
+
+/*
+ * Seed a generator
+ * Nearby seeds still give unrelated streams
+ * rng: the generator to seed
+ * seed: any 64-bit value
+ */
+void SeedRandom(RandomState *rng, uint64_t seed)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        rng->s[i] = SplitMix(&seed);
+    }
+
+    rng->spare = 0;
+    rng->has_spare = false;
+}
+
+/*
+ * Allocate an array of cache-line aligned generators,
+ * each seeded with its own stream
+ * count: the number of generators
+ * seed: the seed of the first generator
+ * return: the new array, freed with DestroyRandomStates
+ */
+RandomState *CreateRandomStates(int count, uint64_t seed)
+{
+    void *memory;
+    RandomState *rngs;
+
+    if (posix_memalign(&memory, CACHE_LINE_SIZE, sizeof(*rngs) * count))
+    {
+        return NULL;
+    }
+
+    rngs = memory;
+    for (int i = 0; i < count; i++)
+    {
+        SeedRandom(&rngs[i], seed + i);
+    }
+
+    return rngs;
+}
+
+/*
+ * Free an array made by CreateRandomStates
+ * rngs: the array to free
+ */
+void DestroyRandomStates(RandomState *rngs)
+{
+    free(rngs);
+}
+
+/*
+ * Advance a splitmix64 state
+ * Used to spread a single seed over the whole generator state
+ * state: the splitmix64 state to advance
+ * return: the next splitmix64 output
+ */
+static
+uint64_t SplitMix(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+    return z ^ (z >> 31);
+}
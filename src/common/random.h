@@ -0,0 +1,159 @@
+#ifndef __RANDOM_H__
+#define __RANDOM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define CACHE_LINE_SIZE     64
+
+//Generators a RandomState can run
+//Pick one at compile time with -DRANDOM_GENERATOR=RANDOM_XOSHIRO
+#define RANDOM_WYRAND       0
+#define RANDOM_XOSHIRO      1
+
+#ifndef RANDOM_GENERATOR
+#define RANDOM_GENERATOR    RANDOM_WYRAND
+#endif
+
+//State of one thread's generator
+//Each state fills its own cache line so that workers
+//never write to a line another worker is using
+typedef struct randomstate
+{
+    uint64_t s[4];
+
+    //The unused half of the last 64-bit output
+    uint32_t spare;
+    bool has_spare;
+} __attribute__((aligned(CACHE_LINE_SIZE))) RandomState;
+
+/*
+ * Seed a generator
+ * Nearby seeds still give unrelated streams
+ * rng: the generator to seed
+ * seed: any 64-bit value
+ */
+void SeedRandom(RandomState *rng, uint64_t seed);
+
+/*
+ * Allocate an array of cache-line aligned generators,
+ * each seeded with its own stream
+ * count: the number of generators
+ * seed: the seed of the first generator
+ * return: the new array, freed with DestroyRandomStates
+ */
+RandomState *CreateRandomStates(int count, uint64_t seed);
+
+/*
+ * Free an array made by CreateRandomStates
+ * rngs: the array to free
+ */
+void DestroyRandomStates(RandomState *rngs);
+
+/*
+ * Get the next 64 random bits
+ * rng: the generator to advance
+ * return: a uniformly distributed 64-bit value
+ */
+static inline
+uint64_t RandomNext(RandomState *rng)
+{
+#if RANDOM_GENERATOR == RANDOM_XOSHIRO
+    //xoshiro256**
+    uint64_t *s = rng->s;
+    uint64_t result = s[1] * 5;
+    uint64_t t = s[1] << 17;
+
+    result = ((result << 7) | (result >> 57)) * 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+
+    return result;
+#else
+    //wyrand
+    __uint128_t product;
+
+    rng->s[0] += 0xa0761d6478bd642full;
+    product = (__uint128_t)rng->s[0] * (rng->s[0] ^ 0xe7037ed1a0b428dbull);
+
+    return (uint64_t)(product >> 64) ^ (uint64_t)product;
+#endif
+}
+
+/*
+ * Get the next 32 random bits
+ * Each 64-bit output is split in two, so consecutive calls
+ * only run the generator every other time
+ * rng: the generator to advance
+ * return: a uniformly distributed 32-bit value
+ */
+static inline
+uint32_t RandomNext32(RandomState *rng)
+{
+    uint64_t bits;
+
+    if (rng->has_spare)
+    {
+        rng->has_spare = false;
+        return rng->spare;
+    }
+
+    bits = RandomNext(rng);
+    rng->spare = (uint32_t)(bits >> 32);
+    rng->has_spare = true;
+
+    return (uint32_t)bits;
+}
+
+/*
+ * Get an unbiased random number in [0, bound)
+ * Uses Lemire's multiply-shift, which only needs a division
+ * in the rare case that the sample must be rejected
+ * rng: the generator to advance
+ * bound: the exclusive upper limit (must be positive)
+ * return: a uniformly distributed value below bound
+ */
+static inline
+uint32_t RandomBelow(RandomState *rng, uint32_t bound)
+{
+    uint64_t product = (uint64_t)RandomNext32(rng) * bound;
+    uint32_t low = (uint32_t)product;
+    uint32_t threshold;
+
+    if (low < bound)
+    {
+        threshold = -bound % bound;
+        while (low < threshold)
+        {
+            product = (uint64_t)RandomNext32(rng) * bound;
+            low = (uint32_t)product;
+        }
+    }
+
+    return (uint32_t)(product >> 32);
+}
+
+/*
+ * Randomly draw a card from the deck
+ * and remove that card from the deck
+ * rng: the generator to draw with
+ * deck: the deck to draw a card from
+ * psize: a pointer to the size of the deck
+ * return: a random card from the deck
+ */
+static inline
+int DrawCard(RandomState *rng, int *deck, int *psize)
+{
+    int index = RandomBelow(rng, *psize);
+    int value = deck[index];
+    deck[index] = deck[--*psize];
+
+    return value;
+}
+
+#endif
@@ -0,0 +1,222 @@
+#include "range.h"
+
+int COMBO_CARDS[NUM_COMBOS][NUM_HAND];
+CardMask COMBO_MASKS[NUM_COMBOS];
+
+//How far into the ranking of starting hands each combo falls
+//(0 == strongest, 1 == weakest), measured at the middle of its class
+static double COMBO_PERCENTILES[NUM_COMBOS];
+
+static pthread_once_t RANGES_ONCE = PTHREAD_ONCE_INIT;
+
+/*
+ * Fill in the combo tables, run once by InitRanges
+ */
+static
+void BuildComboTables(void);
+
+/*
+ * Fill in COMBO_CARDS and COMBO_MASKS
+ * Safe to call more than once, from any thread
+ */
+void InitRanges(void)
+{
+    pthread_once(&RANGES_ONCE, BuildComboTables);
+}
+
+/*
+ * Decide how tight a player's range is from their betting this hand
+ * player: the player whose chips committed are measured
+ * return: the share of hands the player is expected to hold,
+ * 1 for players who have not committed RANGE_MIN_COMMIT of their stack
+ */
+double RangeKeep(Player *player)
+{
+    double committed;
+
+    if (player->initial_stack <= 0) return 1.0;
+
+    committed = (double)(player->initial_stack - player->stack) / player->initial_stack;
+    if (committed < RANGE_MIN_COMMIT) return 1.0;
+    if (committed > 1.0) committed = 1.0;
+
+    return 1.0 - committed * (1.0 - RANGE_MIN_KEEP);
+}
+
+/*
+ * Weight every combo by its preflop strength,
+ * keeping about the strongest share of hands given
+ * weights: where to store the NUM_COMBOS weights
+ * keep: the share of hands to keep, from RANGE_MIN_KEEP to 1
+ */
+void SetRangeWeights(double *weights, double keep)
+{
+    InitRanges();
+
+    for (int i = 0; i < NUM_COMBOS; i++)
+    {
+        //Hands fade out around the cutoff rather than stopping dead
+        weights[i] = 1.0 / (1.0 + exp((COMBO_PERCENTILES[i] - keep) / RANGE_SOFTNESS));
+        if (weights[i] < RANGE_MIN_WEIGHT)
+        {
+            weights[i] = RANGE_MIN_WEIGHT;
+        }
+    }
+}
+
+/*
+ * Build the alias table of a range
+ * Combos holding a dead card are given no weight
+ * range: the range to build
+ * weights: the relative weight of every combo
+ * dead: the cards known not to be in the opponent's hand
+ * return: false if no combo has any weight, the range is uniform then
+ */
+bool BuildHandRange(HandRange *range, const double *weights, CardMask dead)
+{
+    double *scaled = malloc(sizeof(double) * NUM_COMBOS);
+    int *small = malloc(sizeof(int) * NUM_COMBOS);
+    int *large = malloc(sizeof(int) * NUM_COMBOS);
+    int num_small = 0;
+    int num_large = 0;
+    double total = 0;
+    int s;
+    int l;
+
+    InitRanges();
+
+    for (int i = 0; i < NUM_COMBOS; i++)
+    {
+        scaled[i] = (COMBO_MASKS[i] & dead) ? 0 : weights[i];
+        total += scaled[i];
+    }
+
+    range->uniform = total <= 0;
+    if (!range->uniform)
+    {
+        //Vose's method: pair every combo below the average weight
+        //with one above it, so each slot holds at most two combos
+        for (int i = 0; i < NUM_COMBOS; i++)
+        {
+            scaled[i] *= NUM_COMBOS / total;
+            range->alias[i] = i;
+
+            if (scaled[i] < 1.0)
+            {
+                small[num_small++] = i;
+            }
+            else
+            {
+                large[num_large++] = i;
+            }
+        }
+
+        while (num_small > 0 && num_large > 0)
+        {
+            s = small[--num_small];
+            l = large[num_large - 1];
+
+            range->threshold[s] = (uint32_t)(scaled[s] * 4294967296.0);
+            range->alias[s] = l;
+
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0)
+            {
+                num_large--;
+                small[num_small++] = l;
+            }
+        }
+
+        //Whatever is left over is full up to rounding
+        while (num_large > 0)
+        {
+            range->threshold[large[--num_large]] = UINT32_MAX;
+        }
+        while (num_small > 0)
+        {
+            range->threshold[small[--num_small]] = UINT32_MAX;
+        }
+    }
+
+    free(scaled);
+    free(small);
+    free(large);
+    return !range->uniform;
+}
+
+/*
+ * Build the range of a player from their betting this hand
+ * range: the range to build
+ * player: the player whose hand is being modeled
+ * dead: the cards known not to be in the player's hand
+ */
+void SetPlayerRange(HandRange *range, Player *player, CardMask dead)
+{
+    double keep = RangeKeep(player);
+    double *weights;
+
+    if (keep >= 1.0)
+    {
+        range->uniform = true;
+        return;
+    }
+
+    weights = malloc(sizeof(double) * NUM_COMBOS);
+    SetRangeWeights(weights, keep);
+    BuildHandRange(range, weights, dead);
+    free(weights);
+}
+
+/*
+ * Fill in the combo tables, run once by InitRanges
+ */
+static
+void BuildComboTables(void)
+{
+    int classes[NUM_PREFLOP_CLASSES];
+    double class_percentiles[NUM_PREFLOP_CLASSES];
+    int class_combos[NUM_PREFLOP_CLASSES] = {0};
+    double before = 0;
+    int combo = 0;
+    int key;
+
+    for (int c1 = 1; c1 < NUM_DECK; c1++)
+    {
+        for (int c2 = c1 + 1; c2 < NUM_DECK; c2++)
+        {
+            COMBO_CARDS[combo][0] = c1;
+            COMBO_CARDS[combo][1] = c2;
+            COMBO_MASKS[combo] = CardToMask(c1) | CardToMask(c2);
+            class_combos[PreflopClass(COMBO_CARDS[combo])]++;
+            combo++;
+        }
+    }
+
+    //Rank the classes by their equity heads up, strongest first
+    for (int i = 0; i < NUM_PREFLOP_CLASSES; i++)
+    {
+        classes[i] = i;
+    }
+    for (int i = 1; i < NUM_PREFLOP_CLASSES; i++)
+    {
+        key = classes[i];
+        int j = i - 1;
+        while (j >= 0 && PREFLOP_EQUITY[classes[j]][0] < PREFLOP_EQUITY[key][0])
+        {
+            classes[j + 1] = classes[j];
+            j--;
+        }
+        classes[j + 1] = key;
+    }
+
+    for (int i = 0; i < NUM_PREFLOP_CLASSES; i++)
+    {
+        class_percentiles[classes[i]] = (before + class_combos[classes[i]] / 2.0) / NUM_COMBOS;
+        before += class_combos[classes[i]];
+    }
+
+    for (int i = 0; i < NUM_COMBOS; i++)
+    {
+        COMBO_PERCENTILES[i] = class_percentiles[PreflopClass(COMBO_CARDS[i])];
+    }
+}
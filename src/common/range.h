@@ -0,0 +1,128 @@
+#ifndef __RANGE_H__
+#define __RANGE_H__
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "cardmask.h"
+#include "gamestate.h"
+#include "player.h"
+#include "preflop.h"
+#include "random.h"
+
+//Every two card starting hand, (52 choose 2)
+#define NUM_COMBOS          1326
+
+//Opponents who have put in less than this share of their stack
+//this hand, such as the blinds, are dealt uniformly random hands
+#define RANGE_MIN_COMMIT    0.05
+
+//Share of hands an opponent who is all in is expected to hold
+#define RANGE_MIN_KEEP      0.15
+
+//How gradually hands drop out of a range, in percentiles
+#define RANGE_SOFTNESS      0.05
+
+//The weight of the weakest hands, so that a range never rules out a bluff
+#define RANGE_MIN_WEIGHT    0.02
+
+//Every starting hand indexed by combo: its two cards and their mask
+extern int COMBO_CARDS[NUM_COMBOS][NUM_HAND];
+extern CardMask COMBO_MASKS[NUM_COMBOS];
+
+//A weighted distribution of an opponent's hole cards
+//stored as an alias table, so that a hand is sampled in constant time
+typedef struct handrange
+{
+    //Combo i is kept when a 32-bit random number is below
+    //threshold[i], and replaced by alias[i] otherwise
+    uint32_t threshold[NUM_COMBOS];
+    uint16_t alias[NUM_COMBOS];
+
+    //Every hand is equally likely, so the range need not be sampled at all
+    bool uniform;
+} HandRange;
+
+/*
+ * Fill in COMBO_CARDS and COMBO_MASKS
+ * Safe to call more than once, from any thread
+ */
+void InitRanges(void);
+
+/*
+ * Decide how tight a player's range is from their betting this hand
+ * player: the player whose chips committed are measured
+ * return: the share of hands the player is expected to hold,
+ * 1 for players who have not committed RANGE_MIN_COMMIT of their stack
+ */
+double RangeKeep(Player *player);
+
+/*
+ * Weight every combo by its preflop strength,
+ * keeping about the strongest share of hands given
+ * weights: where to store the NUM_COMBOS weights
+ * keep: the share of hands to keep, from RANGE_MIN_KEEP to 1
+ */
+void SetRangeWeights(double *weights, double keep);
+
+/*
+ * Build the alias table of a range
+ * Combos holding a dead card are given no weight
+ * range: the range to build
+ * weights: the relative weight of every combo
+ * dead: the cards known not to be in the opponent's hand
+ * return: false if no combo has any weight, the range is uniform then
+ */
+bool BuildHandRange(HandRange *range, const double *weights, CardMask dead);
+
+/*
+ * Build the range of a player from their betting this hand
+ * range: the range to build
+ * player: the player whose hand is being modeled
+ * dead: the cards known not to be in the player's hand
+ */
+void SetPlayerRange(HandRange *range, Player *player, CardMask dead);
+
+/*
+ * Sample a combo from a range
+ * range: the range to sample, which must not be uniform
+ * rng: the generator to sample with
+ * return: the index of the combo
+ */
+static inline
+int SampleRangeCombo(const HandRange *range, RandomState *rng)
+{
+    //One output picks both the slot and the side of it, the slot by
+    //multiply-shift, whose bias of NUM_COMBOS / 2^32 is far below noise
+    uint64_t bits = RandomNext(rng);
+    int combo = (int)(((bits >> 32) * NUM_COMBOS) >> 32);
+
+    return (uint32_t)bits < range->threshold[combo] ? combo : range->alias[combo];
+}
+
+/*
+ * Deal an opponent's hand from their range
+ * Hands holding a card that has already been dealt are sampled again
+ * range: the range to deal from, which must not be uniform
+ * rng: the generator to sample with
+ * dealt: the cards already dealt in this game
+ * return: the index of the combo
+ */
+static inline
+int DealRangeHand(const HandRange *range, RandomState *rng, CardMask dealt)
+{
+    int combo;
+
+    do
+    {
+        combo = SampleRangeCombo(range, rng);
+    } while (COMBO_MASKS[combo] & dealt);
+
+    return combo;
+}
+
+#endif
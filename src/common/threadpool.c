@@ -0,0 +1,236 @@
+#include "threadpool.h"
+
+/*
+ * Main loop of a pool worker: park until a new submission
+ * is published, run it, then report completion
+ * _worker: a void pointer to the worker's PoolWorker
+ * return: NULL (pthread requirement)
+ */
+static
+void *PoolWorkerLoop(void *_worker);
+
+/*
+ * Create a new pool of parked worker threads
+ * num_threads: the number of workers to start
+ * return: a new ThreadPool
+ */
+ThreadPool *CreateThreadPool(int num_threads)
+{
+    ThreadPool *pool = malloc(sizeof(*pool));
+    pthread_condattr_t attr;
+
+    pool->num_threads = num_threads;
+    pool->generation = 0;
+    pool->active = 0;
+    pool->shutdown = false;
+    pool->task = NULL;
+    pool->arg = NULL;
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+
+    //Deadlines given to ThreadPoolWaitUntil are on the monotonic clock
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&pool->done_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pool->workers = malloc(sizeof(*pool->workers) * num_threads);
+    for (int i = 0; i < num_threads; i++)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        pool->workers[i].cpu = -1;
+        pthread_create(&pool->workers[i].thread, NULL, PoolWorkerLoop, &pool->workers[i]);
+    }
+
+    return pool;
+}
+
+/*
+ * Wake up and join every worker, then free the pool
+ * pool: the ThreadPool to destroy
+ */
+void DestroyThreadPool(ThreadPool *pool)
+{
+    if (!pool) return;
+
+    ThreadPoolWait(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->num_threads; i++)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->mutex);
+
+    free(pool->workers);
+    free(pool);
+}
+
+/*
+ * Pin every worker of the pool to its own CPU, or let them float again
+ * Workers take the allowed CPUs in order, wrapping around
+ * if there are more workers than CPUs
+ * pool: the ThreadPool to pin
+ * pin: true to pin the workers, false to allow every CPU again
+ * return: true if every worker's affinity was set
+ */
+bool PinThreadPool(ThreadPool *pool, bool pin)
+{
+    int *cpus = malloc(sizeof(*cpus) * MAX_CPUS);
+    int num_cpus = GetAllowedCpus(cpus, MAX_CPUS);
+    PoolWorker *worker;
+    bool pinned = num_cpus > 0;
+
+    for (int i = 0; i < pool->num_threads && num_cpus > 0; i++)
+    {
+        worker = &pool->workers[i];
+        if (pin)
+        {
+            worker->cpu = cpus[i % num_cpus];
+            pinned = SetThreadCpus(worker->thread, &worker->cpu, 1) && pinned;
+        }
+        else
+        {
+            worker->cpu = -1;
+            pinned = SetThreadCpus(worker->thread, cpus, num_cpus) && pinned;
+        }
+    }
+
+    free(cpus);
+    return pinned;
+}
+
+/*
+ * Hand a task to every worker in the pool and return immediately
+ * Waits for any previous submission to complete first
+ * pool: the ThreadPool that will run the task
+ * task: the function each worker will run
+ * arg: the argument passed to each worker
+ */
+void ThreadPoolSubmit(ThreadPool *pool, PoolTask task, void *arg)
+{
+    pthread_mutex_lock(&pool->mutex);
+
+    while (pool->active > 0)
+    {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+
+    pool->task = task;
+    pool->arg = arg;
+    pool->active = pool->num_threads;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_cond);
+
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/*
+ * Block until every worker has finished the current submission
+ * pool: the ThreadPool to wait on
+ */
+void ThreadPoolWait(ThreadPool *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+
+    while (pool->active > 0)
+    {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/*
+ * Block until every worker has finished the current submission
+ * or the deadline passes, whichever comes first
+ * pool: the ThreadPool to wait on
+ * deadline: the latest time to wait until on the monotonic clock, see SetDeadline
+ * return: true if every worker finished, false if the deadline passed first
+ */
+bool ThreadPoolWaitUntil(ThreadPool *pool, const struct timespec *deadline)
+{
+    bool done;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    while (pool->active > 0)
+    {
+        if (pthread_cond_timedwait(&pool->done_cond, &pool->mutex, deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    done = pool->active == 0;
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    return done;
+}
+
+/*
+ * Run a task on every worker and wait for all of them to finish
+ * pool: the ThreadPool that will run the task
+ * task: the function each worker will run
+ * arg: the argument passed to each worker
+ */
+void ThreadPoolRun(ThreadPool *pool, PoolTask task, void *arg)
+{
+    ThreadPoolSubmit(pool, task, arg);
+    ThreadPoolWait(pool);
+}
+
+/*
+ * Main loop of a pool worker: park until a new submission
+ * is published, run it, then report completion
+ * _worker: a void pointer to the worker's PoolWorker
+ * return: NULL (pthread requirement)
+ */
+static
+void *PoolWorkerLoop(void *_worker)
+{
+    PoolWorker *worker = (PoolWorker *)_worker;
+    ThreadPool *pool = worker->pool;
+    unsigned long seen = 0;
+    PoolTask task;
+    void *arg;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (1)
+    {
+        //Park until there is new work or the pool is shutting down
+        while (!pool->shutdown && pool->generation == seen)
+        {
+            pthread_cond_wait(&pool->work_cond, &pool->mutex);
+        }
+
+        if (pool->shutdown) break;
+
+        seen = pool->generation;
+        task = pool->task;
+        arg = pool->arg;
+        pthread_mutex_unlock(&pool->mutex);
+
+        task(arg, worker->index);
+
+        //The last worker to finish releases anyone waiting on the barrier
+        pthread_mutex_lock(&pool->mutex);
+        pool->active--;
+        if (pool->active == 0)
+        {
+            pthread_cond_broadcast(&pool->done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
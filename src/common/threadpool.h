@@ -0,0 +1,103 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "topology.h"
+
+//Work run by every worker in the pool
+//arg: the argument given at submission
+//worker: the index of the worker running the task, in [0, num_threads)
+typedef void (*PoolTask)(void *arg, int worker);
+
+struct threadpool;
+
+//Per-thread bookkeeping so each worker knows its own index
+typedef struct poolworker
+{
+    struct threadpool *pool;
+    pthread_t thread;
+    int index;
+
+    //The CPU the worker is pinned to, or -1 if it may run anywhere
+    int cpu;
+} PoolWorker;
+
+typedef struct threadpool
+{
+    PoolWorker *workers;
+    int num_threads;
+
+    //Workers park on work_cond until the generation changes
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    unsigned long generation;
+    int active;
+    bool shutdown;
+
+    //The current submission
+    PoolTask task;
+    void *arg;
+} ThreadPool;
+
+/*
+ * Create a new pool of parked worker threads
+ * num_threads: the number of workers to start
+ * return: a new ThreadPool
+ */
+ThreadPool *CreateThreadPool(int num_threads);
+
+/*
+ * Wake up and join every worker, then free the pool
+ * pool: the ThreadPool to destroy
+ */
+void DestroyThreadPool(ThreadPool *pool);
+
+/*
+ * Pin every worker of the pool to its own CPU, or let them float again
+ * Workers take the allowed CPUs in order, wrapping around
+ * if there are more workers than CPUs
+ * pool: the ThreadPool to pin
+ * pin: true to pin the workers, false to allow every CPU again
+ * return: true if every worker's affinity was set
+ */
+bool PinThreadPool(ThreadPool *pool, bool pin);
+
+/*
+ * Hand a task to every worker in the pool and return immediately
+ * Waits for any previous submission to complete first
+ * pool: the ThreadPool that will run the task
+ * task: the function each worker will run
+ * arg: the argument passed to each worker
+ */
+void ThreadPoolSubmit(ThreadPool *pool, PoolTask task, void *arg);
+
+/*
+ * Block until every worker has finished the current submission
+ * pool: the ThreadPool to wait on
+ */
+void ThreadPoolWait(ThreadPool *pool);
+
+/*
+ * Block until every worker has finished the current submission
+ * or the deadline passes, whichever comes first
+ * pool: the ThreadPool to wait on
+ * deadline: the latest time to wait until on the monotonic clock, see SetDeadline
+ * return: true if every worker finished, false if the deadline passed first
+ */
+bool ThreadPoolWaitUntil(ThreadPool *pool, const struct timespec *deadline);
+
+/*
+ * Run a task on every worker and wait for all of them to finish
+ * pool: the ThreadPool that will run the task
+ * task: the function each worker will run
+ * arg: the argument passed to each worker
+ */
+void ThreadPoolRun(ThreadPool *pool, PoolTask task, void *arg);
+
+#endif
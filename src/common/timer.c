@@ -1,9 +1,7 @@
 #include "timer.h"
 
-#define MICROSECONDS(timeval) \
-    (timeval.tv_usec + 1000000 * timeval.tv_sec)
-#define MICRO_TO_MILLI(X) \
-    (X / 1000)
+#define NANO_TO_MILLI(X) \
+    (X / NANOSECONDS_PER_MILLISECOND)
 
 /*
  * Start the timer
@@ -11,7 +9,7 @@
  */
 void StartTimer(Timer *timer)
 {
-    gettimeofday(&timer->begin, NULL);
+    timer->begin = MonotonicNanoseconds();
     timer->state = TIMER_RUNNING;
 }
 
@@ -21,12 +19,9 @@ void StartTimer(Timer *timer)
  */
 void StopTimer(Timer *timer)
 {
-    unsigned long long diff;
-    struct timeval end;
-    gettimeofday(&end, NULL);
+    unsigned long long diff = MonotonicNanoseconds() - timer->begin;
 
-    diff = MICROSECONDS(end) - MICROSECONDS(timer->begin);
-    timer->elapsed = MICRO_TO_MILLI(diff);
+    timer->elapsed = NANO_TO_MILLI(diff);
     timer->state = TIMER_STOPPED;
 }
 
@@ -40,13 +35,35 @@ unsigned long long GetElapsedTime(Timer *timer)
 {
     if (timer->state == TIMER_RUNNING)
     {
-        unsigned long long diff;
-        struct timeval now;
-        gettimeofday(&now, NULL);
-
-        diff = MICROSECONDS(now) - MICROSECONDS(timer->begin);
-        timer->elapsed = MICRO_TO_MILLI(diff);
+        unsigned long long diff = MonotonicNanoseconds() - timer->begin;
+        timer->elapsed = NANO_TO_MILLI(diff);
     }
 
     return timer->elapsed;
 }
+
+/*
+ * Read the monotonic clock
+ * return: nanoseconds since an arbitrary fixed point
+ */
+unsigned long long MonotonicNanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NANOSECONDS_PER_SECOND + now.tv_nsec;
+}
+
+/*
+ * Find the point on the monotonic clock a number of milliseconds from now
+ * Pass it to anything that waits on CLOCK_MONOTONIC, such as ThreadPoolWaitUntil
+ * deadline: where to store the deadline
+ * milliseconds: how far in the future the deadline is
+ */
+void SetDeadline(struct timespec *deadline, unsigned long long milliseconds)
+{
+    unsigned long long expires = MonotonicNanoseconds() + milliseconds * NANOSECONDS_PER_MILLISECOND;
+
+    deadline->tv_sec = expires / NANOSECONDS_PER_SECOND;
+    deadline->tv_nsec = expires % NANOSECONDS_PER_SECOND;
+}
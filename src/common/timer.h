@@ -2,7 +2,10 @@
 #define __TIMER_H__
 
 #include <stdlib.h>
-#include <sys/time.h>
+#include <time.h>
+
+#define NANOSECONDS_PER_SECOND      1000000000ull
+#define NANOSECONDS_PER_MILLISECOND 1000000ull
 
 typedef enum timerstate
 {
@@ -10,10 +13,11 @@ typedef enum timerstate
     TIMER_STOPPED
 } TimerState;
 
+//Measures on the monotonic clock, so NTP cannot step it
 typedef struct timer
 {
     TimerState state;
-    struct timeval begin;
+    unsigned long long begin;
     unsigned long long elapsed;
 } Timer;
 
@@ -37,4 +41,18 @@ void StopTimer(Timer *timer);
  */
 unsigned long long GetElapsedTime(Timer *timer);
 
+/*
+ * Read the monotonic clock
+ * return: nanoseconds since an arbitrary fixed point
+ */
+unsigned long long MonotonicNanoseconds(void);
+
+/*
+ * Find the point on the monotonic clock a number of milliseconds from now
+ * Pass it to anything that waits on CLOCK_MONOTONIC, such as ThreadPoolWaitUntil
+ * deadline: where to store the deadline
+ * milliseconds: how far in the future the deadline is
+ */
+void SetDeadline(struct timespec *deadline, unsigned long long milliseconds);
+
 #endif
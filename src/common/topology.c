@@ -0,0 +1,163 @@
+//CPU sets and pthread_setaffinity_np are GNU extensions
+#define _GNU_SOURCE
+
+#include "topology.h"
+
+//NUMA memory policies from <numaif.h>, which ships with libnuma
+#define MPOL_BIND_MODE          2
+#define MPOL_INTERLEAVE_MODE    3
+
+/*
+ * Apply a NUMA memory policy to a memory range
+ * addr: the page aligned start of the range
+ * length: the length of the range in bytes
+ * mode: the policy, MPOL_BIND_MODE or MPOL_INTERLEAVE_MODE
+ * nodemask: the nodes the policy may use
+ * return: true if the policy was set
+ */
+static
+bool SetMemoryPolicy(void *addr, size_t length, int mode, unsigned long nodemask);
+
+/*
+ * Count the NUMA nodes of this machine
+ * return: one more than the highest online node (1 without NUMA)
+ */
+int GetNumNodes(void)
+{
+    FILE *file = fopen(NODE_ONLINE_FILE, "r");
+    char list[256];
+    char *last;
+    int nodes = 1;
+
+    if (!file)
+    {
+        return nodes;
+    }
+
+    //The file holds a list of ranges such as "0-1" or "0,2-3"
+    if (fgets(list, sizeof(list), file))
+    {
+        last = list + strcspn(list, "\n");
+        while (last > list && last[-1] != ',' && last[-1] != '-')
+        {
+            last--;
+        }
+        nodes = atoi(last) + 1;
+    }
+    fclose(file);
+
+    if (nodes < 1) return 1;
+    if (nodes > MAX_NUMA_NODES) return MAX_NUMA_NODES;
+    return nodes;
+}
+
+/*
+ * Find the NUMA node the calling thread is running on
+ * return: the node, or 0 if it cannot be found
+ */
+int GetCurrentNode(void)
+{
+    unsigned cpu;
+    unsigned node;
+
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) || node >= MAX_NUMA_NODES)
+    {
+        return 0;
+    }
+
+    return node;
+}
+
+/*
+ * Collect the CPUs the calling thread is allowed to run on
+ * cpus: where to store the CPU numbers, in ascending order
+ * max_cpus: the length of cpus
+ * return: the number of CPUs stored
+ */
+int GetAllowedCpus(int *cpus, int max_cpus)
+{
+    cpu_set_t set;
+    int num_cpus = 0;
+
+    if (sched_getaffinity(0, sizeof(set), &set))
+    {
+        return 0;
+    }
+
+    for (int cpu = 0; cpu < CPU_SETSIZE && num_cpus < max_cpus; cpu++)
+    {
+        if (CPU_ISSET(cpu, &set))
+        {
+            cpus[num_cpus++] = cpu;
+        }
+    }
+
+    return num_cpus;
+}
+
+/*
+ * Restrict a thread to a set of CPUs
+ * thread: the thread to restrict
+ * cpus: the CPUs it may run on
+ * num_cpus: the number of CPUs
+ * return: true if the affinity was set
+ */
+bool SetThreadCpus(pthread_t thread, int *cpus, int num_cpus)
+{
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    for (int i = 0; i < num_cpus; i++)
+    {
+        CPU_SET(cpus[i], &set);
+    }
+
+    return !pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+
+/*
+ * Place the pages of a memory range on one NUMA node
+ * Must be called before the pages are first touched
+ * addr: the page aligned start of the range
+ * length: the length of the range in bytes
+ * node: the node to place the pages on
+ * return: true if the policy was set
+ */
+bool BindMemoryToNode(void *addr, size_t length, int node)
+{
+    return SetMemoryPolicy(addr, length, MPOL_BIND_MODE, 1ul << node);
+}
+
+/*
+ * Spread the pages of a memory range round-robin over every NUMA node
+ * Must be called before the pages are first touched
+ * addr: the page aligned start of the range
+ * length: the length of the range in bytes
+ * return: true if the policy was set
+ */
+bool InterleaveMemory(void *addr, size_t length)
+{
+    int nodes = GetNumNodes();
+    unsigned long nodemask = nodes < MAX_NUMA_NODES ? (1ul << nodes) - 1 : ~0ul;
+
+    return SetMemoryPolicy(addr, length, MPOL_INTERLEAVE_MODE, nodemask);
+}
+
+/*
+ * Apply a NUMA memory policy to a memory range
+ * addr: the page aligned start of the range
+ * length: the length of the range in bytes
+ * mode: the policy, MPOL_BIND_MODE or MPOL_INTERLEAVE_MODE
+ * nodemask: the nodes the policy may use
+ * return: true if the policy was set
+ */
+static
+bool SetMemoryPolicy(void *addr, size_t length, int mode, unsigned long nodemask)
+{
+#ifdef SYS_mbind
+    //Called directly so there is no need to link against libnuma
+    return !syscall(SYS_mbind, addr, length, mode, &nodemask, MAX_NUMA_NODES + 1, 0);
+#else
+    return false;
+#endif
+}
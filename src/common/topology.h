@@ -0,0 +1,69 @@
+#ifndef __TOPOLOGY_H__
+#define __TOPOLOGY_H__
+
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+//Largest number of NUMA nodes tracked, the width of a node mask
+#define MAX_NUMA_NODES      64
+
+//Largest number of CPUs a thread's affinity can name
+#define MAX_CPUS            1024
+
+#define NODE_ONLINE_FILE    "/sys/devices/system/node/online"
+
+/*
+ * Count the NUMA nodes of this machine
+ * return: one more than the highest online node (1 without NUMA)
+ */
+int GetNumNodes(void);
+
+/*
+ * Find the NUMA node the calling thread is running on
+ * return: the node, or 0 if it cannot be found
+ */
+int GetCurrentNode(void);
+
+/*
+ * Collect the CPUs the calling thread is allowed to run on
+ * cpus: where to store the CPU numbers, in ascending order
+ * max_cpus: the length of cpus
+ * return: the number of CPUs stored
+ */
+int GetAllowedCpus(int *cpus, int max_cpus);
+
+/*
+ * Restrict a thread to a set of CPUs
+ * thread: the thread to restrict
+ * cpus: the CPUs it may run on
+ * num_cpus: the number of CPUs
+ * return: true if the affinity was set
+ */
+bool SetThreadCpus(pthread_t thread, int *cpus, int num_cpus);
+
+/*
+ * Place the pages of a memory range on one NUMA node
+ * Must be called before the pages are first touched
+ * addr: the page aligned start of the range
+ * length: the length of the range in bytes
+ * node: the node to place the pages on
+ * return: true if the policy was set
+ */
+bool BindMemoryToNode(void *addr, size_t length, int node);
+
+/*
+ * Spread the pages of a memory range round-robin over every NUMA node
+ * Must be called before the pages are first touched
+ * addr: the page aligned start of the range
+ * length: the length of the range in bytes
+ * return: true if the policy was set
+ */
+bool InterleaveMemory(void *addr, size_t length);
+
+#endif
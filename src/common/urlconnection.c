@@ -6,19 +6,67 @@
 #define SET_CURL_USERAGENT(curl_handle) \
     curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, USERAGENT)
 
-struct pagecontents
-{
-    char *data;
-    size_t size;
-};
+/*
+ * Send a request over the session's handle and collect the response
+ * session: the session to make the request with
+ * url: the url of the request
+ * postfields: the POST data, or NULL for a GET request
+ * return: the contents of the response, or NULL if the request failed
+ */
+static
+const char *PerformRequest(HttpSession *session, char *url, char *postfields);
+
+/*
+ * Hash a state so a long poll can tell the server which one it has
+ * state: the state to hash
+ * return: the 64-bit FNV-1a hash of the state
+ */
+static
+uint64_t HashState(const char *state);
+
+/*
+ * Sleep for the given number of milliseconds
+ * milliseconds: how long to sleep
+ */
+static
+void SleepMilliseconds(int milliseconds);
+
+/*
+ * Make a one-off request and hand its response to the caller
+ * url: the url of the request
+ * postfields: the POST data, or NULL for a GET request
+ * return: the malloced contents of the response, or NULL if the request failed
+ */
+static
+char *PerformSingleRequest(char *url, char *postfields);
+
+/*
+ * Find where the first event in the text ends
+ * text: the start of an event
+ * return: the character after the blank line ending the event,
+ * or NULL if the event has not been received completely
+ */
+static
+char *FindEventEnd(char *text);
 
 /*
- * Callback function to write a URL to a pagecontents struct
+ * Hand every complete event in the session's buffer to the callback
+ * and move whatever is left of the stream to the front of the buffer
+ * session: the session listening to the stream
+ * callback: called with the data of every event
+ * userdata: passed through to the callback
+ * return: false once the callback has asked to close the stream
+ */
+static
+bool DispatchEvents(HttpSession *session, HttpEventCallback callback, void *userdata);
+
+/*
+ * Callback function to write a URL to a session's response buffer
  * contents: the contents of the URL
  * size: the number of items in the contents
  * nmemb: the size (in bytes) of each item in the contents
- * userp: a pointer to a pagecontents struct
- * return: the size (in bytes) of the page contents
+ * userp: a pointer to an HttpSession
+ * return: the size (in bytes) of the page contents, or 0 if out of memory
  */
 static
 size_t WriteMemoryCallback(
@@ -46,40 +94,337 @@ void EndConnectionSession(void)
 }
 
 /*
- * Make an HTTP GET request to the specified URL
- * url: the url where the GET request will be made
- * return: the contents of the HTTP GET
+ * Create a session with its own persistent curl handle
+ * BeginConnectionSession must have been called first
+ * return: a new HttpSession, or NULL if curl could not create a handle
  */
-char *httpGet(char *url)
+HttpSession *CreateHttpSession(void)
 {
-    CURL *curl_handle;
-    CURLcode res;
+    HttpSession *session = malloc(sizeof(*session));
 
-    struct pagecontents page;
-    page.data = malloc(1);
-    page.size = 0;
+    if (!session) return NULL;
 
-    //Initialize the curl handle
-    curl_handle = curl_easy_init();
+    session->handle = curl_easy_init();
+    session->data = malloc(HTTP_BUFFER_SIZE);
+    session->size = 0;
+    session->capacity = HTTP_BUFFER_SIZE;
+    session->events = 0;
+    if (!session->handle || !session->data)
+    {
+        DestroyHttpSession(session);
+        return NULL;
+    }
+    session->data[0] = '\0';
 
     //Set user agent in case server requires it
-    SET_CURL_USERAGENT(curl_handle);
+    SET_CURL_USERAGENT(session->handle);
 
-    //Set URL and write callback
-    curl_easy_setopt(curl_handle, CURLOPT_URL, url);
-    curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void *)&page);
+    //Every response lands in the session's buffer
+    curl_easy_setopt(session->handle, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
+    curl_easy_setopt(session->handle, CURLOPT_WRITEDATA, (void *)session);
 
-    //Perform the HTTP GET
-    res = curl_easy_perform(curl_handle);
-    if (res != CURLE_OK)
+    //Keep idle connections open between polls
+    curl_easy_setopt(session->handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(session->handle, CURLOPT_TCP_KEEPIDLE, (long)HTTP_KEEPALIVE_IDLE);
+    curl_easy_setopt(session->handle, CURLOPT_TCP_KEEPINTVL, (long)HTTP_KEEPALIVE_IDLE);
+
+    return session;
+}
+
+/*
+ * Close the session's connections and free it
+ * session: the session to destroy
+ */
+void DestroyHttpSession(HttpSession *session)
+{
+    if (!session) return;
+
+    if (session->handle)
     {
-        PRINTERR("HTTP GET failed: %s\n", curl_easy_strerror(res));
+        curl_easy_cleanup(session->handle);
     }
 
-    //Clean up the curl handle and return the page contents
-    curl_easy_cleanup(curl_handle);
-    return page.data;
+    free(session->data);
+    free(session);
+}
+
+/*
+ * Make an HTTP GET request over the session's connection
+ * session: the session to make the request with
+ * url: the url where the GET request will be made
+ * return: the contents of the HTTP GET, owned by the session and valid
+ * until its next request, or NULL if the request failed
+ */
+const char *HttpSessionGet(HttpSession *session, char *url)
+{
+    return PerformRequest(session, url, NULL);
+}
+
+/*
+ * Make an HTTP POST request over the session's connection
+ * session: the session to make the request with
+ * url: the url where the POST request will be made
+ * postfields: the POST data
+ * return: the contents of the HTTP POST, owned by the session and valid
+ * until its next request, or NULL if the request failed
+ */
+const char *HttpSessionPost(HttpSession *session, char *url, char *postfields)
+{
+    return PerformRequest(session, url, postfields);
+}
+
+/*
+ * Create a poller for the state at a URL
+ * session: the session to poll over, which the caller keeps ownership of
+ * url: the url of the state
+ * long_poll: true if the server can hold a request until the state changes
+ * return: a new StatePoller, or NULL if it could not be allocated
+ */
+StatePoller *CreateStatePoller(HttpSession *session, const char *url, bool long_poll)
+{
+    StatePoller *poller = malloc(sizeof(*poller));
+
+    if (!poller) return NULL;
+
+    //Room for the url, a separator and since= with 16 hex digits
+    poller->session = session;
+    poller->url = strdup(url);
+    poller->request_url = malloc(strlen(url) + 32);
+    poller->long_poll = long_poll;
+    poller->last = NULL;
+    poller->version = 0;
+    poller->delay = 0;
+    if (!poller->url || !poller->request_url)
+    {
+        DestroyStatePoller(poller);
+        return NULL;
+    }
+
+    return poller;
+}
+
+/*
+ * Free a poller
+ * poller: the poller to destroy
+ */
+void DestroyStatePoller(StatePoller *poller)
+{
+    if (!poller) return;
+
+    free(poller->url);
+    free(poller->request_url);
+    free(poller->last);
+    free(poller);
+}
+
+/*
+ * Wait until the next poll is due, then GET the state
+ * A changed state is polled again soon, at once when long polling, and a
+ * state that stays the same is polled less and less often up to MAX_POLL_MS,
+ * which also paces long polls against a server that answers at once
+ * poller: the poller to poll with
+ * changed: where to store whether the state differs from the last one (may be NULL)
+ * return: the state, owned by the poller's session and valid until its next
+ * request, or NULL if the request failed
+ */
+const char *PollState(StatePoller *poller, bool *changed)
+{
+    const char *state;
+    bool different;
+
+    if (poller->delay > 0)
+    {
+        SleepMilliseconds(poller->delay);
+    }
+
+    //Only a long poll that has seen a state can ask for a newer one
+    if (poller->long_poll && poller->last)
+    {
+        sprintf(poller->request_url, "%s%csince=%016llx", poller->url,
+                strchr(poller->url, '?') ? '&' : '?', (unsigned long long)poller->version);
+    }
+    else
+    {
+        strcpy(poller->request_url, poller->url);
+    }
+
+    state = HttpSessionGet(poller->session, poller->request_url);
+    if (!state) return NULL;
+
+    different = !poller->last || strcmp(state, poller->last);
+    if (different)
+    {
+        free(poller->last);
+        poller->last = strdup(state);
+        poller->version = HashState(state);
+        HurryStatePoller(poller);
+    }
+    else
+    {
+        //Double the wait, starting from the shortest after a long poll
+        poller->delay = poller->delay * 2 > MIN_POLL_MS ? poller->delay * 2 : MIN_POLL_MS;
+        poller->delay = poller->delay < MAX_POLL_MS ? poller->delay : MAX_POLL_MS;
+    }
+
+    if (changed) *changed = different;
+    return state;
+}
+
+/*
+ * Poll again soon, such as after acting on the state
+ * poller: the poller to hurry
+ */
+void HurryStatePoller(StatePoller *poller)
+{
+    //A long poll waits on the server instead
+    poller->delay = poller->long_poll ? 0 : MIN_POLL_MS;
+}
+
+/*
+ * Listen to a stream of server-sent events over the session's connection
+ * Each event is handed to the callback the moment its last chunk arrives
+ * session: the session to listen with, it cannot make other requests meanwhile
+ * url: the url of the event stream
+ * callback: called with the data of every event
+ * userdata: passed through to the callback
+ * return: true if the stream ended, went idle or was closed by the callback,
+ * false if it could not be opened or failed
+ */
+bool HttpSessionStream(
+        HttpSession *session,
+        char *url,
+        HttpEventCallback callback,
+        void *userdata)
+{
+    CURLM *multi = curl_multi_init();
+    struct curl_slist *headers = curl_slist_append(NULL, "Accept: text/event-stream");
+    CURLMsg *message;
+    CURLcode res = CURLE_OK;
+    long status = 0;
+    int running = 1;
+    int queued;
+    bool listening = true;
+    bool failed = false;
+
+    if (!multi || !headers)
+    {
+        curl_slist_free_all(headers);
+        if (multi) curl_multi_cleanup(multi);
+        return false;
+    }
+
+    session->size = 0;
+    session->data[0] = '\0';
+    session->events = 0;
+
+    //Drop the stream if even the server's heartbeats stop
+    curl_easy_setopt(session->handle, CURLOPT_URL, url);
+    curl_easy_setopt(session->handle, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(session->handle, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(session->handle, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(session->handle, CURLOPT_LOW_SPEED_TIME, (long)HTTP_STREAM_IDLE);
+    curl_multi_add_handle(multi, session->handle);
+
+    //Sleep in the kernel until data arrives, then dispatch it at once
+    while (listening && running)
+    {
+        if (curl_multi_perform(multi, &running) != CURLM_OK)
+        {
+            failed = true;
+            break;
+        }
+
+        listening = DispatchEvents(session, callback, userdata);
+        if (listening && running)
+        {
+            curl_multi_wait(multi, NULL, 0, HTTP_STREAM_POLL_MS, NULL);
+        }
+    }
+
+    //Find out how the transfer ended, unless the callback closed it
+    while ((message = curl_multi_info_read(multi, &queued)))
+    {
+        if (message->msg == CURLMSG_DONE)
+        {
+            res = message->data.result;
+        }
+    }
+    curl_easy_getinfo(session->handle, CURLINFO_RESPONSE_CODE, &status);
+
+    curl_multi_remove_handle(multi, session->handle);
+    curl_multi_cleanup(multi);
+
+    //Leave the handle as the other requests expect it
+    curl_easy_setopt(session->handle, CURLOPT_HTTPHEADER, NULL);
+    curl_easy_setopt(session->handle, CURLOPT_LOW_SPEED_LIMIT, 0L);
+    curl_easy_setopt(session->handle, CURLOPT_LOW_SPEED_TIME, 0L);
+    curl_slist_free_all(headers);
+
+    if (failed || (res != CURLE_OK && res != CURLE_OPERATION_TIMEDOUT))
+    {
+        PRINTERR("HTTP stream failed: %s\n", curl_easy_strerror(res));
+        return false;
+    }
+
+    if (status >= 400)
+    {
+        PRINTERR("HTTP stream failed: status %ld\n", status);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Wait out the delay, then listen to a stream of server-sent events
+ * The delay is cleared once the stream has dispatched an event, and
+ * otherwise doubles from MIN_POLL_MS up to MAX_POLL_MS, so a stream
+ * that ends at once or fails is not reopened in a busy loop
+ * session: the session to listen with, it cannot make other requests meanwhile
+ * url: the url of the event stream
+ * callback: called with the data of every event
+ * userdata: passed through to the callback
+ * delay: milliseconds to wait first, 0 for the first connection,
+ * updated with the wait before the next one
+ * return: the result of HttpSessionStream
+ */
+bool ListenToStream(
+        HttpSession *session,
+        char *url,
+        HttpEventCallback callback,
+        void *userdata,
+        int *delay)
+{
+    bool ok;
+
+    if (*delay > 0)
+    {
+        SleepMilliseconds(*delay);
+    }
+
+    ok = HttpSessionStream(session, url, callback, userdata);
+    if (session->events > 0)
+    {
+        *delay = 0;
+    }
+    else
+    {
+        *delay = *delay * 2 > MIN_POLL_MS ? *delay * 2 : MIN_POLL_MS;
+        *delay = *delay < MAX_POLL_MS ? *delay : MAX_POLL_MS;
+    }
+
+    return ok;
+}
+
+/*
+ * Make an HTTP GET request to the specified URL
+ * Uses a new connection, prefer an HttpSession for repeated requests
+ * url: the url where the GET request will be made
+ * return: the contents of the HTTP GET, or NULL if the request failed
+ */
+char *httpGet(char *url)
+{
+    return PerformSingleRequest(url, NULL);
 }
 
 /*
@@ -91,7 +436,7 @@ char *httpGet(char *url)
 cJSON *httpGetJSON(char *url)
 {
     char *contents = httpGet(url);
-    cJSON *json = cJSON_Parse(contents);
+    cJSON *json = contents ? cJSON_Parse(contents) : NULL;
 
     free(contents);
     return json;
@@ -99,41 +444,14 @@ cJSON *httpGetJSON(char *url)
 
 /*
  * Make an HTTP POST request to the specified URL
+ * Uses a new connection, prefer an HttpSession for repeated requests
  * url: the url where the POST request will be made
  * postfields: the POST data
- * return: the contents of the HTTP POST
+ * return: the contents of the HTTP POST, or NULL if the request failed
  */
 char *httpPost(char *url, char *postfields)
 {
-    CURL *curl_handle;
-    CURLcode res;
-
-    struct pagecontents page;
-    page.data = malloc(1);
-    page.size = 0;
-
-    //Initialize the curl handle
-    curl_handle = curl_easy_init();
-
-    //Set user agent in case server requires it
-    SET_CURL_USERAGENT(curl_handle);
-
-    //Set URL and write callback
-    curl_easy_setopt(curl_handle, CURLOPT_URL, url);
-    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, postfields);
-    curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void *)&page);
-
-    //Perform the HTTP POST
-    res = curl_easy_perform(curl_handle);
-    if (res != CURLE_OK)
-    {
-        PRINTERR("HTTP POST failed: %s\n", curl_easy_strerror(res));
-    }
-
-    //Clean up the curl handle and return the page contents
-    curl_easy_cleanup(curl_handle);
-    return page.data;
+    return PerformSingleRequest(url, postfields);
 }
 
 /*
@@ -146,19 +464,201 @@ char *httpPost(char *url, char *postfields)
 cJSON *httpPostJSON(char *url, char *postfields)
 {
     char *contents = httpPost(url, postfields);
-    cJSON *json = cJSON_Parse(contents);
+    cJSON *json = contents ? cJSON_Parse(contents) : NULL;
 
     free(contents);
     return json;
 }
 
 /*
- * Callback function to write a URL to a pagecontents struct
+ * Send a request over the session's handle and collect the response
+ * session: the session to make the request with
+ * url: the url of the request
+ * postfields: the POST data, or NULL for a GET request
+ * return: the contents of the response, or NULL if the request failed
+ */
+static
+const char *PerformRequest(HttpSession *session, char *url, char *postfields)
+{
+    CURLcode res;
+
+    //Reuse the buffer from the last response
+    session->size = 0;
+    session->data[0] = '\0';
+
+    //Options stick to the handle, so a GET has to undo an earlier POST
+    curl_easy_setopt(session->handle, CURLOPT_URL, url);
+    if (postfields)
+    {
+        curl_easy_setopt(session->handle, CURLOPT_POSTFIELDS, postfields);
+    }
+    else
+    {
+        curl_easy_setopt(session->handle, CURLOPT_HTTPGET, 1L);
+    }
+
+    //Perform the request, over a kept-alive connection when there is one
+    res = curl_easy_perform(session->handle);
+    if (res != CURLE_OK)
+    {
+        PRINTERR("HTTP %s failed: %s\n", postfields ? "POST" : "GET", curl_easy_strerror(res));
+        return NULL;
+    }
+
+    return session->data;
+}
+
+/*
+ * Hash a state so a long poll can tell the server which one it has
+ * state: the state to hash
+ * return: the 64-bit FNV-1a hash of the state
+ */
+static
+uint64_t HashState(const char *state)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (const unsigned char *c = (const unsigned char *)state; *c; c++)
+    {
+        hash = (hash ^ *c) * 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+/*
+ * Sleep for the given number of milliseconds
+ * milliseconds: how long to sleep
+ */
+static
+void SleepMilliseconds(int milliseconds)
+{
+    struct timespec duration;
+
+    duration.tv_sec = milliseconds / 1000;
+    duration.tv_nsec = (milliseconds % 1000) * 1000000L;
+    nanosleep(&duration, NULL);
+}
+
+/*
+ * Make a one-off request and hand its response to the caller
+ * url: the url of the request
+ * postfields: the POST data, or NULL for a GET request
+ * return: the malloced contents of the response, or NULL if the request failed
+ */
+static
+char *PerformSingleRequest(char *url, char *postfields)
+{
+    HttpSession *session = CreateHttpSession();
+    char *contents = NULL;
+
+    if (!session) return NULL;
+
+    //Take the buffer instead of copying it
+    if (PerformRequest(session, url, postfields))
+    {
+        contents = session->data;
+        session->data = NULL;
+    }
+
+    DestroyHttpSession(session);
+    return contents;
+}
+
+/*
+ * Find where the first event in the text ends
+ * text: the start of an event
+ * return: the character after the blank line ending the event,
+ * or NULL if the event has not been received completely
+ */
+static
+char *FindEventEnd(char *text)
+{
+    char *line = text;
+    char *next;
+
+    //Lines may end with either LF or CRLF
+    while ((next = strchr(line, '\n')))
+    {
+        if (next == line || (next == line + 1 && *line == '\r'))
+        {
+            return next + 1;
+        }
+        line = next + 1;
+    }
+
+    return NULL;
+}
+
+/*
+ * Hand every complete event in the session's buffer to the callback
+ * and move whatever is left of the stream to the front of the buffer
+ * session: the session listening to the stream
+ * callback: called with the data of every event
+ * userdata: passed through to the callback
+ * return: false once the callback has asked to close the stream
+ */
+static
+bool DispatchEvents(HttpSession *session, HttpEventCallback callback, void *userdata)
+{
+    char *event = session->data;
+    char *end;
+    char *line;
+    char *next;
+    char *data;
+    size_t length;
+    bool listening = true;
+
+    while (listening && (end = FindEventEnd(event)))
+    {
+        //Gather the data lines at the start of the event, in place
+        data = event;
+        for (line = event; line < end; line = next + 1)
+        {
+            next = strchr(line, '\n');
+            length = next - line;
+            if (length > 0 && line[length - 1] == '\r') length--;
+
+            //Comments and other fields, such as event and id, are skipped
+            if (length < 5 || strncmp(line, "data:", 5)) continue;
+
+            line += 5;
+            length -= 5;
+            if (length > 0 && *line == ' ')
+            {
+                line++;
+                length--;
+            }
+
+            memmove(data, line, length);
+            data += length;
+            *data++ = '\n';
+        }
+
+        //Heartbeats carry no data and are not dispatched
+        if (data > event)
+        {
+            data[-1] = '\0';
+            session->events++;
+            listening = callback(event, userdata);
+        }
+
+        event = end;
+    }
+
+    session->size -= event - session->data;
+    memmove(session->data, event, session->size + 1);
+
+    return listening;
+}
+
+/*
+ * Callback function to write a URL to a session's response buffer
  * contents: the contents of the URL
  * size: the number of items in the contents
  * nmemb: the size (in bytes) of each item in the contents
- * userp: a pointer to a pagecontents struct
- * return: the size (in bytes) of the page contents
+ * userp: a pointer to an HttpSession
+ * return: the size (in bytes) of the page contents, or 0 if out of memory
  */
 static
 size_t WriteMemoryCallback(
@@ -168,13 +668,29 @@ size_t WriteMemoryCallback(
         void *userp)
 {
     size_t realsize = size * nmemb;
-    struct pagecontents *page = (struct pagecontents *)userp;
+    HttpSession *session = (HttpSession *)userp;
+    size_t capacity = session->capacity;
+    char *data;
+
+    //Double the buffer when it is full, it is kept for the next response
+    while (session->size + realsize + 1 > capacity)
+    {
+        capacity *= 2;
+    }
+
+    if (capacity != session->capacity)
+    {
+        data = realloc(session->data, capacity);
+        if (!data) return 0;
+
+        session->data = data;
+        session->capacity = capacity;
+    }
 
-    page->data = realloc(page->data, page->size + realsize + 1);
-    memcpy(&(page->data[page->size]), contents, realsize);
+    memcpy(&(session->data[session->size]), contents, realsize);
 
-    page->size += realsize;
-    page->data[page->size] = '\0';
+    session->size += realsize;
+    session->data[session->size] = '\0';
 
     return realsize;
 }
@@ -1,13 +1,78 @@
 #ifndef __URL_CONNECTION_H__
 #define __URL_CONNECTION_H__
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <curl/curl.h>
 
 #include "cJSON.h"
 
+//Size of a session's response buffer before its first request
+#define HTTP_BUFFER_SIZE    4096
+
+//Seconds a kept-alive connection may idle before TCP probes it
+#define HTTP_KEEPALIVE_IDLE 30
+
+//Seconds a stream may go without a byte, heartbeats included, before it is dropped
+#define HTTP_STREAM_IDLE    30
+
+//Longest a stream waits for data before checking on the transfer, in milliseconds
+#define HTTP_STREAM_POLL_MS 1000
+
+//Polling backs off from the shortest to the longest delay
+//while the polled state stays the same, and so does reconnecting
+//to a stream that ends without an event, in milliseconds
+#define MIN_POLL_MS 50
+#define MAX_POLL_MS 1000
+
+//A persistent connection for repeated requests, such as polling a server
+//The curl handle keeps its connections, DNS cache and TLS sessions
+//between requests, and the response buffer is reused
+typedef struct httpsession
+{
+    CURL *handle;
+
+    //The last response, always terminated
+    char *data;
+    size_t size;
+    size_t capacity;
+
+    //Events dispatched by the last stream
+    long events;
+} HttpSession;
+
+//Paces repeated GETs of a state that changes now and then, such as a game
+//A long poll sends a hash of the last state it saw as since=, so a server
+//can hold the request until its state no longer has that hash
+typedef struct statepoller
+{
+    HttpSession *session;
+    char *url;
+    bool long_poll;
+
+    //The URL of the next request, with since= added for long polls
+    char *request_url;
+
+    //The last state received and its hash
+    char *last;
+    uint64_t version;
+
+    //How long to wait before the next GET, in milliseconds
+    int delay;
+} StatePoller;
+
+/*
+ * Called with each server-sent event received by HttpSessionStream
+ * data: the event's data lines, joined by newlines
+ * userdata: the pointer given to HttpSessionStream
+ * return: true to keep listening, false to close the stream
+ */
+typedef bool (*HttpEventCallback)(const char *data, void *userdata);
+
 /*
  * Begin the URL connection session
  * This should only be called once
@@ -20,10 +85,112 @@ void BeginConnectionSession(void);
  */
 void EndConnectionSession(void);
 
+/*
+ * Create a session with its own persistent curl handle
+ * BeginConnectionSession must have been called first
+ * return: a new HttpSession, or NULL if curl could not create a handle
+ */
+HttpSession *CreateHttpSession(void);
+
+/*
+ * Close the session's connections and free it
+ * session: the session to destroy
+ */
+void DestroyHttpSession(HttpSession *session);
+
+/*
+ * Make an HTTP GET request over the session's connection
+ * session: the session to make the request with
+ * url: the url where the GET request will be made
+ * return: the contents of the HTTP GET, owned by the session and valid
+ * until its next request, or NULL if the request failed
+ */
+const char *HttpSessionGet(HttpSession *session, char *url);
+
+/*
+ * Make an HTTP POST request over the session's connection
+ * session: the session to make the request with
+ * url: the url where the POST request will be made
+ * postfields: the POST data
+ * return: the contents of the HTTP POST, owned by the session and valid
+ * until its next request, or NULL if the request failed
+ */
+const char *HttpSessionPost(HttpSession *session, char *url, char *postfields);
+
+/*
+ * Listen to a stream of server-sent events over the session's connection
+ * Each event is handed to the callback the moment its last chunk arrives
+ * session: the session to listen with, it cannot make other requests meanwhile
+ * url: the url of the event stream
+ * callback: called with the data of every event
+ * userdata: passed through to the callback
+ * return: true if the stream ended, went idle or was closed by the callback,
+ * false if it could not be opened or failed
+ */
+bool HttpSessionStream(
+        HttpSession *session,
+        char *url,
+        HttpEventCallback callback,
+        void *userdata);
+
+/*
+ * Wait out the delay, then listen to a stream of server-sent events
+ * The delay is cleared once the stream has dispatched an event, and
+ * otherwise doubles from MIN_POLL_MS up to MAX_POLL_MS, so a stream
+ * that ends at once or fails is not reopened in a busy loop
+ * session: the session to listen with, it cannot make other requests meanwhile
+ * url: the url of the event stream
+ * callback: called with the data of every event
+ * userdata: passed through to the callback
+ * delay: milliseconds to wait first, 0 for the first connection,
+ * updated with the wait before the next one
+ * return: the result of HttpSessionStream
+ */
+bool ListenToStream(
+        HttpSession *session,
+        char *url,
+        HttpEventCallback callback,
+        void *userdata,
+        int *delay);
+
+/*
+ * Create a poller for the state at a URL
+ * session: the session to poll over, which the caller keeps ownership of
+ * url: the url of the state
+ * long_poll: true if the server can hold a request until the state changes
+ * return: a new StatePoller, or NULL if it could not be allocated
+ */
+StatePoller *CreateStatePoller(HttpSession *session, const char *url, bool long_poll);
+
+/*
+ * Free a poller
+ * poller: the poller to destroy
+ */
+void DestroyStatePoller(StatePoller *poller);
+
+/*
+ * Wait until the next poll is due, then GET the state
+ * A changed state is polled again soon, at once when long polling, and a
+ * state that stays the same is polled less and less often up to MAX_POLL_MS,
+ * which also paces long polls against a server that answers at once
+ * poller: the poller to poll with
+ * changed: where to store whether the state differs from the last one (may be NULL)
+ * return: the state, owned by the poller's session and valid until its next
+ * request, or NULL if the request failed
+ */
+const char *PollState(StatePoller *poller, bool *changed);
+
+/*
+ * Poll again soon, such as after acting on the state
+ * poller: the poller to hurry
+ */
+void HurryStatePoller(StatePoller *poller);
+
 /*
  * Make an HTTP GET request to the specified URL
+ * Uses a new connection, prefer an HttpSession for repeated requests
  * url: the url where the GET request will be made
- * return: the contents of the HTTP GET
+ * return: the contents of the HTTP GET, or NULL if the request failed
  */
 char *httpGet(char *url);
 
@@ -37,9 +204,10 @@ cJSON *httpGetJSON(char *url);
 
 /*
  * Make an HTTP POST request to the specified URL
+ * Uses a new connection, prefer an HttpSession for repeated requests
  * url: the url where the POST request will be made
  * postfields: the POST data
- * return: the contents of the HTTP POST
+ * return: the contents of the HTTP POST, or NULL if the request failed
  */
 char *httpPost(char *url, char *postfields);
 
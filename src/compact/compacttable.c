@@ -0,0 +1,41 @@
+#include <stdio.h>
+
+#include "evaluator.h"
+
+int main(int argc, char **argv)
+{
+    char *handranksfile = DEFAULT_HANDRANKS_FILE;
+    char *compactfile = DEFAULT_COMPACT_FILE;
+
+    if (argc > 3)
+    {
+        fprintf(stderr, "Usage: ./compacttable [HANDRANKS.DAT] [HANDRANKS16.DAT]\n");
+        fprintf(stderr, "\tConverts the 2+2 lookup table into the compact 16-bit format\n");
+        exit(1);
+    }
+
+    if (argc > 1)
+    {
+        handranksfile = argv[1];
+    }
+    if (argc > 2)
+    {
+        compactfile = argv[2];
+    }
+
+    InitEvaluatorWithFlags(handranksfile, LOAD_MMAP | LOAD_POPULATE);
+    if (HANDRANKS_FORMAT != FORMAT_TWO_PLUS_TWO)
+    {
+        fprintf(stderr, "%s is already a compact table\n", handranksfile);
+        exit(1);
+    }
+
+    if (!WriteCompactRanks(compactfile))
+    {
+        fprintf(stderr, "Could not write %s\n", compactfile);
+        exit(1);
+    }
+
+    DestroyEvaluator();
+    return 0;
+}
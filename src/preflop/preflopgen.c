@@ -0,0 +1,302 @@
+#include <stdio.h>
+
+#include "enumerator.h"
+#include "evaluator.h"
+#include "gamestate.h"
+#include "preflop.h"
+#include "random.h"
+#include "threadpool.h"
+
+#define DEFAULT_NUM_GAMES   1000000
+#define RANK_CHARS          "23456789TJQKA"
+#define SUIT_CHARS          "SCDH"
+
+typedef struct pregenjob
+{
+    long long num_games;
+    int num_threads;
+
+    //Enumerate the heads up entries instead of sampling them
+    bool exact;
+    double equity[NUM_PREFLOP_CLASSES][MAX_PREFLOP_OPPONENTS];
+} PregenJob;
+
+/*
+ * Build a representative pair of hole cards for a starting hand class
+ * cls: the class index
+ * hand: where to store the two hole cards
+ */
+static
+void ClassHand(int cls, int *hand);
+
+/*
+ * Write the name of a starting hand class, such as "AKs" or "T9o"
+ * cls: the class index
+ * name: a buffer of at least 4 chars
+ */
+static
+void ClassName(int cls, char *name);
+
+/*
+ * Sample all-in games for one starting hand and count the wins
+ * hand: the hero's hole cards
+ * num_opponents: the number of random opponents
+ * num_games: how many games to sample
+ * rng: the random number generator of the calling thread
+ * return: the fraction of games won (ties count as wins)
+ */
+static
+double SamplePreflop(int *hand, int num_opponents, long long num_games, RandomState *rng);
+
+/*
+ * Play out every heads up all-in deal for one starting hand
+ * Boards that only differ by suits the hand does not tell apart
+ * are enumerated once, so this takes seconds rather than minutes
+ * hand: the hero's hole cards
+ * return: the fraction of deals won (ties count as wins)
+ */
+static
+double EnumeratePreflop(int *hand);
+
+/*
+ * Fill in every class assigned to one worker
+ * _job: a void pointer to the PregenJob
+ * worker: the index of the worker (classes are striped across workers)
+ */
+static
+void GenerateClasses(void *_job, int worker);
+
+int main(int argc, char **argv)
+{
+    char *handranksfile = DEFAULT_HANDRANKS_FILE;
+    char name[4];
+    PregenJob *job = malloc(sizeof(*job));
+    ThreadPool *pool;
+    FILE *out = stdout;
+
+    job->exact = argc > 1 && !strcmp(argv[1], "--exact");
+    if (job->exact)
+    {
+        argv++;
+        argc--;
+    }
+
+    if (argc > 3)
+    {
+        fprintf(stderr, "Usage: ./preflopgen [--exact] [games_per_entry] [output.c]\n");
+        fprintf(stderr, "\tWrites the C source of the PREFLOP_EQUITY table\n");
+        fprintf(stderr, "\tWith --exact, heads up entries are enumerated instead of sampled\n");
+        exit(1);
+    }
+
+    job->num_games = argc > 1 ? atoll(argv[1]) : DEFAULT_NUM_GAMES;
+    job->num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (argc > 2 && !(out = fopen(argv[2], "w")))
+    {
+        fprintf(stderr, "Could not open %s\n", argv[2]);
+        exit(1);
+    }
+
+    InitEvaluatorWithFlags(handranksfile, LOAD_MMAP | LOAD_POPULATE);
+
+    pool = CreateThreadPool(job->num_threads);
+    ThreadPoolRun(pool, GenerateClasses, job);
+    DestroyThreadPool(pool);
+
+    fprintf(out, "/*\n");
+    fprintf(out, " * Generated by bin/preflopgen with %lld games per entry -- do not edit\n", job->num_games);
+    if (job->exact)
+    {
+        fprintf(out, " * Heads up entries are exact\n");
+    }
+    fprintf(out, " * Win probability (ties count as wins) of each starting hand class\n");
+    fprintf(out, " * against 1 to %d random opponents\n", MAX_PREFLOP_OPPONENTS);
+    fprintf(out, " */\n");
+    fprintf(out, "#include \"preflop.h\"\n\n");
+    fprintf(out, "const float PREFLOP_EQUITY[NUM_PREFLOP_CLASSES][MAX_PREFLOP_OPPONENTS] =\n{\n");
+    for (int cls = 0; cls < NUM_PREFLOP_CLASSES; cls++)
+    {
+        ClassName(cls, name);
+        fprintf(out, "    /* %-3s */ {", name);
+        for (int opp = 0; opp < MAX_PREFLOP_OPPONENTS; opp++)
+        {
+            fprintf(out, "%s%.4ff", opp ? ", " : "", job->equity[cls][opp]);
+        }
+        fprintf(out, "}%s\n", cls + 1 < NUM_PREFLOP_CLASSES ? "," : "");
+    }
+    fprintf(out, "};\n");
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    free(job);
+    return 0;
+}
+
+/*
+ * Build a representative pair of hole cards for a starting hand class
+ * cls: the class index
+ * hand: where to store the two hole cards
+ */
+static
+void ClassHand(int cls, int *hand)
+{
+    int row = cls / NUM_RANKS;
+    int col = cls % NUM_RANKS;
+
+    //Suited classes have row > col, see PreflopClass
+    hand[0] = 4 * row + 1;
+    hand[1] = 4 * col + 1;
+    if (row <= col)
+    {
+        hand[1] += 1;
+    }
+}
+
+/*
+ * Write the name of a starting hand class, such as "AKs" or "T9o"
+ * cls: the class index
+ * name: a buffer of at least 4 chars
+ */
+static
+void ClassName(int cls, char *name)
+{
+    int row = cls / NUM_RANKS;
+    int col = cls % NUM_RANKS;
+    int high = row > col ? row : col;
+    int low  = row > col ? col : row;
+
+    name[0] = RANK_CHARS[high];
+    name[1] = RANK_CHARS[low];
+    name[2] = (row == col) ? '\0' : (row > col ? 's' : 'o');
+    name[3] = '\0';
+}
+
+/*
+ * Sample all-in games for one starting hand and count the wins
+ * hand: the hero's hole cards
+ * num_opponents: the number of random opponents
+ * num_games: how many games to sample
+ * rng: the random number generator of the calling thread
+ * return: the fraction of games won (ties count as wins)
+ */
+static
+double SamplePreflop(int *hand, int num_opponents, long long num_games, RandomState *rng)
+{
+    GameState game;
+    int live[NUM_DECK];
+    int deck[NUM_DECK];
+    int community[NUM_COMMUNITY];
+    int opponent[NUM_HAND];
+    int num_live;
+    int decksize;
+    BoardState board;
+    int myscore;
+    int score;
+    int best;
+    long long won = 0;
+
+    memcpy(game.hand, hand, sizeof(game.hand));
+    game.handsize = NUM_HAND;
+    game.communitysize = 0;
+    UpdateGameDeck(&game);
+    num_live = GetLiveCards(&game, live);
+
+    for (long long g = 0; g < num_games; g++)
+    {
+        memcpy(deck, live, sizeof(*deck) * num_live);
+        decksize = num_live;
+
+        for (int i = 0; i < NUM_COMMUNITY; i++)
+        {
+            community[i] = DrawCard(rng, deck, &decksize);
+        }
+
+        StartBoard(&board);
+        AddBoardCards(&board, community, NUM_COMMUNITY);
+        myscore = GetHandValueOnBoard(&board, hand);
+
+        best = 0;
+        for (int opp = 0; opp < num_opponents && best <= myscore; opp++)
+        {
+            for (int i = 0; i < NUM_HAND; i++)
+            {
+                opponent[i] = DrawCard(rng, deck, &decksize);
+            }
+
+            score = GetHandValueOnBoard(&board, opponent);
+            if (score > best)
+            {
+                best = score;
+            }
+        }
+
+        won += (myscore >= best);
+    }
+
+    return (double)won / num_games;
+}
+
+/*
+ * Play out every heads up all-in deal for one starting hand
+ * Boards that only differ by suits the hand does not tell apart
+ * are enumerated once, so this takes seconds rather than minutes
+ * hand: the hero's hole cards
+ * return: the fraction of deals won (ties count as wins)
+ */
+static
+double EnumeratePreflop(int *hand)
+{
+    GameState game;
+    long long won;
+    long long deals;
+
+    memcpy(game.hand, hand, sizeof(game.hand));
+    game.handsize = NUM_HAND;
+    game.communitysize = 0;
+    game.num_playing = 1;
+    UpdateGameDeck(&game);
+
+    deals = EnumerateDeals(&game, &won);
+    return (double)won / deals;
+}
+
+/*
+ * Fill in every class assigned to one worker
+ * _job: a void pointer to the PregenJob
+ * worker: the index of the worker (classes are striped across workers)
+ */
+static
+void GenerateClasses(void *_job, int worker)
+{
+    PregenJob *job = (PregenJob *)_job;
+    RandomState rng;
+    int hand[NUM_HAND];
+    char name[4];
+
+    UseLocalHandRanks();
+
+    for (int cls = worker; cls < NUM_PREFLOP_CLASSES; cls += job->num_threads)
+    {
+        //Seeding by class keeps the table the same whatever the number of workers
+        SeedRandom(&rng, cls);
+        ClassHand(cls, hand);
+        for (int opp = 0; opp < MAX_PREFLOP_OPPONENTS; opp++)
+        {
+            if (opp == 0 && job->exact)
+            {
+                job->equity[cls][opp] = EnumeratePreflop(hand);
+            }
+            else
+            {
+                job->equity[cls][opp] = SamplePreflop(hand, opp + 1, job->num_games, &rng);
+            }
+        }
+
+        ClassName(cls, name);
+        fprintf(stderr, "[Worker %d] %-3s done\n", worker, name);
+    }
+}
@@ -6,24 +6,119 @@
 #define DEFAULT_NUM_PLAYING 3
 #define TIMEOUT             1000
 
+//With a cache, a single spot stops simulating once it is this precise,
+//so a spot cached with enough games returns without simulating
+#define CACHE_TARGET_ERROR  0.001
+
+//Batch mode reads this many spots before handing them to the workers
+#define BATCH_SIZE          1024
+#define MAX_LINE            256
+#define RANK_CHARS          "23456789TJQKA"
+#define SUIT_CHARS          "SCDH"
+
+/*
+ * Evaluate every spot read from the given file, one per line,
+ * and write one result line per spot to stdout
+ * AI: the AI whose workers evaluate the spots
+ * in: the file to read spots from
+ * games: how many games to simulate for each spot that is not enumerated
+ */
+static
+void RunBatch(PokerAI *AI, FILE *in, long long games);
+
+/*
+ * Parse a spot written like the command line arguments,
+ * such as "AH KD 2C 7S 9H -n3"
+ * line: the spot to parse (modified by tokenizing)
+ * query: where to store the spot
+ * return: true if the spot is valid
+ */
+static
+bool ParseSpot(char *line, EquityQuery *query);
+
+/*
+ * Check that a string names a card, such as "AH" or "7C"
+ * card: the string to check
+ * return: true if the string is a card
+ */
+static
+bool ValidCard(char *card);
+
+/*
+ * Write the cache back to its file and free it
+ * cache: the cache to save (may be NULL)
+ * cachefile: the file the cache was loaded from
+ */
+static
+void CloseCache(EquityCache *cache, char *cachefile);
+
 int main(int argc, char **argv)
 {
     char *handranksfile = DEFAULT_HANDRANKS_FILE;
+    char *cachefile = NULL;
+    EquityCache *cache = NULL;
     char *hand[NUM_HAND];
     char *community[NUM_COMMUNITY];
     char *last_arg;
     int num_community = argc - 3;
     int num_playing = DEFAULT_NUM_PLAYING;
-    int simulated;
+    long long simulated;
     double winprob;
     PokerAI *AI;
 
     InitEvaluator(handranksfile);
 
+    //Results are kept between runs in the given file
+    if (argc > 2 && !strcmp(argv[1], "--cache"))
+    {
+        cachefile = argv[2];
+        cache = CreateEquityCache(DEFAULT_CACHE_ENTRIES);
+        LoadEquityCache(cache, cachefile);
+
+        argv += 2;
+        argc -= 2;
+        num_community -= 2;
+    }
+
+    if (argc > 1 && !strcmp(argv[1], "--batch"))
+    {
+        FILE *in = stdin;
+        long long games = DEFAULT_BATCH_GAMES;
+
+        for (int i = 2; i < argc; i++)
+        {
+            if (!strncmp(argv[i], "-g", strlen("-g")))
+            {
+                games = atoll(argv[i] + strlen("-g"));
+            }
+            else if (in == stdin && !(in = fopen(argv[i], "r")))
+            {
+                fprintf(stderr, "Could not open %s\n", argv[i]);
+                exit(1);
+            }
+        }
+
+        AI = CreatePokerAI(TIMEOUT);
+        SetEquityCache(AI, cache);
+        RunBatch(AI, in, games);
+        DestroyPokerAI(AI);
+        CloseCache(cache, cachefile);
+
+        if (in != stdin)
+        {
+            fclose(in);
+        }
+        return 0;
+    }
+
     if (argc < 3)
     {
-        fprintf(stderr, "Usage: ./winprob hand1 hand2 [comm1, .. , comm5] [-nx]\n");
+        fprintf(stderr, "Usage: ./winprob [--cache file] hand1 hand2 [comm1, .. , comm5] [-nx]\n");
         fprintf(stderr, "\tWhere x is the number of opponents (3 by default)\n");
+        fprintf(stderr, "   or: ./winprob [--cache file] --batch [file] [-gy]\n");
+        fprintf(stderr, "\tReads one spot per line from the file (stdin by default)\n");
+        fprintf(stderr, "\tand simulates y games for each (%d by default)\n", DEFAULT_BATCH_GAMES);
+        fprintf(stderr, "\tWith --cache, spots start from and are saved to the cache file\n");
         exit(1);
     }
 
@@ -51,6 +146,12 @@ int main(int argc, char **argv)
     }
 
     AI = CreatePokerAI(TIMEOUT);
+    SetStratifiedRunouts(AI, true);
+    if (cache)
+    {
+        SetEquityCache(AI, cache);
+        SetTargetError(AI, CACHE_TARGET_ERROR);
+    }
     SetHand(AI, hand, NUM_HAND);
     SetCommunity(AI, community, num_community);
     UpdateGameDeck(&AI->game);
@@ -59,9 +160,147 @@ int main(int argc, char **argv)
     simulated = AI->games_simulated;
 
     printf("Win probability: %.2lf%%\n", winprob * 100);
-    printf("Games simulated: %dk\n", simulated / 1000);
+    printf("Games simulated: %lldk\n", simulated / 1000);
 
     //Clean up resources
     DestroyPokerAI(AI);
+    CloseCache(cache, cachefile);
     return 0;
 }
+
+/*
+ * Evaluate every spot read from the given file, one per line,
+ * and write one result line per spot to stdout
+ * AI: the AI whose workers evaluate the spots
+ * in: the file to read spots from
+ * games: how many games to simulate for each spot that is not enumerated
+ */
+static
+void RunBatch(PokerAI *AI, FILE *in, long long games)
+{
+    char (*lines)[MAX_LINE] = malloc(sizeof(*lines) * BATCH_SIZE);
+    EquityQuery *queries = malloc(sizeof(*queries) * BATCH_SIZE);
+    bool *valid = malloc(sizeof(*valid) * BATCH_SIZE);
+    char spot[MAX_LINE];
+    int num_lines;
+    int num_queries;
+    int query;
+
+    do
+    {
+        //Read the next chunk of spots
+        num_lines = 0;
+        num_queries = 0;
+        while (num_lines < BATCH_SIZE && fgets(lines[num_lines], MAX_LINE, in))
+        {
+            lines[num_lines][strcspn(lines[num_lines], "\r\n")] = '\0';
+            strcpy(spot, lines[num_lines]);
+
+            valid[num_lines] = ParseSpot(spot, &queries[num_queries]);
+            num_queries += valid[num_lines];
+            num_lines++;
+        }
+
+        GetWinProbabilities(AI, queries, num_queries, games);
+
+        //Results stream out a chunk at a time, in input order
+        query = 0;
+        for (int i = 0; i < num_lines; i++)
+        {
+            if (!valid[i])
+            {
+                printf("%s\tinvalid\n", lines[i]);
+                continue;
+            }
+
+            printf("%s\t%.4lf\t%lld\n", lines[i], queries[query].winprob, queries[query].games_simulated);
+            query++;
+        }
+        fflush(stdout);
+    } while (num_lines == BATCH_SIZE);
+
+    free(valid);
+    free(queries);
+    free(lines);
+}
+
+/*
+ * Parse a spot written like the command line arguments,
+ * such as "AH KD 2C 7S 9H -n3"
+ * line: the spot to parse (modified by tokenizing)
+ * query: where to store the spot
+ * return: true if the spot is valid
+ */
+static
+bool ParseSpot(char *line, EquityQuery *query)
+{
+    int cards[NUM_HAND + NUM_COMMUNITY];
+    int num_cards = 0;
+    char *token;
+
+    query->num_playing = DEFAULT_NUM_PLAYING;
+
+    for (token = strtok(line, " \t"); token; token = strtok(NULL, " \t"))
+    {
+        if (!strncmp(token, "-n", strlen("-n")))
+        {
+            query->num_playing = atoi(token + strlen("-n"));
+            if (query->num_playing < 1 || query->num_playing > MAX_OPPONENTS) return false;
+        }
+        else if (num_cards == NUM_HAND + NUM_COMMUNITY || !ValidCard(token))
+        {
+            return false;
+        }
+        else
+        {
+            cards[num_cards++] = StringToCard(token);
+        }
+    }
+
+    if (num_cards < NUM_HAND) return false;
+
+    //Every card may only appear once
+    for (int i = 0; i < num_cards; i++)
+    {
+        for (int j = i + 1; j < num_cards; j++)
+        {
+            if (cards[i] == cards[j]) return false;
+        }
+    }
+
+    memcpy(query->hand, cards, sizeof(*cards) * NUM_HAND);
+    query->communitysize = num_cards - NUM_HAND;
+    memcpy(query->community, cards + NUM_HAND, sizeof(*cards) * query->communitysize);
+
+    return true;
+}
+
+/*
+ * Check that a string names a card, such as "AH" or "7C"
+ * card: the string to check
+ * return: true if the string is a card
+ */
+static
+bool ValidCard(char *card)
+{
+    return strlen(card) == 2
+        && strchr(RANK_CHARS, card[0])
+        && strchr(SUIT_CHARS, card[1]);
+}
+
+/*
+ * Write the cache back to its file and free it
+ * cache: the cache to save (may be NULL)
+ * cachefile: the file the cache was loaded from
+ */
+static
+void CloseCache(EquityCache *cache, char *cachefile)
+{
+    if (!cache) return;
+
+    if (!SaveEquityCache(cache, cachefile))
+    {
+        fprintf(stderr, "Could not write %s\n", cachefile);
+    }
+    DestroyEquityCache(cache);
+}
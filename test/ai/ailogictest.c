@@ -222,7 +222,7 @@ DecisionOutcome SimulateLastGame(PokerAI *ai)
     //Cards are 1 indexed
     for (int i = 1; i < NUM_DECK; i++)
     {
-        if (game->deck[i])
+        if (game->deck & CardToMask(i))
         {
             deck[decksize] = i;
             decksize++;
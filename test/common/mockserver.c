@@ -0,0 +1,104 @@
+#include "mockserver.h"
+
+#define REQUEST_SIZE    4096
+
+/*
+ * Accept connections until the server is stopped
+ * _server: the MockServer to run
+ */
+static
+void *ServeRequests(void *_server);
+
+/*
+ * Start a server on a free port of the loopback interface
+ * chunks: the raw response to send, split into chunks and ending with NULL
+ * return: the running server, or NULL if it could not listen
+ */
+MockServer *StartMockServer(const char **chunks)
+{
+    MockServer *server = malloc(sizeof(MockServer));
+    struct sockaddr_in address = {0};
+    socklen_t length = sizeof(address);
+
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    server->chunks = chunks;
+    server->requests = 0;
+    server->request_line[0] = '\0';
+    server->listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listener < 0 ||
+        bind(server->listener, (struct sockaddr *)&address, sizeof(address)) ||
+        listen(server->listener, 4) ||
+        getsockname(server->listener, (struct sockaddr *)&address, &length))
+    {
+        if (server->listener >= 0) close(server->listener);
+        free(server);
+        return NULL;
+    }
+    server->port = ntohs(address.sin_port);
+
+    pthread_create(&server->thread, NULL, ServeRequests, server);
+    return server;
+}
+
+/*
+ * Stop the server and free it
+ * server: the server to stop
+ */
+void StopMockServer(MockServer *server)
+{
+    if (!server) return;
+
+    //Wakes the server thread out of accept
+    shutdown(server->listener, SHUT_RDWR);
+    pthread_join(server->thread, NULL);
+
+    close(server->listener);
+    free(server);
+}
+
+/*
+ * Accept connections until the server is stopped
+ * _server: the MockServer to run
+ */
+static
+void *ServeRequests(void *_server)
+{
+    MockServer *server = (MockServer *)_server;
+    char request[REQUEST_SIZE];
+    size_t received;
+    ssize_t count;
+    int client;
+
+    while ((client = accept(server->listener, NULL, NULL)) >= 0)
+    {
+        //Read the request headers, a body is never expected
+        received = 0;
+        request[0] = '\0';
+        while (!strstr(request, "\r\n\r\n") && received < REQUEST_SIZE - 1)
+        {
+            count = recv(client, request + received, REQUEST_SIZE - 1 - received, 0);
+            if (count <= 0) break;
+
+            received += count;
+            request[received] = '\0';
+        }
+
+        //Remembered before answering, so the client sees it once it has the response
+        snprintf(server->request_line, MOCK_REQUEST_LINE, "%.*s",
+                (int)strcspn(request, "\r\n"), request);
+
+        for (int i = 0; server->chunks[i]; i++)
+        {
+            if (i > 0) usleep(MOCK_CHUNK_DELAY);
+            send(client, server->chunks[i], strlen(server->chunks[i]), MSG_NOSIGNAL);
+        }
+
+        __atomic_add_fetch(&server->requests, 1, __ATOMIC_RELAXED);
+        close(client);
+    }
+
+    return NULL;
+}
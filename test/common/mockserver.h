@@ -0,0 +1,48 @@
+#ifndef __MOCK_SERVER_H__
+#define __MOCK_SERVER_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+//How long the server pauses between the chunks of a response, in microseconds
+#define MOCK_CHUNK_DELAY    20000
+
+//Longest request line the server remembers
+#define MOCK_REQUEST_LINE   256
+
+//A local HTTP server that answers every request with the same scripted response
+//Each chunk is written separately, so clients see it arrive in pieces
+typedef struct mockserver
+{
+    int listener;
+    int port;
+    pthread_t thread;
+
+    //The raw response, status line and headers included, ending with NULL
+    const char **chunks;
+
+    //Requests answered so far, and the request line of the last one
+    int requests;
+    char request_line[MOCK_REQUEST_LINE];
+} MockServer;
+
+/*
+ * Start a server on a free port of the loopback interface
+ * chunks: the raw response to send, split into chunks and ending with NULL
+ * return: the running server, or NULL if it could not listen
+ */
+MockServer *StartMockServer(const char **chunks);
+
+/*
+ * Stop the server and free it
+ * server: the server to stop
+ */
+void StopMockServer(MockServer *server);
+
+#endif
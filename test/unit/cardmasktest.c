@@ -0,0 +1,171 @@
+#include "tests.h"
+
+#define NUM_CARDS       52
+#define MASK_HANDS      200000
+#define MASK_GAMES      200000
+#define MASK_ERROR      0.01
+
+/*
+ * Compare two values with the sign of their difference
+ * return: -1, 0 or 1
+ */
+static
+int Compare(int first, int second)
+{
+    return (first > second) - (first < second);
+}
+
+TestResult *TestCardMask(void)
+{
+    int numtests = 0;
+    int failed = 0;
+    int deck[NUM_CARDS];
+    int decksize;
+    int hands[2][7];
+    int values[2];
+    int maskvalues[2];
+    int k;
+    CardMask all = 0;
+    CardMask card;
+    CardMask cards;
+    RandomState rng;
+    EquityQuery query;
+    PokerAI *ai;
+    long long won;
+    double exact;
+
+    SeedRandom(&rng, 42);
+
+    //Every card gets its own bit and they make up the whole deck
+    for (int i = 1; i <= NUM_CARDS; i++)
+    {
+        card = CardToMask(i);
+        if ((all & card) || (card & ~FULL_DECK_MASK))
+        {
+            break;
+        }
+        all |= card;
+    }
+    if (all != FULL_DECK_MASK)
+    {
+        fprintf(stderr, "Failed card to mask\n");
+        failed++;
+    }
+    numtests++;
+
+    //Select agrees with clearing the lowest bits one at a time
+    for (int i = 0; i < 10000; i++)
+    {
+        cards = RandomNext(&rng) & FULL_DECK_MASK;
+        if (!cards) continue;
+
+        k = RandomBelow(&rng, __builtin_popcountll(cards));
+        card = cards;
+        for (int j = 0; j < k; j++)
+        {
+            card &= card - 1;
+        }
+        if (SelectBit(cards, k) != __builtin_ctzll(card))
+        {
+            fprintf(stderr, "Failed select bit\n");
+            failed++;
+            break;
+        }
+    }
+    numtests++;
+
+    //Dealing empties the deck one card at a time
+    cards = FULL_DECK_MASK;
+    decksize = NUM_CARDS;
+    all = 0;
+    while (decksize > 0)
+    {
+        card = DealMaskCard(&rng, &cards, &decksize);
+        if ((all & card) || (card & ~FULL_DECK_MASK))
+        {
+            break;
+        }
+        all |= card;
+    }
+    if (decksize != 0 || cards != 0 || all != FULL_DECK_MASK)
+    {
+        fprintf(stderr, "Failed dealing every card once\n");
+        failed++;
+    }
+    numtests++;
+
+    //The mask evaluator orders and categorizes hands like the table
+    for (int i = 0; i < MASK_HANDS; i++)
+    {
+        for (int c = 0; c < NUM_CARDS; c++)
+        {
+            deck[c] = c + 1;
+        }
+        decksize = NUM_CARDS;
+
+        for (int h = 0; h < 2; h++)
+        {
+            for (int c = 0; c < 7; c++)
+            {
+                hands[h][c] = DrawCard(&rng, deck, &decksize);
+            }
+            values[h] = GetHandValue(hands[h], 7);
+            maskvalues[h] = GetMaskHandValue(CardsToMask(hands[h], 7));
+        }
+
+        if (Compare(values[0], values[1]) != Compare(maskvalues[0], maskvalues[1])
+                || values[0] >> 12 != maskvalues[0] >> MASK_CATEGORY_SHIFT
+                || GetHandValue(hands[0], 5) >> 12
+                    != GetMaskHandValue(CardsToMask(hands[0], 5)) >> MASK_CATEGORY_SHIFT)
+        {
+            fprintf(stderr, "Failed mask hand value\n");
+            failed++;
+            break;
+        }
+    }
+    numtests++;
+
+    //The deck of a game state holds every card not yet seen
+    ai = CreatePokerAIWithThreads(1000, 1);
+    query.hand[0] = StringToCard("AH");
+    query.hand[1] = StringToCard("KD");
+    query.community[0] = StringToCard("2C");
+    query.community[1] = StringToCard("7S");
+    query.community[2] = StringToCard("9H");
+    memcpy(ai->game.hand, query.hand, sizeof(query.hand));
+    memcpy(ai->game.community, query.community, sizeof(query.community));
+    ai->game.handsize = NUM_HAND;
+    ai->game.communitysize = 3;
+    ai->game.num_playing = 1;
+    UpdateGameDeck(&ai->game);
+    if (__builtin_popcountll(ai->game.deck) != NUM_CARDS - 5
+            || (ai->game.deck & CardsToMask(query.community, 3)))
+    {
+        fprintf(stderr, "Failed game deck mask\n");
+        failed++;
+    }
+    numtests++;
+
+    //Both simulation backends agree with the exact answer
+    exact = (double)EnumerateDeals(&ai->game, &won);
+    exact = won / exact;
+    query.communitysize = 3;
+    query.num_playing = 1;
+    SetEnumerateLimit(ai, 0);
+    for (SimBackend backend = SIM_BACKEND_TABLE; backend <= SIM_BACKEND_MASK; backend++)
+    {
+        SetSimBackend(ai, backend);
+        GetWinProbabilities(ai, &query, 1, MASK_GAMES);
+        if (fabs(query.winprob - exact) > MASK_ERROR)
+        {
+            fprintf(stderr, "Failed simulation backend %d\n", backend);
+            failed++;
+        }
+        numtests++;
+    }
+
+    DestroyPokerAI(ai);
+
+    fprintf(stderr, "[CARDMASK]\t\tpassed %d/%d\n", (numtests - failed), numtests);
+    return CreateResult(failed, numtests);
+}
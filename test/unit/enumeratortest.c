@@ -0,0 +1,118 @@
+#include "tests.h"
+
+#define RIVER_DEALS     990     //45 choose 2
+#define TURN_DEALS      45540   //46 * (45 choose 2)
+
+/*
+ * Set up a game state from card strings
+ * game: the game state to fill in
+ * hand: the AI's hole cards
+ * community: the community cards
+ * communitysize: the number of community cards
+ * num_playing: the number of opponents still in the hand
+ */
+static
+void SetTestGame(GameState *game, char **hand, char **community, int communitysize, int num_playing)
+{
+    game->handsize = NUM_HAND;
+    for (int i = 0; i < NUM_HAND; i++)
+    {
+        game->hand[i] = StringToCard(hand[i]);
+    }
+
+    game->communitysize = communitysize;
+    for (int i = 0; i < communitysize; i++)
+    {
+        game->community[i] = StringToCard(community[i]);
+    }
+
+    game->num_playing = num_playing;
+    UpdateGameDeck(game);
+}
+
+TestResult *TestEnumerator(void)
+{
+    int numtests = 0;
+    int failed = 0;
+    long long won;
+    long long deals;
+    GameState game;
+    GameState river;
+    long long riverwon;
+    long long riverdeals;
+    char *nuts[] = {"AS", "KS"};
+    char *weak[] = {"2C", "3D"};
+    char *suited[] = {"9H", "8H"};
+    char *board[] = {"QS", "JS", "TS", "4H", "8D"};
+    char *twotone[] = {"2H", "7H", "KC", "QC"};
+
+    SetTestGame(&game, nuts, board, NUM_COMMUNITY, 1);
+    if (CountDeals(&game) != RIVER_DEALS)
+    {
+        fprintf(stderr, "Failed river deal count\n");
+        failed++;
+    }
+    numtests++;
+
+    deals = EnumerateDeals(&game, &won);
+    if (deals != RIVER_DEALS || won != RIVER_DEALS)
+    {
+        fprintf(stderr, "Failed river royal flush\n");
+        failed++;
+    }
+    numtests++;
+
+    SetTestGame(&game, weak, board, NUM_COMMUNITY - 1, 1);
+    if (CountDeals(&game) != TURN_DEALS)
+    {
+        fprintf(stderr, "Failed turn deal count\n");
+        failed++;
+    }
+    numtests++;
+
+    deals = EnumerateDeals(&game, &won);
+    if (deals != TURN_DEALS || won <= 0 || won >= deals / 4)
+    {
+        fprintf(stderr, "Failed turn weak hand\n");
+        failed++;
+    }
+    numtests++;
+
+    //Each extra opponent multiplies the deals by the ways to give them two cards
+    SetTestGame(&game, weak, board, NUM_COMMUNITY, 2);
+    deals = EnumerateDeals(&game, &won);
+    if (deals != (long long)RIVER_DEALS * 903 || deals != CountDeals(&game))
+    {
+        fprintf(stderr, "Failed multiway deal count\n");
+        failed++;
+    }
+    numtests++;
+
+    //Spades and diamonds are interchangeable on this turn, so only half of
+    //their rivers are played out; the total must match every river played alone
+    SetTestGame(&game, suited, twotone, NUM_COMMUNITY - 1, 1);
+    deals = EnumerateDeals(&game, &won);
+    riverwon = 0;
+    riverdeals = 0;
+    for (int card = 1; card < NUM_DECK; card++)
+    {
+        if (!(game.deck & CardToMask(card))) continue;
+
+        river = game;
+        river.community[NUM_COMMUNITY - 1] = card;
+        river.communitysize = NUM_COMMUNITY;
+        UpdateGameDeck(&river);
+        riverdeals += EnumerateDeals(&river, &won);
+        riverwon += won;
+    }
+    EnumerateDeals(&game, &won);
+    if (deals != TURN_DEALS || deals != riverdeals || won != riverwon)
+    {
+        fprintf(stderr, "Failed suit symmetric turn\n");
+        failed++;
+    }
+    numtests++;
+
+    fprintf(stderr, "[ENUMERATOR]\t\tpassed %d/%d\n", (numtests - failed), numtests);
+    return CreateResult(failed, numtests);
+}
@@ -0,0 +1,164 @@
+#include "tests.h"
+
+#define SHORT_TIMEOUT   200
+#define FIRST_GAMES     20000
+#define MORE_GAMES      50000
+#define LOOSE_ERROR     0.05
+
+/*
+ * Get the key of a spot written as card strings
+ * cards: the two hole cards followed by the community cards
+ * num_cards: the number of cards
+ * num_playing: the number of opponents
+ * return: the spot's key
+ */
+static
+EquityKey KeyOf(char **cards, int num_cards, int num_playing)
+{
+    int ints[NUM_HAND + NUM_COMMUNITY];
+
+    for (int i = 0; i < num_cards; i++)
+    {
+        ints[i] = StringToCard(cards[i]);
+    }
+
+    return MakeEquityKey(ints, ints + NUM_HAND, num_cards - NUM_HAND, num_playing);
+}
+
+/*
+ * Check whether two keys are the same
+ * a: the first key
+ * b: the second key
+ * return: true if the keys match
+ */
+static
+bool SameKey(EquityKey a, EquityKey b)
+{
+    return a.num_playing == b.num_playing && !memcmp(a.suits, b.suits, sizeof(a.suits));
+}
+
+TestResult *TestEquityCache(void)
+{
+    int numtests = 0;
+    int failed = 0;
+    char *spot[] = {"AH", "KD", "2C", "7S", "9H"};
+    char *relabeled[] = {"AS", "KC", "9S", "2D", "7H"};
+    char *suited[] = {"AH", "KH", "2C", "7S", "9H"};
+    char path[] = "/tmp/equitycacheXXXXXX";
+    EquityKey keys[3];
+    EquityCache *cache;
+    EquityCache *loaded;
+    EquityQuery query;
+    long long won;
+    long long simulated;
+    bool ok;
+    int fd;
+    PokerAI *ai;
+
+    //Relabeling the suits or reordering the board keeps the key
+    keys[0] = KeyOf(spot, 5, 3);
+    keys[1] = KeyOf(relabeled, 5, 3);
+    keys[2] = KeyOf(suited, 5, 3);
+    if (!SameKey(keys[0], keys[1]) || SameKey(keys[0], keys[2])
+            || SameKey(keys[0], KeyOf(spot, 5, 2)))
+    {
+        fprintf(stderr, "Failed suit isomorphic keys\n");
+        failed++;
+    }
+    numtests++;
+
+    //A full cache evicts the spot used least recently
+    cache = CreateEquityCache(2);
+    StoreEquity(cache, &keys[0], 1, 10);
+    StoreEquity(cache, &keys[2], 2, 20);
+    LookupEquity(cache, &keys[0], &won, &simulated);
+    keys[1] = KeyOf(spot, 5, 2);
+    StoreEquity(cache, &keys[1], 3, 30);
+    if (LookupEquity(cache, &keys[2], &won, &simulated)
+            || !LookupEquity(cache, &keys[0], &won, &simulated) || won != 1 || simulated != 10
+            || !LookupEquity(cache, &keys[1], &won, &simulated) || won != 3 || simulated != 30)
+    {
+        fprintf(stderr, "Failed least recently used eviction\n");
+        failed++;
+    }
+    numtests++;
+
+    //Saved spots come back, and a loaded spot only replaces one with fewer games
+    fd = mkstemp(path);
+    close(fd);
+    loaded = CreateEquityCache(DEFAULT_CACHE_ENTRIES);
+    StoreEquity(loaded, &keys[0], 5, 5);
+    StoreEquity(loaded, &keys[1], 300, 3000);
+    ok = SaveEquityCache(cache, path) && LoadEquityCache(loaded, path);
+    ok = ok && LookupEquity(loaded, &keys[0], &won, &simulated) && won == 1 && simulated == 10;
+    ok = ok && LookupEquity(loaded, &keys[1], &won, &simulated) && won == 300 && simulated == 3000;
+    ok = ok && loaded->hits == 2 && loaded->misses == 0;
+    if (!ok || LoadEquityCache(loaded, "/nonexistent/equitycache"))
+    {
+        fprintf(stderr, "Failed saving and loading the cache\n");
+        failed++;
+    }
+    numtests++;
+    unlink(path);
+    DestroyEquityCache(loaded);
+    DestroyEquityCache(cache);
+
+    //A cache asked to hold nothing still holds the latest spot
+    cache = CreateEquityCache(0);
+    StoreEquity(cache, &keys[0], 1, 10);
+    StoreEquity(cache, &keys[2], 2, 20);
+    if (LookupEquity(cache, &keys[0], &won, &simulated)
+            || !LookupEquity(cache, &keys[2], &won, &simulated) || won != 2 || simulated != 20)
+    {
+        fprintf(stderr, "Failed cache without capacity\n");
+        failed++;
+    }
+    numtests++;
+    DestroyEquityCache(cache);
+
+    //Cached spots are topped up, and return at once when they have enough games
+    cache = CreateEquityCache(DEFAULT_CACHE_ENTRIES);
+    ai = CreatePokerAI(SHORT_TIMEOUT);
+    SetEquityCache(ai, cache);
+
+    memset(&query, 0, sizeof(query));
+    for (int i = 0; i < NUM_HAND; i++)
+    {
+        query.hand[i] = StringToCard(spot[i]);
+    }
+    query.community[0] = StringToCard(spot[2]);
+    query.community[1] = StringToCard(spot[3]);
+    query.community[2] = StringToCard(spot[4]);
+    query.communitysize = 3;
+    query.num_playing = 3;
+
+    GetWinProbabilities(ai, &query, 1, FIRST_GAMES);
+    ok = query.games_simulated == FIRST_GAMES;
+    GetWinProbabilities(ai, &query, 1, MORE_GAMES);
+    ok = ok && query.games_simulated == MORE_GAMES;
+    GetWinProbabilities(ai, &query, 1, FIRST_GAMES);
+    ok = ok && query.games_simulated == MORE_GAMES;
+    keys[0] = KeyOf(relabeled, 5, 3);
+    ok = ok && LookupEquity(cache, &keys[0], &won, &simulated)
+        && won == query.games_won && simulated == MORE_GAMES;
+
+    SetHand(ai, relabeled, NUM_HAND);
+    SetCommunity(ai, relabeled + NUM_HAND, 3);
+    UpdateGameDeck(&ai->game);
+    ai->game.num_playing = 3;
+    SetTargetError(ai, LOOSE_ERROR);
+    GetWinProbability(ai);
+    ok = ok && ai->speculated_games == MORE_GAMES && ai->games_simulated == MORE_GAMES;
+
+    if (!ok)
+    {
+        fprintf(stderr, "Failed topping up cached spots\n");
+        failed++;
+    }
+    numtests++;
+    DestroyPokerAI(ai);
+    DestroyEquityCache(cache);
+
+    fprintf(stderr, "[EQUITYCACHE]\t\tpassed %d/%d\n", (numtests - failed), numtests);
+    return CreateResult(failed, numtests);
+}
@@ -1,6 +1,12 @@
 #include "tests.h"
 
-#define ARR_LEN     7
+#define ARR_LEN         7
+#define COMPACT_FILE    "/tmp/pokerai_handranks16.dat"
+#define COMPACT_HANDS   100000
+
+//Where the row offsets of the 5 card table start in a compact file:
+//after the magic, the version, the flush table and the row and slot counts
+#define COMPACT_ROW_OFFSETS (4 + 4 + 2 * FLUSH_TABLE_SIZE + 4 + 4)
 
 #define HIGH_CARD        "{\"cards\" : [\"2H\", \"3C\", \"QD\", \"TS\", \"9C\", \"8D\", \"7D\"]}"
 #define HIGH_CARD2       "{\"cards\" : [\"AH\", \"3C\", \"QD\", \"TS\", \"9C\", \"8D\", \"7D\"]}"
@@ -36,10 +42,36 @@ int scoreJSON(char *jsontext)
     return GetHandValue(cards, ARR_LEN);
 }
 
+/*
+ * Evaluate a hand on a thread that has not called UseLocalHandRanks
+ * _hand: a void pointer to 7 cards, followed by a slot for their value
+ * return: NULL
+ */
+static
+void *ValueOnNewThread(void *_hand)
+{
+    int *hand = (int *)_hand;
+
+    hand[ARR_LEN] = GetHandValue(hand, ARR_LEN);
+    return NULL;
+}
+
 TestResult *TestEvaluator(void)
 {
     int numtests = 0;
     int failed = 0;
+    int (*hands)[ARR_LEN + 1];
+    int threadhand[ARR_LEN + 1];
+    pthread_t thread;
+    int deck[NUM_DECK];
+    int decksize;
+    RandomState rng;
+    BoardState boardstate;
+    uint32_t badoffset;
+    bool corrupted;
+    pid_t child;
+    int status;
+    int fd;
     cards = malloc(sizeof(int) * ARR_LEN);
 
     if (scoreJSON(HIGH_CARD) > scoreJSON(HIGH_CARD2))
@@ -161,6 +193,125 @@ TestResult *TestEvaluator(void)
     }
     numtests++;
 
+    //Walking the board first must give the same rank as a full walk
+    scoreJSON(FLUSH);
+    int board = AdvanceHandNode(HANDRANKS_ROOT, cards + 2, ARR_LEN - 2);
+    if (GetHandValueFromBoard(board, cards) != GetHandValue(cards, ARR_LEN))
+    {
+        fprintf(stderr, "[EVALUATOR] Failed SHARED BOARD WALK\n");
+        failed++;
+    }
+    numtests++;
+
+    //The best of several hands on one board is the best of their own ranks
+    int opponents[3][2] = {{cards[0], cards[1]}, {1, 2}, {49, 50}};
+    StartBoard(&boardstate);
+    AddBoardCards(&boardstate, cards + 2, ARR_LEN - 2);
+    if (BestHandOnBoard(&boardstate, opponents, 3) != GetHandValue(cards, ARR_LEN)
+            || BestHandOnBoard(&boardstate, opponents, 0) != 0)
+    {
+        fprintf(stderr, "[EVALUATOR] Failed BEST HAND ON BOARD\n");
+        failed++;
+    }
+    numtests++;
+
+    //Five card hands stop on a node and need one more lookup
+    //The category of a rank is stored above its low 12 bits (5 == straight)
+    scoreJSON(STRAIGHT2);
+    if ((GetHandValue(cards + 2, 5) >> 12) != 5)
+    {
+        fprintf(stderr, "[EVALUATOR] Failed FIVE CARD HAND\n");
+        failed++;
+    }
+    numtests++;
+
+    //Threads that never asked for a local copy read the shared table
+    memcpy(threadhand, cards, sizeof(*cards) * ARR_LEN);
+    pthread_create(&thread, NULL, ValueOnNewThread, threadhand);
+    pthread_join(thread, NULL);
+    if (threadhand[ARR_LEN] != GetHandValue(cards, ARR_LEN))
+    {
+        fprintf(stderr, "[EVALUATOR] Failed VALUE ON NEW THREAD\n");
+        failed++;
+    }
+    numtests++;
+
+    //The compact table must rank random 5, 6 and 7 card hands exactly like 2+2
+    hands = malloc(sizeof(*hands) * COMPACT_HANDS);
+    SeedRandom(&rng, 11);
+    for (int i = 0; i < COMPACT_HANDS; i++)
+    {
+        //Cards are 1 indexed
+        decksize = NUM_DECK - 1;
+        for (int c = 0; c < decksize; c++)
+        {
+            deck[c] = c + 1;
+        }
+        for (int c = 0; c < ARR_LEN; c++)
+        {
+            hands[i][c] = DrawCard(&rng, deck, &decksize);
+        }
+        hands[i][ARR_LEN] = GetHandValue(hands[i], 5 + i % 3);
+    }
+
+    if (!WriteCompactRanks(COMPACT_FILE))
+    {
+        fprintf(stderr, "[EVALUATOR] Failed WRITE COMPACT TABLE\n");
+        failed++;
+    }
+    numtests++;
+
+    //The suite is run against the default table, so reload it afterwards
+    DestroyEvaluator();
+    InitEvaluator(COMPACT_FILE);
+    for (int i = 0; i < COMPACT_HANDS; i++)
+    {
+        if (GetHandValue(hands[i], 5 + i % 3) != hands[i][ARR_LEN])
+        {
+            fprintf(stderr, "[EVALUATOR] Failed COMPACT HAND VALUE\n");
+            failed++;
+            break;
+        }
+    }
+    numtests++;
+
+    StartBoard(&boardstate);
+    AddBoardCards(&boardstate, hands[0] + 2, ARR_LEN - 2);
+    if (GetHandValueOnBoard(&boardstate, hands[0]) != GetHandValue(hands[0], ARR_LEN))
+    {
+        fprintf(stderr, "[EVALUATOR] Failed COMPACT SHARED BOARD\n");
+        failed++;
+    }
+    numtests++;
+
+    //A row offset past the end of the table must fail the load,
+    //which exits, so the corrupt file is loaded in a child process
+    fd = open(COMPACT_FILE, O_WRONLY);
+    badoffset = UINT32_MAX - COMPACT_ROW_MASK;
+    corrupted = pwrite(fd, &badoffset, sizeof(badoffset), COMPACT_ROW_OFFSETS) == sizeof(badoffset);
+    close(fd);
+
+    child = fork();
+    if (child == 0)
+    {
+        freopen("/dev/null", "w", stderr);
+        DestroyEvaluator();
+        InitEvaluator(COMPACT_FILE);
+        _exit(0);
+    }
+    waitpid(child, &status, 0);
+    if (!corrupted || !WIFEXITED(status) || WEXITSTATUS(status) == 0)
+    {
+        fprintf(stderr, "[EVALUATOR] Failed CORRUPT COMPACT TABLE\n");
+        failed++;
+    }
+    numtests++;
+
+    DestroyEvaluator();
+    InitEvaluator(DEFAULT_HANDRANKS_FILE);
+    unlink(COMPACT_FILE);
+    free(hands);
+
     free(cards);
     fprintf(stderr, "[EVALUATOR]\t\tpassed %d/%d\n", (numtests - failed), numtests);
     return CreateResult(failed, numtests);
@@ -6,6 +6,7 @@
 #define TEST_COMMUNITY_STR  "{\"cards\" : [\"AC\", \"KS\", \"3H\", \"QD\"]}"
 #define TEST_NUM_OPPONENTS  2
 #define TEST_NUM_DECK       NUM_DECK
+#define TEST_NUM_RANDOM     100
 
 #define JSON(json, field) \
     cJSON_GetObjectItem(json, field)
@@ -50,9 +51,19 @@ const char *gamestate = \
 static
 void InitializeTestGameState(void);
 
+/*
+ * Check that ParseGameState fills in the same game state as SetGameState
+ * text: the JSON text of a game state
+ * return: true if both parsers agree
+ */
+static
+bool ParsersAgree(const char *text);
+
 TestResult *TestGameState(void)
 {
     GameState game;
+    GameState previous;
+    char *truncated;
     int numtests = 0;
     int failed = 0;
 
@@ -157,7 +168,7 @@ TestResult *TestGameState(void)
     //Cards are 1-indexed
     for (int i = 1; i < TEST_NUM_DECK; i++)
     {
-        if (game.deck[i] != TEST_DECK[i])
+        if (((game.deck & CardToMask(i)) != 0) != TEST_DECK[i])
         {
             fprintf(stderr, "Failed deck parse\n");
             failed++;
@@ -166,6 +177,48 @@ TestResult *TestGameState(void)
     }
     numtests++;
 
+    if (!ParsersAgree(gamestate))
+    {
+        fprintf(stderr, "Failed streaming parse\n");
+        failed++;
+    }
+    numtests++;
+
+    for (int i = 0; i < TEST_NUM_RANDOM; i++)
+    {
+        char *random = GenerateRandomGameState();
+        bool agree = ParsersAgree(random);
+
+        free(random);
+        if (!agree)
+        {
+            fprintf(stderr, "Failed streaming parse of a random game state\n");
+            failed++;
+            break;
+        }
+    }
+    numtests++;
+
+    if (ParseGameState(&game, "{\"hand\": [\"2H\", \"7D\"") || ParseGameState(&game, "[]"))
+    {
+        fprintf(stderr, "Failed streaming parse of malformed text\n");
+        failed++;
+    }
+    numtests++;
+
+    //A truncated poll response leaves the last good state alone
+    ParseGameState(&game, gamestate);
+    memcpy(&previous, &game, sizeof(game));
+    truncated = strdup(gamestate);
+    truncated[strlen(truncated) / 2] = '\0';
+    if (ParseGameState(&game, truncated) || memcmp(&game, &previous, sizeof(game)))
+    {
+        fprintf(stderr, "Failed keeping the state through truncated text\n");
+        failed++;
+    }
+    numtests++;
+    free(truncated);
+
     fprintf(stderr, "[GAMESTATE]\t\tpassed %d/%d\n", (numtests - failed), numtests);
     return CreateResult(failed, numtests);
 }
@@ -200,3 +253,58 @@ void InitializeTestGameState(void)
         TEST_DECK[TEST_COMMUNITY[i]] = false;
     }
 }
+
+/*
+ * Check that ParseGameState fills in the same game state as SetGameState
+ * text: the JSON text of a game state
+ * return: true if both parsers agree
+ */
+static
+bool ParsersAgree(const char *text)
+{
+    GameState expected;
+    GameState parsed;
+    cJSON *json = cJSON_Parse(text);
+
+    SetGameState(&expected, json);
+    cJSON_Delete(json);
+
+    if (!ParseGameState(&parsed, text)) return false;
+
+    if (parsed.round_id != expected.round_id
+            || parsed.initial_stack != expected.initial_stack
+            || parsed.stack != expected.stack
+            || parsed.current_bet != expected.current_bet
+            || parsed.call_amount != expected.call_amount
+            || parsed.current_pot != expected.current_pot
+            || parsed.phase != expected.phase
+            || parsed.your_turn != expected.your_turn
+            || parsed.handsize != expected.handsize
+            || parsed.communitysize != expected.communitysize
+            || parsed.num_opponents != expected.num_opponents
+            || parsed.num_playing != expected.num_playing
+            || parsed.deck != expected.deck)
+    {
+        return false;
+    }
+
+    if (memcmp(parsed.hand, expected.hand, sizeof(*parsed.hand) * parsed.handsize)
+            || memcmp(parsed.community, expected.community, sizeof(*parsed.community) * parsed.communitysize))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < parsed.num_opponents; i++)
+    {
+        Player *a = &parsed.opponents[i];
+        Player *b = &expected.opponents[i];
+
+        if (strncmp(a->name, b->name, MAX_NAME_LEN) || a->initial_stack != b->initial_stack
+                || a->stack != b->stack || a->current_bet != b->current_bet || a->folded != b->folded)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,76 @@
+#include "tests.h"
+
+/*
+ * Convert two card strings into hole cards
+ * hand: where to store the cards
+ * c1: the first card
+ * c2: the second card
+ */
+static
+void SetTestHand(int *hand, char *c1, char *c2)
+{
+    hand[0] = StringToCard(c1);
+    hand[1] = StringToCard(c2);
+}
+
+TestResult *TestPreflop(void)
+{
+    int numtests = 0;
+    int failed = 0;
+    int aces[NUM_HAND];
+    int bigslick[NUM_HAND];
+    int bigslick2[NUM_HAND];
+    int bigslicksuited[NUM_HAND];
+    int trash[NUM_HAND];
+
+    SetTestHand(aces, "AH", "AD");
+    SetTestHand(bigslick, "AH", "KD");
+    SetTestHand(bigslick2, "KC", "AS");
+    SetTestHand(bigslicksuited, "KC", "AC");
+    SetTestHand(trash, "7D", "2C");
+
+    if (PreflopClass(bigslick) != PreflopClass(bigslick2))
+    {
+        fprintf(stderr, "Failed class card order\n");
+        failed++;
+    }
+    numtests++;
+
+    if (PreflopClass(bigslick) == PreflopClass(bigslicksuited))
+    {
+        fprintf(stderr, "Failed class suitedness\n");
+        failed++;
+    }
+    numtests++;
+
+    if (PreflopEquity(aces, 1) <= PreflopEquity(bigslicksuited, 1)
+            || PreflopEquity(bigslicksuited, 1) <= PreflopEquity(bigslick, 1)
+            || PreflopEquity(bigslick, 1) <= PreflopEquity(trash, 1))
+    {
+        fprintf(stderr, "Failed hand ordering\n");
+        failed++;
+    }
+    numtests++;
+
+    for (int opp = 1; opp < MAX_PREFLOP_OPPONENTS; opp++)
+    {
+        if (PreflopEquity(aces, opp + 1) >= PreflopEquity(aces, opp))
+        {
+            fprintf(stderr, "Failed opponent ordering\n");
+            failed++;
+            break;
+        }
+    }
+    numtests++;
+
+    //Pocket aces win about 85% of the time heads-up
+    if (PreflopEquity(aces, 1) < 0.84 || PreflopEquity(aces, 1) > 0.87)
+    {
+        fprintf(stderr, "Failed heads-up aces equity\n");
+        failed++;
+    }
+    numtests++;
+
+    fprintf(stderr, "[PREFLOP]\t\tpassed %d/%d\n", (numtests - failed), numtests);
+    return CreateResult(failed, numtests);
+}
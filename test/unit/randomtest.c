@@ -0,0 +1,87 @@
+#include "tests.h"
+
+#define NUM_SAMPLES     520000
+#define SAMPLE_BOUND    52
+
+TestResult *TestRandom(void)
+{
+    int numtests = 0;
+    int failed = 0;
+    RandomState first;
+    RandomState second;
+    int counts[SAMPLE_BOUND] = {0};
+    int deck[SAMPLE_BOUND];
+    bool seen[SAMPLE_BOUND] = {false};
+    int decksize = SAMPLE_BOUND;
+    bool same = true;
+    uint32_t value;
+
+    SeedRandom(&first, 42);
+    SeedRandom(&second, 42);
+    for (int i = 0; i < 100; i++)
+    {
+        same = same && (RandomNext(&first) == RandomNext(&second));
+    }
+    if (!same)
+    {
+        fprintf(stderr, "Failed same seed\n");
+        failed++;
+    }
+    numtests++;
+
+    SeedRandom(&second, 43);
+    if (RandomNext(&first) == RandomNext(&second))
+    {
+        fprintf(stderr, "Failed different seeds\n");
+        failed++;
+    }
+    numtests++;
+
+    for (int i = 0; i < NUM_SAMPLES; i++)
+    {
+        value = RandomBelow(&first, SAMPLE_BOUND);
+        if (value >= SAMPLE_BOUND)
+        {
+            fprintf(stderr, "Failed bounded sample range\n");
+            failed++;
+            break;
+        }
+        counts[value]++;
+    }
+    numtests++;
+
+    //Each value is expected 10000 times, give or take about 100
+    for (int i = 0; i < SAMPLE_BOUND; i++)
+    {
+        if (counts[i] < 9500 || counts[i] > 10500)
+        {
+            fprintf(stderr, "Failed bounded sample uniformity\n");
+            failed++;
+            break;
+        }
+    }
+    numtests++;
+
+    for (int i = 0; i < SAMPLE_BOUND; i++)
+    {
+        deck[i] = i;
+    }
+    while (decksize > 0)
+    {
+        value = DrawCard(&first, deck, &decksize);
+        if (seen[value])
+        {
+            break;
+        }
+        seen[value] = true;
+    }
+    if (decksize != 0)
+    {
+        fprintf(stderr, "Failed drawing every card once\n");
+        failed++;
+    }
+    numtests++;
+
+    fprintf(stderr, "[RANDOM]\t\tpassed %d/%d\n", (numtests - failed), numtests);
+    return CreateResult(failed, numtests);
+}
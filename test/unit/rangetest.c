@@ -0,0 +1,135 @@
+#include "tests.h"
+
+#define SHORT_TIMEOUT   200
+#define NUM_SAMPLES     100000
+#define FREQ_EPSILON    0.01
+
+/*
+ * Sample a range and average the heads up preflop equity of its hands
+ * range: the range to sample
+ * rng: the generator to sample with
+ * return: the average equity of the sampled hands
+ */
+static
+double AverageRangeEquity(HandRange *range, RandomState *rng)
+{
+    double total = 0;
+    int combo;
+
+    for (int i = 0; i < NUM_SAMPLES; i++)
+    {
+        combo = SampleRangeCombo(range, rng);
+        total += PREFLOP_EQUITY[PreflopClass(COMBO_CARDS[combo])][0];
+    }
+
+    return total / NUM_SAMPLES;
+}
+
+TestResult *TestRange(void)
+{
+    int numtests = 0;
+    int failed = 0;
+    RandomState rng;
+    HandRange *range = malloc(sizeof(HandRange));
+    double *weights = calloc(NUM_COMBOS, sizeof(double));
+    Player allin = {"ALLIN", 1000, 1000, 0, false};
+    Player halfin = {"HALFIN", 1000, 500, 500, false};
+    Player blind = {"BLIND", 1000, 10, 990, false};
+    double allinequity;
+    double halfinequity;
+    double uniformequity = 0;
+    double uniform;
+    double ranged;
+    CardMask dead;
+    int counts[2] = {0};
+    int combo;
+    bool ok;
+    PokerAI *ai;
+    char *hand[] = {"TD", "9C"};
+    char *flop[] = {"2C", "7S", "KD"};
+
+    SeedRandom(&rng, 1);
+    InitRanges();
+
+    //The alias table keeps the proportions of the weights
+    weights[0] = 3;
+    weights[1] = 1;
+    ok = BuildHandRange(range, weights, 0);
+    for (int i = 0; i < NUM_SAMPLES && ok; i++)
+    {
+        combo = SampleRangeCombo(range, &rng);
+        if (combo > 1)
+        {
+            ok = false;
+        }
+        else
+        {
+            counts[combo]++;
+        }
+    }
+    if (!ok || fabs((double)counts[0] / NUM_SAMPLES - 0.75) > FREQ_EPSILON)
+    {
+        fprintf(stderr, "Failed alias table proportions\n");
+        failed++;
+    }
+    numtests++;
+
+    //Hands holding a dead card are never dealt
+    dead = CardToMask(StringToCard("AS")) | CardToMask(StringToCard("KH"));
+    SetRangeWeights(weights, RANGE_MIN_KEEP);
+    ok = BuildHandRange(range, weights, dead);
+    for (int i = 0; i < NUM_SAMPLES && ok; i++)
+    {
+        combo = DealRangeHand(range, &rng, CardToMask(StringToCard("AD")));
+        ok = !(COMBO_MASKS[combo] & (dead | CardToMask(StringToCard("AD"))));
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "Failed excluding dead cards\n");
+        failed++;
+    }
+    numtests++;
+
+    //Committing more of a stack means a stronger range, the blinds mean nothing
+    for (int i = 0; i < NUM_COMBOS; i++)
+    {
+        uniformequity += PREFLOP_EQUITY[PreflopClass(COMBO_CARDS[i])][0] / NUM_COMBOS;
+    }
+    SetPlayerRange(range, &allin, 0);
+    allinequity = range->uniform ? 0 : AverageRangeEquity(range, &rng);
+    SetPlayerRange(range, &halfin, 0);
+    halfinequity = range->uniform ? 0 : AverageRangeEquity(range, &rng);
+    SetPlayerRange(range, &blind, 0);
+    if (!range->uniform || allinequity <= halfinequity || halfinequity <= uniformequity)
+    {
+        fprintf(stderr, "Failed ranges from betting\n");
+        failed++;
+    }
+    numtests++;
+
+    //A middling hand does worse against someone who has moved all in
+    ai = CreatePokerAI(SHORT_TIMEOUT);
+    SetHand(ai, hand, NUM_HAND);
+    SetCommunity(ai, flop, 3);
+    UpdateGameDeck(&ai->game);
+    ai->game.opponents[0] = allin;
+    ai->game.num_opponents = 1;
+    ai->game.num_playing = 1;
+
+    uniform = GetWinProbability(ai);
+    SetRangeModeling(ai, true);
+    ranged = GetWinProbability(ai);
+    if (ai->games_simulated == 0 || ranged > uniform - 0.05)
+    {
+        fprintf(stderr, "Failed simulating against a range\n");
+        failed++;
+    }
+    numtests++;
+    DestroyPokerAI(ai);
+
+    free(weights);
+    free(range);
+
+    fprintf(stderr, "[RANGE]\t\t\tpassed %d/%d\n", (numtests - failed), numtests);
+    return CreateResult(failed, numtests);
+}
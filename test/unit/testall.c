@@ -29,6 +29,21 @@ int main(int argc, char **argv)
         numtests += result->numtests;
         DeleteResult(result);
 
+        result = TestCardMask();
+        failed += result->failed;
+        numtests += result->numtests;
+        DeleteResult(result);
+
+        result = TestEnumerator();
+        failed += result->failed;
+        numtests += result->numtests;
+        DeleteResult(result);
+
+        result = TestEquityCache();
+        failed += result->failed;
+        numtests += result->numtests;
+        DeleteResult(result);
+
         result = TestEvaluator();
         failed += result->failed;
         numtests += result->numtests;
@@ -39,6 +54,26 @@ int main(int argc, char **argv)
         numtests += result->numtests;
         DeleteResult(result);
 
+        result = TestPreflop();
+        failed += result->failed;
+        numtests += result->numtests;
+        DeleteResult(result);
+
+        result = TestRandom();
+        failed += result->failed;
+        numtests += result->numtests;
+        DeleteResult(result);
+
+        result = TestRange();
+        failed += result->failed;
+        numtests += result->numtests;
+        DeleteResult(result);
+
+        result = TestThreadPool();
+        failed += result->failed;
+        numtests += result->numtests;
+        DeleteResult(result);
+
         result = TestTimer();
         failed += result->failed;
         numtests += result->numtests;
@@ -49,6 +84,11 @@ int main(int argc, char **argv)
         numtests += result->numtests;
         DeleteResult(result);
 
+        result = TestWinProbability();
+        failed += result->failed;
+        numtests += result->numtests;
+        DeleteResult(result);
+
         printf("\n\n");
         printf("=================\n");
         printf("||PASSED|FAILED||\n");
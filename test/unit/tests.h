@@ -3,11 +3,20 @@
 
 #include <string.h>
 #include <unistd.h>
+#include <sys/wait.h>
 
 #include "action.h"
+#include "cardmask.h"
+#include "enumerator.h"
+#include "equitycache.h"
 #include "evaluator.h"
 #include "gamestate.h"
 #include "gamestategenerator.h"
+#include "mockserver.h"
+#include "preflop.h"
+#include "random.h"
+#include "range.h"
+#include "threadpool.h"
 #include "timer.h"
 #include "pokerai.h"
 #include "urlconnection.h"
@@ -25,10 +34,18 @@ void DeleteResult(TestResult *results);
  * Test each component of the poker AI
  */
 TestResult *TestAction(void);
+TestResult *TestCardMask(void);
+TestResult *TestEnumerator(void);
+TestResult *TestEquityCache(void);
 TestResult *TestEvaluator(void);
 TestResult *TestGameState(void);
+TestResult *TestPreflop(void);
+TestResult *TestRandom(void);
+TestResult *TestRange(void);
+TestResult *TestThreadPool(void);
 TestResult *TestTimer(void);
 TestResult *TestURLConnection(void);
+TestResult *TestWinProbability(void);
 
 /*
  * Test the poker AI's logic by creating random games
@@ -0,0 +1,111 @@
+#include "tests.h"
+
+#define TEST_NUM_THREADS    4
+#define TEST_NUM_ROUNDS     100
+#define TEST_WAIT_MS        50
+
+typedef struct pooltestdata
+{
+    pthread_mutex_t mutex;
+    int calls;
+    int seen[TEST_NUM_THREADS];
+} PoolTestData;
+
+/*
+ * Record which worker ran the task
+ * _data: a void pointer to a PoolTestData
+ * worker: the index of the worker
+ */
+static
+void CountWorker(void *_data, int worker)
+{
+    PoolTestData *data = (PoolTestData *)_data;
+
+    pthread_mutex_lock(&data->mutex);
+    data->calls++;
+    data->seen[worker]++;
+    pthread_mutex_unlock(&data->mutex);
+}
+
+/*
+ * Keep the worker busy until the flag is raised
+ * _flag: a void pointer to a bool
+ * worker: the index of the worker
+ */
+static
+void SpinWorker(void *_flag, int worker)
+{
+    bool *flag = (bool *)_flag;
+
+    while (!__atomic_load_n(flag, __ATOMIC_RELAXED));
+}
+
+TestResult *TestThreadPool(void)
+{
+    int numtests = 0;
+    int failed = 0;
+    bool release = false;
+    struct timespec deadline;
+    PoolTestData data;
+    ThreadPool *pool = CreateThreadPool(TEST_NUM_THREADS);
+
+    pthread_mutex_init(&data.mutex, NULL);
+    data.calls = 0;
+    memset(data.seen, 0, sizeof(data.seen));
+
+    ThreadPoolRun(pool, CountWorker, &data);
+    if (data.calls != TEST_NUM_THREADS)
+    {
+        fprintf(stderr, "Failed single submission\n");
+        failed++;
+    }
+    numtests++;
+
+    for (int i = 1; i < TEST_NUM_ROUNDS; i++)
+    {
+        ThreadPoolSubmit(pool, CountWorker, &data);
+    }
+    ThreadPoolWait(pool);
+    if (data.calls != TEST_NUM_THREADS * TEST_NUM_ROUNDS)
+    {
+        fprintf(stderr, "Failed repeated submissions\n");
+        failed++;
+    }
+    numtests++;
+
+    for (int i = 0; i < TEST_NUM_THREADS; i++)
+    {
+        if (data.seen[i] != TEST_NUM_ROUNDS)
+        {
+            fprintf(stderr, "Failed worker index\n");
+            failed++;
+            break;
+        }
+    }
+    numtests++;
+
+    //A timed wait gives up on busy workers and succeeds once they finish
+    ThreadPoolSubmit(pool, SpinWorker, &release);
+    SetDeadline(&deadline, TEST_WAIT_MS);
+    if (ThreadPoolWaitUntil(pool, &deadline))
+    {
+        fprintf(stderr, "Failed timed wait on busy workers\n");
+        failed++;
+    }
+    numtests++;
+
+    __atomic_store_n(&release, true, __ATOMIC_RELAXED);
+    SetDeadline(&deadline, TEST_WAIT_MS);
+    if (!ThreadPoolWaitUntil(pool, &deadline))
+    {
+        fprintf(stderr, "Failed timed wait on finished workers\n");
+        failed++;
+    }
+    numtests++;
+
+    DestroyThreadPool(pool);
+    pthread_mutex_destroy(&data.mutex);
+
+    fprintf(stderr, "[THREADPOOL]\t\tpassed %d/%d\n", (numtests - failed), numtests);
+    return CreateResult(failed, numtests);
+}
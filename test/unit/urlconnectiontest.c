@@ -6,17 +6,190 @@
 #define POST_DATA2  "query=test&moredata=true"
 
 #define JSON(json, field) \
-    cJSON_GetObjectItem(json, field)
+    ((json) ? cJSON_GetObjectItem(json, field) : NULL)
 #define JSON_STRING(json, field) \
-    JSON(json, field)->valuestring
+    (JSON(json, field) ? JSON(json, field)->valuestring : "")
+
+#define MAX_EVENTS  8
+#define BUF_SIZE    64
+
+//Events split across chunks, with a heartbeat and a multi-line event
+static const char *stream[] = {
+    "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nConnection: close\r\n\r\n",
+    "data: one\n\n",
+    "data: tw",
+    "o\n\n: heartbeat\n\n",
+    "event: state\r\ndata: a\r\ndata: b\r\n\r\n",
+    NULL
+};
+
+//A stream that is closed before its first event
+static const char *emptystream[] = {
+    "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nConnection: close\r\n\r\n",
+    NULL
+};
+
+static const char *page[] = {
+    "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nConnection: close\r\n\r\n",
+    "hello",
+    NULL
+};
+
+typedef struct receivedevents
+{
+    char data[MAX_EVENTS][BUF_SIZE];
+    int count;
+    int limit;
+} ReceivedEvents;
+
+/*
+ * Record an event, stopping the stream once the limit is reached
+ */
+static
+bool RecordEvent(const char *data, void *userdata)
+{
+    ReceivedEvents *events = (ReceivedEvents *)userdata;
+
+    if (events->count < MAX_EVENTS)
+    {
+        snprintf(events->data[events->count], BUF_SIZE, "%s", data);
+    }
+    events->count++;
+
+    return events->count < events->limit;
+}
 
 TestResult *TestURLConnection(void)
 {
     int numtests = 0;
     int failed = 0;
     char *response;
+    const char *reply;
     cJSON *json;
     cJSON *form;
+    HttpSession *session;
+    MockServer *server;
+    ReceivedEvents events;
+    StatePoller *poller;
+    Timer timer;
+    char url[BUF_SIZE];
+    bool changed;
+    bool ok;
+    int delay;
+
+    //Events are handed over whole, however the server splits them
+    server = StartMockServer(stream);
+    session = CreateHttpSession();
+    memset(&events, 0, sizeof(events));
+    events.limit = MAX_EVENTS;
+    snprintf(url, BUF_SIZE, "http://127.0.0.1:%d/events", server ? server->port : 0);
+    ok = session && HttpSessionStream(session, url, RecordEvent, &events);
+    if (!ok || events.count != 3 || strcmp(events.data[0], "one") ||
+        strcmp(events.data[1], "two") || strcmp(events.data[2], "a\nb"))
+    {
+        fprintf(stderr, "Failed server-sent event stream\n");
+        failed++;
+    }
+    numtests++;
+
+    //The callback can close the stream early
+    memset(&events, 0, sizeof(events));
+    events.limit = 1;
+    ok = session && HttpSessionStream(session, url, RecordEvent, &events);
+    if (!ok || events.count != 1 || strcmp(events.data[0], "one"))
+    {
+        fprintf(stderr, "Failed closing a stream from its callback\n");
+        failed++;
+    }
+    numtests++;
+    StopMockServer(server);
+
+    //A stream closed at once is reopened after 0, 50 and 100ms,
+    //and the wait is cleared only once an event has arrived
+    server = StartMockServer(emptystream);
+    snprintf(url, BUF_SIZE, "http://127.0.0.1:%d/events", server ? server->port : 0);
+    memset(&events, 0, sizeof(events));
+    events.limit = MAX_EVENTS;
+    delay = 0;
+    StartTimer(&timer);
+    ok = server && session;
+    for (int i = 0; i < 3 && ok; i++)
+    {
+        ok = ListenToStream(session, url, RecordEvent, &events, &delay);
+    }
+    ok = ok && GetElapsedTime(&timer) >= 3 * MIN_POLL_MS && delay == 4 * MIN_POLL_MS
+        && events.count == 0 && server->requests == 3;
+    StopMockServer(server);
+
+    server = StartMockServer(stream);
+    snprintf(url, BUF_SIZE, "http://127.0.0.1:%d/events", server ? server->port : 0);
+    ok = ok && ListenToStream(session, url, RecordEvent, &events, &delay)
+        && events.count == 3 && delay == 0;
+    if (!ok)
+    {
+        fprintf(stderr, "Failed reconnecting to an empty stream\n");
+        failed++;
+    }
+    numtests++;
+    StopMockServer(server);
+
+    //The session is still good for plain requests after streaming
+    server = StartMockServer(page);
+    snprintf(url, BUF_SIZE, "http://127.0.0.1:%d/", server ? server->port : 0);
+    reply = session ? HttpSessionGet(session, url) : NULL;
+    if (!reply || strcmp(reply, "hello"))
+    {
+        fprintf(stderr, "Failed HTTP GET after a stream\n");
+        failed++;
+    }
+    numtests++;
+
+    //An unchanged state is polled after 50, 100, 200 and 400ms, then 800ms
+    poller = session ? CreateStatePoller(session, url, false) : NULL;
+    StartTimer(&timer);
+    ok = poller && PollState(poller, &changed) && changed;
+    for (int i = 0; i < 4 && ok; i++)
+    {
+        ok = PollState(poller, &changed) && !changed;
+    }
+    if (!ok || GetElapsedTime(&timer) < 750 || poller->delay != 800
+            || strstr(server->request_line, "since="))
+    {
+        fprintf(stderr, "Failed polling backoff\n");
+        failed++;
+    }
+    numtests++;
+
+    //Acting on the state brings the next poll back to the shortest wait
+    if (poller)
+    {
+        HurryStatePoller(poller);
+    }
+    if (!poller || poller->delay != MIN_POLL_MS)
+    {
+        fprintf(stderr, "Failed hurrying a poller\n");
+        failed++;
+    }
+    numtests++;
+    DestroyStatePoller(poller);
+
+    //A long poll asks for a newer state at once, but a server that
+    //answers with the same state at once is still polled with backoff
+    poller = session ? CreateStatePoller(session, url, true) : NULL;
+    StartTimer(&timer);
+    ok = poller && PollState(poller, &changed) && changed && poller->delay == 0
+        && PollState(poller, &changed) && !changed
+        && strstr(server->request_line, "?since=")
+        && PollState(poller, &changed) && !changed;
+    if (!ok || GetElapsedTime(&timer) < MIN_POLL_MS || poller->delay != 2 * MIN_POLL_MS)
+    {
+        fprintf(stderr, "Failed long polling an unchanged state\n");
+        failed++;
+    }
+    numtests++;
+    DestroyStatePoller(poller);
+    StopMockServer(server);
+    DestroyHttpSession(session);
 
     response = httpGet(GET_URL);
     if (!response)
@@ -64,6 +237,20 @@ TestResult *TestURLConnection(void)
     numtests++;
     cJSON_Delete(json);
 
+    //A GET after a POST on the same handle must go out as a GET
+    session = CreateHttpSession();
+    reply = session ? HttpSessionPost(session, POST_URL, POST_DATA) : NULL;
+    reply = reply ? HttpSessionGet(session, GET_URL) : NULL;
+    json = reply ? cJSON_Parse(reply) : NULL;
+    if (!json || !JSON(json, "url") || strcmp(JSON_STRING(json, "url"), GET_URL))
+    {
+        fprintf(stderr, "Failed HTTP GET after POST on one session\n");
+        failed++;
+    }
+    numtests++;
+    cJSON_Delete(json);
+    DestroyHttpSession(session);
+
     fprintf(stderr, "[URLCONNECTION]\t\tpassed %d/%d\n", (numtests - failed), numtests);
     return CreateResult(failed, numtests);
 }
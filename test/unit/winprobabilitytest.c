@@ -0,0 +1,273 @@
+#include "tests.h"
+
+#define LONG_TIMEOUT    5000
+#define SHORT_TIMEOUT   200
+#define TARGET_ERROR    0.005
+#define BATCH_GAMES     1000
+#define FLOP_DEALS      1070190 //(47 choose 2) * (45 choose 2)
+#define SPECULATIVE_GAMES 100000
+#define FLOP_RUNOUTS    1081 //(47 choose 2)
+
+/*
+ * Run GetWinProbability on its own thread
+ * _ai: a void pointer to the PokerAI
+ * return: NULL
+ */
+static
+void *RunWinProbability(void *_ai)
+{
+    GetWinProbability((PokerAI *)_ai);
+    return NULL;
+}
+
+TestResult *TestWinProbability(void)
+{
+    int numtests = 0;
+    int failed = 0;
+    long long won;
+    long long deals;
+    double exact;
+    double winprob;
+    long long simulated;
+    long long live;
+    pthread_t thread;
+    CardMask runouts;
+    bool distinct;
+    EquityQuery queries[3];
+    Timer timer;
+    PokerAI *ai = CreatePokerAI(LONG_TIMEOUT);
+    char *nuts[] = {"AS", "KS"};
+    char *nutsboard[] = {"QS", "JS", "TS"};
+    char *bigslick[] = {"AH", "KD"};
+    char *flop[] = {"2C", "7S", "9H"};
+    char *royalboard[] = {"AS", "KS", "QS", "JS", "TS"};
+
+    //A made royal flush cannot lose, so the estimate converges at once
+    SetTargetError(ai, TARGET_ERROR);
+    SetHand(ai, nuts, NUM_HAND);
+    SetCommunity(ai, nutsboard, 3);
+    UpdateGameDeck(&ai->game);
+    ai->game.num_playing = 3;
+
+    StartTimer(&timer);
+    winprob = GetWinProbability(ai);
+    if (winprob != 1.0 || GetElapsedTime(&timer) > LONG_TIMEOUT / 2)
+    {
+        fprintf(stderr, "Failed adaptive stop on a certain win\n");
+        failed++;
+    }
+    numtests++;
+
+    //Sample a spot that could be enumerated and compare
+    SetEnumerateLimit(ai, 0);
+    SetHand(ai, bigslick, NUM_HAND);
+    SetCommunity(ai, flop, 3);
+    UpdateGameDeck(&ai->game);
+    ai->game.num_playing = 1;
+
+    deals = EnumerateDeals(&ai->game, &won);
+    exact = (double)won / deals;
+    winprob = GetWinProbability(ai);
+    if (fabs(winprob - exact) > 2 * TARGET_ERROR)
+    {
+        fprintf(stderr, "Failed adaptive estimate accuracy\n");
+        failed++;
+    }
+    numtests++;
+
+    //Without a target the timeout is the only way to stop
+    DestroyPokerAI(ai);
+    ai = CreatePokerAI(SHORT_TIMEOUT);
+    SetHand(ai, nuts, NUM_HAND);
+    SetCommunity(ai, nutsboard, 3);
+    UpdateGameDeck(&ai->game);
+    ai->game.num_playing = 3;
+
+    StartTimer(&timer);
+    GetWinProbability(ai);
+    if (GetElapsedTime(&timer) < SHORT_TIMEOUT)
+    {
+        fprintf(stderr, "Failed fixed timeout\n");
+        failed++;
+    }
+    numtests++;
+
+    //The running totals can be read while the workers are still simulating
+    DestroyPokerAI(ai);
+    ai = CreatePokerAI(SHORT_TIMEOUT);
+    SetHand(ai, nuts, NUM_HAND);
+    SetCommunity(ai, nutsboard, 3);
+    UpdateGameDeck(&ai->game);
+    ai->game.num_playing = 3;
+
+    pthread_create(&thread, NULL, RunWinProbability, ai);
+    do
+    {
+        winprob = GetSimulationProgress(ai, &won, &live);
+    } while (live == 0);
+    pthread_join(thread, NULL);
+
+    GetSimulationProgress(ai, NULL, &simulated);
+    //Games won are read before games simulated, so won can only trail live
+    //while running; once the workers are done the royal flush won every game
+    if (winprob > 1.0 || won > live || live >= simulated || simulated != ai->games_simulated
+            || ai->games_won != ai->games_simulated)
+    {
+        fprintf(stderr, "Failed live simulation progress\n");
+        failed++;
+    }
+    numtests++;
+
+    //A batch mixes a preflop lookup, an exact spot and a sampled spot
+    SetEnumerateLimit(ai, DEFAULT_ENUMERATE_LIMIT);
+    for (int i = 0; i < 3; i++)
+    {
+        queries[i].hand[0] = StringToCard(nuts[0]);
+        queries[i].hand[1] = StringToCard(nuts[1]);
+        for (int j = 0; j < 3; j++)
+        {
+            queries[i].community[j] = StringToCard(nutsboard[j]);
+        }
+    }
+    queries[0].communitysize = 0;
+    queries[0].num_playing = 2;
+    queries[1].communitysize = 3;
+    queries[1].num_playing = 1;
+    queries[2].communitysize = 3;
+    queries[2].num_playing = 3;
+
+    GetWinProbabilities(ai, queries, 3, BATCH_GAMES);
+    if (queries[0].winprob != PreflopEquity(queries[0].hand, 2)
+            || queries[1].winprob != 1.0 || queries[1].games_simulated != FLOP_DEALS
+            || queries[2].winprob != 1.0 || queries[2].games_simulated != BATCH_GAMES)
+    {
+        fprintf(stderr, "Failed batch queries\n");
+        failed++;
+    }
+    numtests++;
+
+    //Games simulated while waiting for our turn are kept for the decision
+    SetSpeculation(ai, true);
+    SetHand(ai, bigslick, NUM_HAND);
+    SetCommunity(ai, flop, 3);
+    UpdateGameDeck(&ai->game);
+    ai->game.num_playing = 3;
+
+    SpeculateWinProbability(ai);
+    do
+    {
+        usleep(1000);
+        GetSimulationProgress(ai, NULL, &live);
+    } while (live < SPECULATIVE_GAMES);
+
+    winprob = GetWinProbability(ai);
+    if (winprob <= 0 || winprob >= 1 || ai->speculated_games < SPECULATIVE_GAMES
+            || ai->games_simulated <= ai->speculated_games)
+    {
+        fprintf(stderr, "Failed reusing speculative games\n");
+        failed++;
+    }
+    numtests++;
+
+    //Speculation on a spot that has since changed is thrown away
+    SpeculateWinProbability(ai);
+    SetHand(ai, nuts, NUM_HAND);
+    SetCommunity(ai, nutsboard, 3);
+    UpdateGameDeck(&ai->game);
+
+    winprob = GetWinProbability(ai);
+    if (winprob != 1.0 || ai->speculated_games != 0)
+    {
+        fprintf(stderr, "Failed discarding stale speculation\n");
+        failed++;
+    }
+    numtests++;
+
+    //When the board plays every pot is split, worth a share per player
+    DestroyPokerAI(ai);
+    ai = CreatePokerAI(SHORT_TIMEOUT);
+    SetEnumerateLimit(ai, 0);
+    SetEstimator(ai, ESTIMATE_SPLIT_TIES);
+    SetHand(ai, bigslick, NUM_HAND);
+    SetCommunity(ai, royalboard, NUM_COMMUNITY);
+    UpdateGameDeck(&ai->game);
+    ai->game.num_playing = 2;
+
+    winprob = GetWinProbability(ai);
+    ai->game.num_playing = 1;
+    EnumerateEquity(&ai->game, &won, &exact);
+    if (fabs(winprob - 1.0 / 3) > 1e-9 || won != 990 || exact != 0.5)
+    {
+        fprintf(stderr, "Failed splitting tied pots\n");
+        failed++;
+    }
+    numtests++;
+
+    //The preflop table counts ties as wins, so split ties are simulated instead
+    SetCommunity(ai, royalboard, 0);
+    UpdateGameDeck(&ai->game);
+
+    winprob = GetWinProbability(ai);
+    if (ai->games_simulated == 0 || winprob > PreflopEquity(ai->game.hand, ai->game.num_playing) + 0.01)
+    {
+        fprintf(stderr, "Failed splitting preflop ties\n");
+        failed++;
+    }
+    numtests++;
+
+    //Stratifying by our final hand keeps the estimate honest and reports its worth
+    DestroyPokerAI(ai);
+    ai = CreatePokerAI(LONG_TIMEOUT);
+    SetTargetError(ai, TARGET_ERROR);
+    SetEnumerateLimit(ai, 0);
+    SetEstimator(ai, ESTIMATE_SPLIT_TIES | ESTIMATE_HAND_CLASSES);
+    SetHand(ai, bigslick, NUM_HAND);
+    SetCommunity(ai, flop, 3);
+    UpdateGameDeck(&ai->game);
+    ai->game.num_playing = 1;
+
+    EnumerateEquity(&ai->game, &won, &exact);
+    winprob = GetWinProbability(ai);
+    if (fabs(winprob - exact) > 2 * TARGET_ERROR || ai->num_classes < 2 || ai->effective_games <= 0)
+    {
+        fprintf(stderr, "Failed stratified estimate\n");
+        failed++;
+    }
+    numtests++;
+
+    //Taking every flop runout in turn lists each of them exactly once
+    DestroyPokerAI(ai);
+    ai = CreatePokerAI(LONG_TIMEOUT);
+    SetTargetError(ai, TARGET_ERROR);
+    SetEnumerateLimit(ai, 0);
+    SetStratifiedRunouts(ai, true);
+    SetHand(ai, bigslick, NUM_HAND);
+    SetCommunity(ai, flop, 3);
+    UpdateGameDeck(&ai->game);
+    ai->game.num_playing = 1;
+
+    winprob = GetWinProbability(ai);
+    EnumerateDeals(&ai->game, &won);
+    exact = (double)won / FLOP_DEALS;
+    distinct = true;
+    for (int i = 0; i < ai->num_runouts; i++)
+    {
+        runouts = ai->runouts[i].mask;
+        for (int j = 0; j < i; j++)
+        {
+            distinct = distinct && ai->runouts[j].mask != runouts;
+        }
+        distinct = distinct && !(runouts & ~ai->game.deck);
+    }
+    if (fabs(winprob - exact) > 2 * TARGET_ERROR || ai->num_runouts != FLOP_RUNOUTS || !distinct)
+    {
+        fprintf(stderr, "Failed stratified runouts\n");
+        failed++;
+    }
+    numtests++;
+
+    DestroyPokerAI(ai);
+
+    fprintf(stderr, "[WINPROBABILITY]\tpassed %d/%d\n", (numtests - failed), numtests);
+    return CreateResult(failed, numtests);
+}